@@ -0,0 +1,54 @@
+int printf();
+
+// small static helpers called from hot loops: a clamped grid accessor for a
+// stencil, a hash step and the collatz step split into predicates.
+int grid[64][64];
+
+static int clamp(int x, int lo, int hi) {
+  if (x < lo)
+    return lo;
+  if (x > hi)
+    return hi;
+  return x;
+}
+
+static int at(int x, int y) { return grid[clamp(y, 0, 63)][clamp(x, 0, 63)]; }
+
+static long mix(long h, long v) { return (h * 31 + v) % 1000003; }
+
+static int is_odd(long n) { return n % 2 != 0; }
+
+static long step(long n) { return is_odd(n) ? 3 * n + 1 : n / 2; }
+
+long stencil() {
+  long check = 0;
+  for (int round = 0; round < 200; round++) {
+    for (int y = 0; y < 64; y++) {
+      for (int x = 0; x < 64; x++) {
+        int s = at(x - 1, y) + at(x + 1, y) + at(x, y - 1) + at(x, y + 1);
+        check = mix(check, s + round);
+      }
+    }
+  }
+  return check;
+}
+
+int collatz() {
+  int best = 0;
+  for (int i = 1; i < 300000; i++) {
+    int steps = 0;
+    for (long n = i; n != 1; n = step(n))
+      steps++;
+    if (best < steps)
+      best = steps;
+  }
+  return best;
+}
+
+int main() {
+  for (int y = 0; y < 64; y++)
+    for (int x = 0; x < 64; x++)
+      grid[y][x] = x * y % 17;
+  printf("%ld %d\n", stencil(), collatz());
+  return 0;
+}
@@ -0,0 +1,12 @@
+int printf();
+
+int fib(int n) {
+  if (n < 2)
+    return n;
+  return fib(n - 1) + fib(n - 2);
+}
+
+int main() {
+  printf("%d\n", fib(32));
+  return 0;
+}
@@ -0,0 +1,34 @@
+int printf();
+
+long a[64][64];
+long b[64][64];
+long c[64][64];
+
+void init() {
+  for (int i = 0; i < 64; i++)
+    for (int j = 0; j < 64; j++) {
+      a[i][j] = (i * 7 + j * 3) % 17 - 8;
+      b[i][j] = (i * 5 + j * 11) % 13 - 6;
+    }
+}
+
+void matmul() {
+  for (int i = 0; i < 64; i++)
+    for (int j = 0; j < 64; j++) {
+      long sum = 0;
+      for (int k = 0; k < 64; k++)
+        sum += a[i][k] * b[k][j];
+      c[i][j] = sum;
+    }
+}
+
+int main() {
+  init();
+  long check = 0;
+  for (int round = 0; round < 100; round++) {
+    matmul();
+    check = check + c[round % 64][(round * 3) % 64];
+  }
+  printf("%ld\n", check);
+  return 0;
+}
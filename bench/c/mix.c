@@ -0,0 +1,48 @@
+int printf();
+
+// enough live values to run out of registers.
+long mix(long n) {
+  long a = 1, b = 2, c = 3, d = 4, e = 5, f = 6, g = 7, h = 8;
+  long i = 9, j = 10, k = 11, l = 12, m = 13, o = 14;
+  for (long x = 0; x < n; x++) {
+    a = a + (b ^ x);
+    b = b + (c & 255) * 3;
+    c = c ^ (d << 3);
+    d = d + e % 7;
+    e = e + (f >> 2);
+    f = f ^ (g + x);
+    g = g + h / 3;
+    h = h - (i & 15);
+    i = i + j * 5;
+    j = j ^ (k - x);
+    k = k + l % 11;
+    l = l - (m | 5);
+    m = m + o / 7;
+    o = o ^ (a & 1023);
+  }
+  return a + b + c + d + e + f + g + h + i + j + k + l + m + o;
+}
+
+int collatz(long n) {
+  int steps = 0;
+  while (n != 1) {
+    if (n % 2)
+      n = 3 * n + 1;
+    else
+      n = n / 2;
+    steps++;
+  }
+  return steps;
+}
+
+int main() {
+  long sum = mix(1000000);
+  int best = 0;
+  for (int i = 1; i < 100000; i++) {
+    int s = collatz(i);
+    if (best < s)
+      best = s;
+  }
+  printf("%ld %d\n", sum, best);
+  return 0;
+}
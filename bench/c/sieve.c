@@ -0,0 +1,25 @@
+int printf();
+
+char flags[100000];
+
+int sieve(int n) {
+  int count = 0;
+  for (int i = 2; i < n; i++)
+    flags[i] = 1;
+  for (int i = 2; i < n; i++) {
+    if (flags[i]) {
+      count++;
+      for (int j = i + i; j < n; j = j + i)
+        flags[j] = 0;
+    }
+  }
+  return count;
+}
+
+int main() {
+  int total = 0;
+  for (int round = 0; round < 200; round++)
+    total = total + sieve(100000);
+  printf("%d\n", total);
+  return 0;
+}
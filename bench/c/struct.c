@@ -0,0 +1,86 @@
+int printf();
+
+// struct assignment of small, medium and large records: a particle update
+// loop, an insertion sort of 24 byte keys and a ring of 256 byte snapshots.
+struct Vec {
+  long x, y;
+};
+
+struct Particle {
+  struct Vec pos;
+  struct Vec vel;
+};
+
+struct Key {
+  long key;
+  long payload[2];
+};
+
+struct Snapshot {
+  long data[32];
+};
+
+struct Particle ps[256];
+struct Key keys[512];
+struct Snapshot ring[16];
+
+long particles() {
+  long check = 0;
+  for (int round = 0; round < 2000; round++) {
+    for (int i = 0; i < 256; i++) {
+      struct Particle p = ps[i];
+      struct Vec v = p.vel;
+      p.pos.x = p.pos.x + v.x;
+      p.pos.y = p.pos.y + v.y;
+      ps[i] = p;
+    }
+    check = check + ps[round % 256].pos.x;
+  }
+  return check;
+}
+
+long sort() {
+  long check = 0;
+  for (int round = 0; round < 20; round++) {
+    for (int i = 0; i < 512; i++) {
+      keys[i].key = (i * 7919 + round * 104729) % 1000;
+      keys[i].payload[0] = i;
+    }
+    for (int i = 1; i < 512; i++) {
+      struct Key k = keys[i];
+      int j = i - 1;
+      while (j >= 0 && keys[j].key > k.key) {
+        keys[j + 1] = keys[j];
+        j = j - 1;
+      }
+      keys[j + 1] = k;
+    }
+    check = check + keys[round].payload[0];
+  }
+  return check;
+}
+
+long snapshots() {
+  struct Snapshot cur;
+  for (int i = 0; i < 32; i++)
+    cur.data[i] = i;
+  long check = 0;
+  for (int round = 0; round < 200000; round++) {
+    cur.data[round % 32] = cur.data[round % 32] + round;
+    ring[round % 16] = cur;
+    struct Snapshot old = ring[(round + 1) % 16];
+    check = check + old.data[round % 32];
+  }
+  return check;
+}
+
+int main() {
+  for (int i = 0; i < 256; i++) {
+    ps[i].pos.x = i;
+    ps[i].pos.y = -i;
+    ps[i].vel.x = i % 7 - 3;
+    ps[i].vel.y = i % 5 - 2;
+  }
+  printf("%ld %ld %ld\n", particles(), sort(), snapshots());
+  return 0;
+}
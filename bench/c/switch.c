@@ -0,0 +1,824 @@
+int printf();
+
+// a dense opcode dispatcher and a sparse message id dispatcher with 200 cases each.
+int dense(int op, int acc) {
+  switch (op) {
+    case 0:
+      return acc * 1 + 0;
+    case 1:
+      return acc * 2 + 1;
+    case 2:
+      return acc * 3 + 2;
+    case 3:
+      return acc * 4 + 3;
+    case 4:
+      return acc * 5 + 4;
+    case 5:
+      return acc * 6 + 5;
+    case 6:
+      return acc * 7 + 6;
+    case 7:
+      return acc * 1 + 7;
+    case 8:
+      return acc * 2 + 8;
+    case 9:
+      return acc * 3 + 9;
+    case 10:
+      return acc * 4 + 10;
+    case 11:
+      return acc * 5 + 11;
+    case 12:
+      return acc * 6 + 12;
+    case 13:
+      return acc * 7 + 13;
+    case 14:
+      return acc * 1 + 14;
+    case 15:
+      return acc * 2 + 15;
+    case 16:
+      return acc * 3 + 16;
+    case 17:
+      return acc * 4 + 17;
+    case 18:
+      return acc * 5 + 18;
+    case 19:
+      return acc * 6 + 19;
+    case 20:
+      return acc * 7 + 20;
+    case 21:
+      return acc * 1 + 21;
+    case 22:
+      return acc * 2 + 22;
+    case 23:
+      return acc * 3 + 23;
+    case 24:
+      return acc * 4 + 24;
+    case 25:
+      return acc * 5 + 25;
+    case 26:
+      return acc * 6 + 26;
+    case 27:
+      return acc * 7 + 27;
+    case 28:
+      return acc * 1 + 28;
+    case 29:
+      return acc * 2 + 29;
+    case 30:
+      return acc * 3 + 30;
+    case 31:
+      return acc * 4 + 31;
+    case 32:
+      return acc * 5 + 32;
+    case 33:
+      return acc * 6 + 33;
+    case 34:
+      return acc * 7 + 34;
+    case 35:
+      return acc * 1 + 35;
+    case 36:
+      return acc * 2 + 36;
+    case 37:
+      return acc * 3 + 37;
+    case 38:
+      return acc * 4 + 38;
+    case 39:
+      return acc * 5 + 39;
+    case 40:
+      return acc * 6 + 40;
+    case 41:
+      return acc * 7 + 41;
+    case 42:
+      return acc * 1 + 42;
+    case 43:
+      return acc * 2 + 43;
+    case 44:
+      return acc * 3 + 44;
+    case 45:
+      return acc * 4 + 45;
+    case 46:
+      return acc * 5 + 46;
+    case 47:
+      return acc * 6 + 47;
+    case 48:
+      return acc * 7 + 48;
+    case 49:
+      return acc * 1 + 49;
+    case 50:
+      return acc * 2 + 50;
+    case 51:
+      return acc * 3 + 51;
+    case 52:
+      return acc * 4 + 52;
+    case 53:
+      return acc * 5 + 53;
+    case 54:
+      return acc * 6 + 54;
+    case 55:
+      return acc * 7 + 55;
+    case 56:
+      return acc * 1 + 56;
+    case 57:
+      return acc * 2 + 57;
+    case 58:
+      return acc * 3 + 58;
+    case 59:
+      return acc * 4 + 59;
+    case 60:
+      return acc * 5 + 60;
+    case 61:
+      return acc * 6 + 61;
+    case 62:
+      return acc * 7 + 62;
+    case 63:
+      return acc * 1 + 63;
+    case 64:
+      return acc * 2 + 64;
+    case 65:
+      return acc * 3 + 65;
+    case 66:
+      return acc * 4 + 66;
+    case 67:
+      return acc * 5 + 67;
+    case 68:
+      return acc * 6 + 68;
+    case 69:
+      return acc * 7 + 69;
+    case 70:
+      return acc * 1 + 70;
+    case 71:
+      return acc * 2 + 71;
+    case 72:
+      return acc * 3 + 72;
+    case 73:
+      return acc * 4 + 73;
+    case 74:
+      return acc * 5 + 74;
+    case 75:
+      return acc * 6 + 75;
+    case 76:
+      return acc * 7 + 76;
+    case 77:
+      return acc * 1 + 77;
+    case 78:
+      return acc * 2 + 78;
+    case 79:
+      return acc * 3 + 79;
+    case 80:
+      return acc * 4 + 80;
+    case 81:
+      return acc * 5 + 81;
+    case 82:
+      return acc * 6 + 82;
+    case 83:
+      return acc * 7 + 83;
+    case 84:
+      return acc * 1 + 84;
+    case 85:
+      return acc * 2 + 85;
+    case 86:
+      return acc * 3 + 86;
+    case 87:
+      return acc * 4 + 87;
+    case 88:
+      return acc * 5 + 88;
+    case 89:
+      return acc * 6 + 89;
+    case 90:
+      return acc * 7 + 90;
+    case 91:
+      return acc * 1 + 91;
+    case 92:
+      return acc * 2 + 92;
+    case 93:
+      return acc * 3 + 93;
+    case 94:
+      return acc * 4 + 94;
+    case 95:
+      return acc * 5 + 95;
+    case 96:
+      return acc * 6 + 96;
+    case 97:
+      return acc * 7 + 97;
+    case 98:
+      return acc * 1 + 98;
+    case 99:
+      return acc * 2 + 99;
+    case 100:
+      return acc * 3 + 100;
+    case 101:
+      return acc * 4 + 101;
+    case 102:
+      return acc * 5 + 102;
+    case 103:
+      return acc * 6 + 103;
+    case 104:
+      return acc * 7 + 104;
+    case 105:
+      return acc * 1 + 105;
+    case 106:
+      return acc * 2 + 106;
+    case 107:
+      return acc * 3 + 107;
+    case 108:
+      return acc * 4 + 108;
+    case 109:
+      return acc * 5 + 109;
+    case 110:
+      return acc * 6 + 110;
+    case 111:
+      return acc * 7 + 111;
+    case 112:
+      return acc * 1 + 112;
+    case 113:
+      return acc * 2 + 113;
+    case 114:
+      return acc * 3 + 114;
+    case 115:
+      return acc * 4 + 115;
+    case 116:
+      return acc * 5 + 116;
+    case 117:
+      return acc * 6 + 117;
+    case 118:
+      return acc * 7 + 118;
+    case 119:
+      return acc * 1 + 119;
+    case 120:
+      return acc * 2 + 120;
+    case 121:
+      return acc * 3 + 121;
+    case 122:
+      return acc * 4 + 122;
+    case 123:
+      return acc * 5 + 123;
+    case 124:
+      return acc * 6 + 124;
+    case 125:
+      return acc * 7 + 125;
+    case 126:
+      return acc * 1 + 126;
+    case 127:
+      return acc * 2 + 127;
+    case 128:
+      return acc * 3 + 128;
+    case 129:
+      return acc * 4 + 129;
+    case 130:
+      return acc * 5 + 130;
+    case 131:
+      return acc * 6 + 131;
+    case 132:
+      return acc * 7 + 132;
+    case 133:
+      return acc * 1 + 133;
+    case 134:
+      return acc * 2 + 134;
+    case 135:
+      return acc * 3 + 135;
+    case 136:
+      return acc * 4 + 136;
+    case 137:
+      return acc * 5 + 137;
+    case 138:
+      return acc * 6 + 138;
+    case 139:
+      return acc * 7 + 139;
+    case 140:
+      return acc * 1 + 140;
+    case 141:
+      return acc * 2 + 141;
+    case 142:
+      return acc * 3 + 142;
+    case 143:
+      return acc * 4 + 143;
+    case 144:
+      return acc * 5 + 144;
+    case 145:
+      return acc * 6 + 145;
+    case 146:
+      return acc * 7 + 146;
+    case 147:
+      return acc * 1 + 147;
+    case 148:
+      return acc * 2 + 148;
+    case 149:
+      return acc * 3 + 149;
+    case 150:
+      return acc * 4 + 150;
+    case 151:
+      return acc * 5 + 151;
+    case 152:
+      return acc * 6 + 152;
+    case 153:
+      return acc * 7 + 153;
+    case 154:
+      return acc * 1 + 154;
+    case 155:
+      return acc * 2 + 155;
+    case 156:
+      return acc * 3 + 156;
+    case 157:
+      return acc * 4 + 157;
+    case 158:
+      return acc * 5 + 158;
+    case 159:
+      return acc * 6 + 159;
+    case 160:
+      return acc * 7 + 160;
+    case 161:
+      return acc * 1 + 161;
+    case 162:
+      return acc * 2 + 162;
+    case 163:
+      return acc * 3 + 163;
+    case 164:
+      return acc * 4 + 164;
+    case 165:
+      return acc * 5 + 165;
+    case 166:
+      return acc * 6 + 166;
+    case 167:
+      return acc * 7 + 167;
+    case 168:
+      return acc * 1 + 168;
+    case 169:
+      return acc * 2 + 169;
+    case 170:
+      return acc * 3 + 170;
+    case 171:
+      return acc * 4 + 171;
+    case 172:
+      return acc * 5 + 172;
+    case 173:
+      return acc * 6 + 173;
+    case 174:
+      return acc * 7 + 174;
+    case 175:
+      return acc * 1 + 175;
+    case 176:
+      return acc * 2 + 176;
+    case 177:
+      return acc * 3 + 177;
+    case 178:
+      return acc * 4 + 178;
+    case 179:
+      return acc * 5 + 179;
+    case 180:
+      return acc * 6 + 180;
+    case 181:
+      return acc * 7 + 181;
+    case 182:
+      return acc * 1 + 182;
+    case 183:
+      return acc * 2 + 183;
+    case 184:
+      return acc * 3 + 184;
+    case 185:
+      return acc * 4 + 185;
+    case 186:
+      return acc * 5 + 186;
+    case 187:
+      return acc * 6 + 187;
+    case 188:
+      return acc * 7 + 188;
+    case 189:
+      return acc * 1 + 189;
+    case 190:
+      return acc * 2 + 190;
+    case 191:
+      return acc * 3 + 191;
+    case 192:
+      return acc * 4 + 192;
+    case 193:
+      return acc * 5 + 193;
+    case 194:
+      return acc * 6 + 194;
+    case 195:
+      return acc * 7 + 195;
+    case 196:
+      return acc * 1 + 196;
+    case 197:
+      return acc * 2 + 197;
+    case 198:
+      return acc * 3 + 198;
+    case 199:
+      return acc * 4 + 199;
+  }
+  return acc;
+}
+
+int sparse(int id, int acc) {
+  switch (id) {
+    case 13:
+      return acc + 1;
+    case 990:
+      return acc + 2;
+    case 1967:
+      return acc + 3;
+    case 2944:
+      return acc + 4;
+    case 3921:
+      return acc + 5;
+    case 4898:
+      return acc + 6;
+    case 5875:
+      return acc + 7;
+    case 6852:
+      return acc + 8;
+    case 7829:
+      return acc + 9;
+    case 8806:
+      return acc + 10;
+    case 9783:
+      return acc + 11;
+    case 10760:
+      return acc + 12;
+    case 11737:
+      return acc + 13;
+    case 12714:
+      return acc + 1;
+    case 13691:
+      return acc + 2;
+    case 14668:
+      return acc + 3;
+    case 15645:
+      return acc + 4;
+    case 16622:
+      return acc + 5;
+    case 17599:
+      return acc + 6;
+    case 18576:
+      return acc + 7;
+    case 19553:
+      return acc + 8;
+    case 20530:
+      return acc + 9;
+    case 21507:
+      return acc + 10;
+    case 22484:
+      return acc + 11;
+    case 23461:
+      return acc + 12;
+    case 24438:
+      return acc + 13;
+    case 25415:
+      return acc + 1;
+    case 26392:
+      return acc + 2;
+    case 27369:
+      return acc + 3;
+    case 28346:
+      return acc + 4;
+    case 29323:
+      return acc + 5;
+    case 30300:
+      return acc + 6;
+    case 31277:
+      return acc + 7;
+    case 32254:
+      return acc + 8;
+    case 33231:
+      return acc + 9;
+    case 34208:
+      return acc + 10;
+    case 35185:
+      return acc + 11;
+    case 36162:
+      return acc + 12;
+    case 37139:
+      return acc + 13;
+    case 38116:
+      return acc + 1;
+    case 39093:
+      return acc + 2;
+    case 40070:
+      return acc + 3;
+    case 41047:
+      return acc + 4;
+    case 42024:
+      return acc + 5;
+    case 43001:
+      return acc + 6;
+    case 43978:
+      return acc + 7;
+    case 44955:
+      return acc + 8;
+    case 45932:
+      return acc + 9;
+    case 46909:
+      return acc + 10;
+    case 47886:
+      return acc + 11;
+    case 48863:
+      return acc + 12;
+    case 49840:
+      return acc + 13;
+    case 50817:
+      return acc + 1;
+    case 51794:
+      return acc + 2;
+    case 52771:
+      return acc + 3;
+    case 53748:
+      return acc + 4;
+    case 54725:
+      return acc + 5;
+    case 55702:
+      return acc + 6;
+    case 56679:
+      return acc + 7;
+    case 57656:
+      return acc + 8;
+    case 58633:
+      return acc + 9;
+    case 59610:
+      return acc + 10;
+    case 60587:
+      return acc + 11;
+    case 61564:
+      return acc + 12;
+    case 62541:
+      return acc + 13;
+    case 63518:
+      return acc + 1;
+    case 64495:
+      return acc + 2;
+    case 65472:
+      return acc + 3;
+    case 66449:
+      return acc + 4;
+    case 67426:
+      return acc + 5;
+    case 68403:
+      return acc + 6;
+    case 69380:
+      return acc + 7;
+    case 70357:
+      return acc + 8;
+    case 71334:
+      return acc + 9;
+    case 72311:
+      return acc + 10;
+    case 73288:
+      return acc + 11;
+    case 74265:
+      return acc + 12;
+    case 75242:
+      return acc + 13;
+    case 76219:
+      return acc + 1;
+    case 77196:
+      return acc + 2;
+    case 78173:
+      return acc + 3;
+    case 79150:
+      return acc + 4;
+    case 80127:
+      return acc + 5;
+    case 81104:
+      return acc + 6;
+    case 82081:
+      return acc + 7;
+    case 83058:
+      return acc + 8;
+    case 84035:
+      return acc + 9;
+    case 85012:
+      return acc + 10;
+    case 85989:
+      return acc + 11;
+    case 86966:
+      return acc + 12;
+    case 87943:
+      return acc + 13;
+    case 88920:
+      return acc + 1;
+    case 89897:
+      return acc + 2;
+    case 90874:
+      return acc + 3;
+    case 91851:
+      return acc + 4;
+    case 92828:
+      return acc + 5;
+    case 93805:
+      return acc + 6;
+    case 94782:
+      return acc + 7;
+    case 95759:
+      return acc + 8;
+    case 96736:
+      return acc + 9;
+    case 97713:
+      return acc + 10;
+    case 98690:
+      return acc + 11;
+    case 99667:
+      return acc + 12;
+    case 100644:
+      return acc + 13;
+    case 101621:
+      return acc + 1;
+    case 102598:
+      return acc + 2;
+    case 103575:
+      return acc + 3;
+    case 104552:
+      return acc + 4;
+    case 105529:
+      return acc + 5;
+    case 106506:
+      return acc + 6;
+    case 107483:
+      return acc + 7;
+    case 108460:
+      return acc + 8;
+    case 109437:
+      return acc + 9;
+    case 110414:
+      return acc + 10;
+    case 111391:
+      return acc + 11;
+    case 112368:
+      return acc + 12;
+    case 113345:
+      return acc + 13;
+    case 114322:
+      return acc + 1;
+    case 115299:
+      return acc + 2;
+    case 116276:
+      return acc + 3;
+    case 117253:
+      return acc + 4;
+    case 118230:
+      return acc + 5;
+    case 119207:
+      return acc + 6;
+    case 120184:
+      return acc + 7;
+    case 121161:
+      return acc + 8;
+    case 122138:
+      return acc + 9;
+    case 123115:
+      return acc + 10;
+    case 124092:
+      return acc + 11;
+    case 125069:
+      return acc + 12;
+    case 126046:
+      return acc + 13;
+    case 127023:
+      return acc + 1;
+    case 128000:
+      return acc + 2;
+    case 128977:
+      return acc + 3;
+    case 129954:
+      return acc + 4;
+    case 130931:
+      return acc + 5;
+    case 131908:
+      return acc + 6;
+    case 132885:
+      return acc + 7;
+    case 133862:
+      return acc + 8;
+    case 134839:
+      return acc + 9;
+    case 135816:
+      return acc + 10;
+    case 136793:
+      return acc + 11;
+    case 137770:
+      return acc + 12;
+    case 138747:
+      return acc + 13;
+    case 139724:
+      return acc + 1;
+    case 140701:
+      return acc + 2;
+    case 141678:
+      return acc + 3;
+    case 142655:
+      return acc + 4;
+    case 143632:
+      return acc + 5;
+    case 144609:
+      return acc + 6;
+    case 145586:
+      return acc + 7;
+    case 146563:
+      return acc + 8;
+    case 147540:
+      return acc + 9;
+    case 148517:
+      return acc + 10;
+    case 149494:
+      return acc + 11;
+    case 150471:
+      return acc + 12;
+    case 151448:
+      return acc + 13;
+    case 152425:
+      return acc + 1;
+    case 153402:
+      return acc + 2;
+    case 154379:
+      return acc + 3;
+    case 155356:
+      return acc + 4;
+    case 156333:
+      return acc + 5;
+    case 157310:
+      return acc + 6;
+    case 158287:
+      return acc + 7;
+    case 159264:
+      return acc + 8;
+    case 160241:
+      return acc + 9;
+    case 161218:
+      return acc + 10;
+    case 162195:
+      return acc + 11;
+    case 163172:
+      return acc + 12;
+    case 164149:
+      return acc + 13;
+    case 165126:
+      return acc + 1;
+    case 166103:
+      return acc + 2;
+    case 167080:
+      return acc + 3;
+    case 168057:
+      return acc + 4;
+    case 169034:
+      return acc + 5;
+    case 170011:
+      return acc + 6;
+    case 170988:
+      return acc + 7;
+    case 171965:
+      return acc + 8;
+    case 172942:
+      return acc + 9;
+    case 173919:
+      return acc + 10;
+    case 174896:
+      return acc + 11;
+    case 175873:
+      return acc + 12;
+    case 176850:
+      return acc + 13;
+    case 177827:
+      return acc + 1;
+    case 178804:
+      return acc + 2;
+    case 179781:
+      return acc + 3;
+    case 180758:
+      return acc + 4;
+    case 181735:
+      return acc + 5;
+    case 182712:
+      return acc + 6;
+    case 183689:
+      return acc + 7;
+    case 184666:
+      return acc + 8;
+    case 185643:
+      return acc + 9;
+    case 186620:
+      return acc + 10;
+    case 187597:
+      return acc + 11;
+    case 188574:
+      return acc + 12;
+    case 189551:
+      return acc + 13;
+    case 190528:
+      return acc + 1;
+    case 191505:
+      return acc + 2;
+    case 192482:
+      return acc + 3;
+    case 193459:
+      return acc + 4;
+    case 194436:
+      return acc + 5;
+  }
+  return acc - 1;
+}
+
+int main() {
+  int acc = 0;
+  for (int i = 0; i < 3000000; i++) {
+    acc = dense(i % 211, acc) & 65535;
+    acc = sparse(i % 200 * 977 + 13 + i % 3, acc) & 65535;
+  }
+  printf("%d\n", acc);
+  return 0;
+}
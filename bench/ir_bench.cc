@@ -0,0 +1,64 @@
+/*
+ * This project is exclusively owned by QingChuanWS and shall not be used for
+ * commercial and profitting purpose without QingChuanWS's permission.
+ *
+ * @ Author: bingshan45@163.com
+ * @ Github: https://github.com/QingChuanWS
+ * @ Description: compiler wall time and peak memory benchmark.
+ *
+ * Copyright (c) 2023 by QingChuanWS, All Rights Reserved.
+ */
+
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+
+// Run the compiler on every input file several times and report the best
+// wall time and the peak resident set size of the compiler process. Build
+// toyc with and without -DTOYC_SHARED_IR=ON to compare the IR allocators.
+static bool RunOnce(const char* toyc, const char* input, double* ms, long* max_rss) {
+  auto start = std::chrono::steady_clock::now();
+  pid_t pid = fork();
+  if (pid == 0) {
+    execl(toyc, toyc, "-o", "/dev/null", input, static_cast<char*>(nullptr));
+    _exit(127);
+  }
+  int status = 0;
+  struct rusage usage = {};
+  if (pid < 0 || wait4(pid, &status, 0, &usage) < 0) {
+    return false;
+  }
+  *ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+  *max_rss = usage.ru_maxrss;
+  return WIFEXITED(status) && WEXITSTATUS(status) == 0;
+}
+
+int main(int argc, char** argv) {
+  if (argc < 4) {
+    fprintf(stderr, "usage: %s <toyc> <rounds> <preprocessed.c> ...\n", argv[0]);
+    return 1;
+  }
+  int rounds = std::max(1, atoi(argv[2]));
+  printf("%-32s %12s %14s\n", "input", "best ms", "peak rss KB");
+  for (int i = 3; i < argc; i++) {
+    double best = 1e30;
+    long rss = 0;
+    for (int r = 0; r < rounds; r++) {
+      double ms = 0;
+      long max_rss = 0;
+      if (!RunOnce(argv[1], argv[i], &ms, &max_rss)) {
+        fprintf(stderr, "%s failed on %s\n", argv[1], argv[i]);
+        return 1;
+      }
+      best = std::min(best, ms);
+      rss = std::max(rss, max_rss);
+    }
+    printf("%-32s %12.2f %14ld\n", argv[i], best, rss);
+  }
+  return 0;
+}
@@ -0,0 +1,82 @@
+/*
+ * This project is exclusively owned by QingChuanWS and shall not be used for
+ * commercial and profitting purpose without QingChuanWS's permission.
+ *
+ * @ Author: bingshan45@163.com
+ * @ Github: https://github.com/QingChuanWS
+ * @ Description: punctuator scanner micro benchmark.
+ *
+ * Copyright (c) 2023 by QingChuanWS, All Rights Reserved.
+ */
+
+#include <cctype>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "lexer.h"
+
+// The linear operator search used by the tokenizer before the dispatch table.
+static const std::vector<const char*> ops = {"<<=", ">>=", ">=", "==", "!=", "<=", "->",
+                                             "+=",  "-=",  "*=", "/=", "++", "--", "%=",
+                                             "&=",  "|=",  "^=", "&&", "||", "<<", ">>"};
+
+static bool StrEqual(const char* src, const char* dst, const int src_len) {
+  return memcmp(src, dst, src_len) == 0 && dst[src_len] == '\0';
+}
+
+static int LinearReadPunct(const char* p) {
+  for (auto& op : ops) {
+    if (StrEqual(p, op, strlen(op))) {
+      return strlen(op);
+    }
+  }
+  return std::ispunct(*p) ? 1 : 0;
+}
+
+// punctuation heavy source, every punctuator is separated by a space.
+static std::string CreateSource(size_t size) {
+  static const char* snippet[] = {"a[i]->b", "x<<=2;", "p++;", "q--;", "(x&&y)||!z;",
+                                  "a+=b*c;", "s->t.u[0]", "i>=j?k:l;", "m%=n;", "{};"};
+  std::string src;
+  for (size_t i = 0; src.size() < size; i++) {
+    src += snippet[i % (sizeof(snippet) / sizeof(snippet[0]))];
+    src += ' ';
+  }
+  src.append(4, '\0');
+  return src;
+}
+
+template <typename F>
+static double Run(const std::string& src, F read_punct, long* checksum) {
+  auto start = std::chrono::steady_clock::now();
+  long sum = 0;
+  for (int round = 0; round < 10; round++) {
+    for (const char* p = src.data(); *p != '\0';) {
+      int len = read_punct(p);
+      sum += len;
+      p += len ? len : 1;
+    }
+  }
+  auto end = std::chrono::steady_clock::now();
+  *checksum = sum;
+  return std::chrono::duration<double, std::milli>(end - start).count();
+}
+
+int main() {
+  std::string src = CreateSource(1 << 20);
+  long linear_sum = 0;
+  long table_sum = 0;
+  double linear = Run(src, LinearReadPunct, &linear_sum);
+  double table = Run(src, ReadPunct, &table_sum);
+  if (linear_sum != table_sum) {
+    fprintf(stderr, "punctuator length mismatch: %ld vs %ld\n", linear_sum, table_sum);
+    return 1;
+  }
+  printf("linear search : %8.2f ms\n", linear);
+  printf("dispatch table: %8.2f ms\n", table);
+  printf("speedup       : %8.2fx\n", linear / table);
+  return 0;
+}
@@ -0,0 +1,106 @@
+/*
+ * This project is exclusively owned by QingChuanWS and shall not be used for
+ * commercial and profitting purpose without QingChuanWS's permission.
+ *
+ * @ Author: bingshan45@163.com
+ * @ Github: https://github.com/QingChuanWS
+ * @ Description: generated code run time benchmark.
+ *
+ * Copyright (c) 2023 by QingChuanWS, All Rights Reserved.
+ */
+
+#include <fcntl.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+// Compile every program at -O0 and -O1, link it with cc and report the best
+// run time of each build. The outputs of both builds have to match.
+static bool Run(const std::vector<std::string>& args, const std::string& out, double* ms) {
+  std::vector<char*> argv;
+  for (const std::string& arg : args) {
+    argv.push_back(const_cast<char*>(arg.c_str()));
+  }
+  argv.push_back(nullptr);
+
+  auto start = std::chrono::steady_clock::now();
+  pid_t pid = fork();
+  if (pid == 0) {
+    if (!out.empty()) {
+      int fd = open(out.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+      if (fd < 0 || dup2(fd, STDOUT_FILENO) < 0) {
+        _exit(127);
+      }
+    }
+    execvp(argv[0], argv.data());
+    _exit(127);
+  }
+  int status = 0;
+  if (pid < 0 || waitpid(pid, &status, 0) < 0) {
+    return false;
+  }
+  if (ms != nullptr) {
+    *ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start)
+              .count();
+  }
+  return WIFEXITED(status) && WEXITSTATUS(status) == 0;
+}
+
+static std::string ReadFile(const std::string& path) {
+  std::ifstream in(path);
+  std::stringstream ss;
+  ss << in.rdbuf();
+  return ss.str();
+}
+
+int main(int argc, char** argv) {
+  if (argc < 4) {
+    fprintf(stderr, "usage: %s <toyc> <rounds> <program.c> ...\n", argv[0]);
+    return 1;
+  }
+  int rounds = std::max(1, atoi(argv[2]));
+  std::string tmp = "/tmp/toyc_runtime_bench_" + std::to_string(getpid());
+  const char* levels[] = {"-O0", "-O1"};
+
+  printf("%-32s %12s %12s %9s\n", "program", "-O0 ms", "-O1 ms", "speedup");
+  for (int i = 3; i < argc; i++) {
+    double best[2] = {1e30, 1e30};
+    std::string output[2];
+    for (int l = 0; l < 2; l++) {
+      std::string asm_path = tmp + levels[l] + ".s";
+      std::string exe_path = tmp + levels[l];
+      std::string out_path = tmp + levels[l] + ".out";
+      if (!Run({argv[1], levels[l], "-o", asm_path, argv[i]}, "", nullptr) ||
+          !Run({"cc", "-o", exe_path, asm_path}, "", nullptr)) {
+        fprintf(stderr, "failed to build %s with %s\n", argv[i], levels[l]);
+        return 1;
+      }
+      for (int r = 0; r < rounds; r++) {
+        double ms = 0;
+        if (!Run({exe_path}, out_path, &ms)) {
+          fprintf(stderr, "%s built with %s failed\n", argv[i], levels[l]);
+          return 1;
+        }
+        best[l] = std::min(best[l], ms);
+      }
+      output[l] = ReadFile(out_path);
+      remove(asm_path.c_str());
+      remove(exe_path.c_str());
+      remove(out_path.c_str());
+    }
+    if (output[0] != output[1]) {
+      fprintf(stderr, "%s: output mismatch between -O0 and -O1\n", argv[i]);
+      return 1;
+    }
+    printf("%-32s %12.2f %12.2f %8.2fx\n", argv[i], best[0], best[1], best[0] / best[1]);
+  }
+  return 0;
+}
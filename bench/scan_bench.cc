@@ -0,0 +1,137 @@
+/*
+ * This project is exclusively owned by QingChuanWS and shall not be used for
+ * commercial and profitting purpose without QingChuanWS's permission.
+ *
+ * @ Author: bingshan45@163.com
+ * @ Github: https://github.com/QingChuanWS
+ * @ Description: whitespace, identifier and comment scanner benchmark.
+ *
+ * Copyright (c) 2023 by QingChuanWS, All Rights Reserved.
+ */
+
+#include <cctype>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <string>
+
+#include "lexer.h"
+
+// The byte-at-a-time loops used by the tokenizer before the scanner kernels.
+static bool IsAlnum(const char c) {
+  return ('a' <= c && c <= 'z') || ('A' <= c && c <= 'Z') || c == '_' || ('0' <= c && c <= '9');
+}
+
+static const char* LegacySkipSpace(const char* p) {
+  while (std::isspace(*p) && *p != '\n') {
+    p++;
+  }
+  return p;
+}
+
+static const char* LegacySkipIdent(const char* p) {
+  while (IsAlnum(*p)) {
+    p++;
+  }
+  return p;
+}
+
+static const char* LegacyFindCommentEnd(const char* p) { return strstr(p, "*/"); }
+
+static const ScanKernels legacy_kernels = {"legacy", LegacySkipSpace, LegacySkipIdent,
+                                           LegacyFindCommentEnd};
+
+// a preprocessed-looking translation unit, used if no file is given.
+static std::string CreateSource(size_t size) {
+  static const char* snippet =
+      "/*\n"
+      " * Compute the checksum of a packet header, the header is treated as a\n"
+      " * sequence of 16-bit words and folded with end-around carry.\n"
+      " */\n"
+      "static unsigned short packet_header_checksum(struct packet_header *header, int length) {\n"
+      "        unsigned long accumulated_sum = 0;\n"
+      "        for (int word_index = 0; word_index < length; word_index++) {\n"
+      "                accumulated_sum += header->payload_words[word_index];\n"
+      "        }\n"
+      "        while (accumulated_sum >> 16)\n"
+      "                accumulated_sum = (accumulated_sum & 65535) + (accumulated_sum >> 16);\n"
+      "        return ~accumulated_sum;\n"
+      "}\n\n";
+  std::string src;
+  while (src.size() < size) {
+    src += snippet;
+  }
+  return src;
+}
+
+// walk the buffer the same way as Token::CreateTokens does.
+static long Scan(const char* p, const ScanKernels& k) {
+  long tokens = 0;
+  while (*p != '\0') {
+    if (p[0] == '/' && p[1] == '*') {
+      p = k.find_comment_end(p + 2) + 2;
+      continue;
+    }
+    if (*p == '\n') {
+      p++;
+      continue;
+    }
+    if (std::isspace(*p)) {
+      p = k.skip_space(p);
+      continue;
+    }
+    if (('a' <= (*p | 0x20) && (*p | 0x20) <= 'z') || *p == '_') {
+      p = k.skip_ident(p + 1);
+    } else {
+      p++;
+    }
+    tokens++;
+  }
+  return tokens;
+}
+
+int main(int argc, char** argv) {
+  std::string src;
+  if (argc > 1) {
+    for (int i = 1; i < argc; i++) {
+      std::ifstream in(argv[i]);
+      std::stringstream buf;
+      buf << in.rdbuf();
+      src += buf.str();
+    }
+  } else {
+    src = CreateSource(16 << 20);
+  }
+  src.append(kScanPadding, '\0');
+
+  const ScanKernels* kernels[] = {&legacy_kernels, &scalar_kernels, &sse2_kernels,
+                                  &avx2_kernels};
+  double base = 0;
+  long expect = -1;
+  printf("input: %zu bytes, selected kernels: %s\n", src.size() - kScanPadding,
+         scan_kernels.name);
+  for (const ScanKernels* k : kernels) {
+    // avx2 kernels are only runnable if the cpu check selected them.
+    if (k->name == nullptr || (k == &avx2_kernels && &scan_kernels != &avx2_kernels)) {
+      continue;
+    }
+    auto start = std::chrono::steady_clock::now();
+    long tokens = 0;
+    for (int round = 0; round < 5; round++) {
+      tokens = Scan(src.data(), *k);
+    }
+    auto end = std::chrono::steady_clock::now();
+    double ms = std::chrono::duration<double, std::milli>(end - start).count() / 5;
+    if (expect == -1) {
+      expect = tokens;
+      base = ms;
+    } else if (tokens != expect) {
+      fprintf(stderr, "%s kernels disagree: %ld vs %ld tokens\n", k->name, tokens, expect);
+      return 1;
+    }
+    printf("%-8s: %8.2f ms  %6.2fx\n", k->name, ms, base / ms);
+  }
+  return 0;
+}
@@ -0,0 +1,59 @@
+/*
+ * This project is exclusively owned by QingChuanWS and shall not be used for
+ * commercial and profitting purpose without QingChuanWS's permission.
+ *
+ * @ Author: bingshan45@163.com
+ * @ Github: https://github.com/QingChuanWS
+ * @ Description:
+ *
+ * Copyright (c) 2023 by QingChuanWS, All Rights Reserved.
+ */
+
+#ifndef ARENA_GRUAD
+#define ARENA_GRUAD
+
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+// Chunked bump allocator.
+//
+// Objects are constructed in place inside fixed capacity chunks. A chunk is
+// never reallocated, so the address of an object stays valid until the arena
+// itself is destroyed, and all objects are released together at that point.
+template <typename T, size_t kChunkSize = 1024>
+class Arena {
+ public:
+  Arena() = default;
+  Arena(const Arena&) = delete;
+  Arena& operator=(const Arena&) = delete;
+
+  // construct a T in the arena and return its stable address.
+  template <typename... Args>
+  T* Create(Args&&... args) {
+    if (chunks.empty() || chunks.back().size() == kChunkSize) {
+      chunks.emplace_back();
+      chunks.back().reserve(kChunkSize);
+    }
+    chunks.back().emplace_back(std::forward<Args>(args)...);
+    return &chunks.back().back();
+  }
+  // number of objects allocated from the arena.
+  size_t Size() const {
+    return chunks.empty() ? 0 : (chunks.size() - 1) * kChunkSize + chunks.back().size();
+  }
+
+ private:
+  std::vector<std::vector<T>> chunks{};
+};
+
+// the arena owning every object of type T created by MakeIR() in utils.h.
+// It is created on first use, so it is ready even for the objects built
+// during static initialization.
+template <typename T>
+Arena<T>& GetArena() {
+  static Arena<T> arena;
+  return arena;
+}
+
+#endif  // ARENA_GRUAD
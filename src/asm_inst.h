@@ -0,0 +1,230 @@
+/*
+ * This project is exclusively owned by QingChuanWS and shall not be used for
+ * commercial and profitting purpose without QingChuanWS's permission.
+ *
+ * @ Author: bingshan45@163.com
+ * @ Github: https://github.com/QingChuanWS
+ * @ Description:
+ *
+ * Copyright (c) 2023 by QingChuanWS, All Rights Reserved.
+ */
+
+#ifndef ASM_INST_GRUAD
+#define ASM_INST_GRUAD
+
+#include <cstdint>
+#include <vector>
+
+#include "utils.h"
+
+// x86-64 registers, numbered as in the instruction encoding.
+enum AsmReg : uint8_t {
+  REG_AX,
+  REG_CX,
+  REG_DX,
+  REG_BX,
+  REG_SP,
+  REG_BP,
+  REG_SI,
+  REG_DI,
+  REG_R8,
+  REG_R9,
+  REG_R10,
+  REG_R11,
+  REG_R12,
+  REG_R13,
+  REG_R14,
+  REG_R15,
+  REG_IP,  // only as a memory operand base.
+};
+
+enum AsmOp : uint8_t {
+  // ---- directives ----
+  AS_INTEL,   // .intel_syntax noprefix
+  AS_DATA,    // .data
+  AS_TEXT,    // .text
+  AS_GLOBAL,  // .global <label>
+  AS_LOCAL,   // .local <label>
+  AS_LABEL,   // <label>:
+  AS_BYTE,    // .byte <imm>
+  AS_ZERO,    // .zero <imm>
+  AS_LOC,     // .loc 1 <imm>
+  AS_OFFSET,  // .long <label> - <base label>
+  // ---- instructions ----
+  I_PUSH,
+  I_POP,
+  I_MOV,
+  I_LEA,
+  I_ADD,
+  I_SUB,
+  I_IMUL,
+  I_IDIV,
+  I_CQO,
+  I_CDQ,
+  I_REP_MOVSB,
+  I_NEG,
+  I_NOT,
+  I_AND,
+  I_OR,
+  I_XOR,
+  I_CMP,
+  I_SETE,
+  I_SETNE,
+  I_SETL,
+  I_SETLE,
+  I_MOVZX,
+  I_MOVSX,
+  I_MOVSXD,
+  I_SHL,
+  I_SAR,
+  I_SHR,
+  I_JMP,
+  I_JE,
+  I_JNE,
+  I_JL,
+  I_JLE,
+  I_JG,
+  I_JGE,
+  I_JA,
+  I_CALL,
+  I_RET,
+  I_END,
+};
+
+// label name prefixes, a label is printed as <prefix><id> or <prefix><name>.
+enum AsmLabelKind : uint8_t {
+  LB_SYMBOL,  // <name>
+  LB_UNIQUE,  // .L..<id>
+  LB_BEGIN,   // .L.begin.<id>
+  LB_ELSE,    // .L.else.<id>
+  LB_END,     // .L.end.<id>
+  LB_TRUE,    // .L.true.<id>
+  LB_FALSE,   // .L.false.<id>
+  LB_RETURN,  // .L.return.<name>
+  LB_TABLE,   // .L.table.<id>
+};
+
+struct AsmLabel {
+  AsmLabelKind kind = LB_SYMBOL;
+  int id = -1;
+  // the name is owned by the IR object or symbol it names.
+  const String* name = nullptr;
+};
+
+struct AsmOperand {
+  enum Kind : uint8_t { OPD_NONE, OPD_REG, OPD_IMM, OPD_MEM, OPD_LABEL };
+
+  Kind kind = OPD_NONE;
+  // register, or base register of a memory operand.
+  AsmReg reg = REG_AX;
+  // access size in bytes.
+  uint8_t size = 8;
+  // print the displacement of a memory operand even if it is zero.
+  bool has_disp = false;
+  // scaled index register of a memory operand, a scale of 0 means none.
+  AsmReg index = REG_AX;
+  uint8_t scale = 0;
+  // immediate value or memory displacement.
+  int64_t imm = 0;
+  // jump or call target, or the symbol of a rip relative memory operand.
+  AsmLabel label{};
+};
+
+struct AsmInst {
+  AsmOp op = I_END;
+  AsmOperand dst{};
+  AsmOperand src{};
+};
+
+using AsmBuffer = std::vector<AsmInst>;
+
+inline bool FitsInt32(int64_t v) { return v >= INT32_MIN && v <= INT32_MAX; }
+
+// ---- operand constructors ----
+inline AsmOperand Reg(AsmReg reg, int size = 8) {
+  AsmOperand o;
+  o.kind = AsmOperand::OPD_REG;
+  o.reg = reg;
+  o.size = size;
+  return o;
+}
+
+inline AsmOperand Imm(int64_t val) {
+  AsmOperand o;
+  o.kind = AsmOperand::OPD_IMM;
+  o.imm = val;
+  return o;
+}
+
+// [base + disp] accessing size bytes.
+inline AsmOperand Mem(AsmReg base, int64_t disp = 0, int size = 8, bool has_disp = false) {
+  AsmOperand o;
+  o.kind = AsmOperand::OPD_MEM;
+  o.reg = base;
+  o.imm = disp;
+  o.size = size;
+  o.has_disp = has_disp || disp != 0;
+  return o;
+}
+
+// [base + index * scale] accessing size bytes.
+inline AsmOperand IndexMem(AsmReg base, AsmReg index, int scale, int size = 8) {
+  AsmOperand o = Mem(base, 0, size);
+  o.index = index;
+  o.scale = scale;
+  return o;
+}
+
+// [rip + symbol].
+inline AsmOperand RipMem(const String& symbol) {
+  AsmOperand o = Mem(REG_IP);
+  o.label = {LB_SYMBOL, -1, &symbol};
+  return o;
+}
+
+// [rip + local label].
+inline AsmOperand RipMem(AsmLabelKind kind, int id) {
+  AsmOperand o = Mem(REG_IP);
+  o.label = {kind, id, nullptr};
+  return o;
+}
+
+inline AsmOperand Label(AsmLabelKind kind, int id) {
+  AsmOperand o;
+  o.kind = AsmOperand::OPD_LABEL;
+  o.label = {kind, id, nullptr};
+  return o;
+}
+
+inline AsmOperand Label(AsmLabelKind kind, const String& name) {
+  AsmOperand o;
+  o.kind = AsmOperand::OPD_LABEL;
+  o.label = {kind, -1, &name};
+  return o;
+}
+
+// struct copies up to this many bytes are unrolled into moves, longer ones
+// use rep movsb.
+constexpr int kUnrolledCopyMax = 64;
+
+// copy size bytes from [src] to [dst] through tmp, in the widest moves that
+// fit. A tail of a copy of 8 bytes or more is done by one 8 byte move that
+// overlaps the bytes already copied.
+inline void EmitCopy(AsmBuffer& out, AsmReg dst, AsmReg src, int size, AsmReg tmp) {
+  int i = 0;
+  while (i < size) {
+    int chunk = 8;
+    if (size - i < 8 && size >= 8) {
+      i = size - 8;
+    } else {
+      while (chunk > size - i) {
+        chunk /= 2;
+      }
+    }
+    out.push_back({I_MOV, Reg(tmp, chunk), Mem(src, i, chunk, true)});
+    out.push_back({I_MOV, Mem(dst, i, chunk, true), Reg(tmp, chunk)});
+    i += chunk;
+  }
+}
+
+#endif  // !ASM_INST_GRUAD
@@ -11,15 +11,212 @@
 
 #include "codegen.h"
 
+#include <unistd.h>
+
+#include <algorithm>
 #include <cstddef>
-#include <iostream>
+#include <cstdlib>
 
+#include "elf_writer.h"
+#include "ir.h"
+#include "ir_codegen.h"
 #include "node.h"
 #include "object.h"
+#include "peephole.h"
+#include "regalloc.h"
+#include "ssa.h"
+#include "strength.h"
 #include "tools.h"
 #include "type.h"
 #include "utils.h"
 
+char* CodeGenPrinter::buf_begin = nullptr;
+char* CodeGenPrinter::buf_cur = nullptr;
+char* CodeGenPrinter::buf_end = nullptr;
+
+CodeGenPrinter::CodeGenPrinter(const Config& cfg) {
+  fd = OpenOutput(cfg.output_path);
+  Grow(1 << 20);
+  Println<CodeGenPrinter>(".file 1 \"", cfg.input_path, "\"\n");
+}
+
+CodeGenPrinter::~CodeGenPrinter() {
+  if (fd != STDOUT_FILENO) {
+    close(fd);
+  }
+  free(buf_begin);
+}
+
+void CodeGenPrinter::Grow(size_t len) {
+  size_t used = buf_cur - buf_begin;
+  size_t cap = buf_end - buf_begin;
+  while (cap - used < len) {
+    cap = cap ? cap * 2 : len;
+  }
+  buf_begin = static_cast<char*>(realloc(buf_begin, cap));
+  if (buf_begin == nullptr) {
+    Error("out of memory.");
+  }
+  buf_cur = buf_begin + used;
+  buf_end = buf_begin + cap;
+}
+
+void CodeGenPrinter::Flush() {
+  WriteAll(fd, buf_begin, buf_cur - buf_begin);
+  buf_cur = buf_begin;
+}
+
+// register names indexed by [size][register].
+static const char* reg_name[][REG_IP + 1] = {
+    {},
+    {"al", "cl", "dl", "bl", "spl", "bpl", "sil", "dil", "r8b", "r9b", "r10b", "r11b", "r12b",
+     "r13b", "r14b", "r15b", ""},
+    {"ax", "cx", "dx", "bx", "sp", "bp", "si", "di", "r8w", "r9w", "r10w", "r11w", "r12w", "r13w",
+     "r14w", "r15w", ""},
+    {},
+    {"eax", "ecx", "edx", "ebx", "esp", "ebp", "esi", "edi", "r8d", "r9d", "r10d", "r11d", "r12d",
+     "r13d", "r14d", "r15d", ""},
+    {},
+    {},
+    {},
+    {"rax", "rcx", "rdx", "rbx", "rsp", "rbp", "rsi", "rdi", "r8", "r9", "r10", "r11", "r12", "r13",
+     "r14", "r15", "rip"},
+};
+
+// mnemonic or directive of each op, including the indentation.
+static const char* op_name[] = {
+    "  .intel_syntax noprefix",
+    "  .data",
+    "  .text",
+    "  .global ",
+    "  .local ",
+    "",
+    "  .byte ",
+    "  .zero ",
+    "  .loc 1 ",
+    "  .long ",
+    "  push ",
+    "  pop ",
+    "  mov ",
+    "  lea ",
+    "  add ",
+    "  sub ",
+    "  imul ",
+    "  idiv ",
+    "  cqo",
+    "  cdq",
+    "  rep movsb",
+    "  neg ",
+    "  not ",
+    "  and ",
+    "  or ",
+    "  xor ",
+    "  cmp ",
+    "  sete ",
+    "  setne ",
+    "  setl ",
+    "  setle ",
+    "  movzx ",
+    "  movsx ",
+    "  movsxd ",
+    "  shl ",
+    "  sar ",
+    "  shr ",
+    "  jmp ",
+    "  je ",
+    "  jne ",
+    "  jl ",
+    "  jle ",
+    "  jg ",
+    "  jge ",
+    "  ja ",
+    "  call ",
+    "  ret",
+};
+static_assert(sizeof(op_name) / sizeof(op_name[0]) == I_END, "op_name doesn't match AsmOp.");
+
+static const char* label_prefix[] = {"",         ".L..",      ".L.begin.",  ".L.else.", ".L.end.",
+                                     ".L.true.", ".L.false.", ".L.return.", ".L.table."};
+
+static const char* size_ptr[] = {"", "BYTE PTR ", "WORD PTR ", "", "DWORD PTR ", "", "", "",
+                                 "QWORD PTR "};
+
+void CodeGenPrinter::Print(const AsmLabel& label) {
+  Print(label_prefix[label.kind]);
+  if (label.name != nullptr) {
+    Print(*label.name);
+  } else {
+    Print(label.id);
+  }
+}
+
+void CodeGenPrinter::Print(const AsmOperand& opd) {
+  switch (opd.kind) {
+    case AsmOperand::OPD_REG:
+      Print(reg_name[opd.size][opd.reg]);
+      return;
+    case AsmOperand::OPD_IMM:
+      Print(opd.imm);
+      return;
+    case AsmOperand::OPD_LABEL:
+      Print(opd.label);
+      return;
+    case AsmOperand::OPD_MEM:
+      Print('[');
+      Print(reg_name[8][opd.reg]);
+      if (opd.scale != 0) {
+        Print(" + ");
+        Print(reg_name[8][opd.index]);
+        if (opd.scale > 1) {
+          Print('*');
+          Print(static_cast<int>(opd.scale));
+        }
+      }
+      if (opd.reg == REG_IP) {
+        Print(" + ");
+        Print(opd.label);
+      } else if (opd.imm < 0) {
+        Print(" - ");
+        Print(-opd.imm);
+      } else if (opd.has_disp) {
+        Print(" + ");
+        Print(opd.imm);
+      }
+      Print(']');
+      return;
+    default:
+      return;
+  }
+}
+
+void CodeGenPrinter::Print(const AsmInst& inst) {
+  if (inst.op == AS_LABEL) {
+    Println<CodeGenPrinter>(inst.dst.label, ":\n");
+    return;
+  }
+  Print(op_name[inst.op]);
+  if (inst.dst.kind != AsmOperand::OPD_NONE) {
+    // nor is the size of the only operand of an instruction in memory.
+    if (inst.dst.kind == AsmOperand::OPD_MEM && inst.src.kind == AsmOperand::OPD_NONE) {
+      Print(size_ptr[inst.dst.size]);
+    }
+    Print(inst.dst);
+  }
+  if (inst.op == AS_OFFSET) {
+    Print(" - ");
+    Print(inst.src);
+  } else if (inst.src.kind != AsmOperand::OPD_NONE) {
+    Print(", ");
+    // the source size of a sign or zero extension isn't implied by a register.
+    bool extend = inst.op == I_MOVSX || inst.op == I_MOVSXD || inst.op == I_MOVZX;
+    if (extend && inst.src.kind == AsmOperand::OPD_MEM) {
+      Print(size_ptr[inst.src.size]);
+    }
+    Print(inst.src);
+  }
+  Print('\n');
+}
+
 static int Count() {
   static int count = 0;
   return count++;
@@ -27,20 +224,20 @@ static int Count() {
 
 static int depth = 0;
 
-static const char* argreg8[] = {"dil", "sil", "dl", "cl", "r8b", "r9b"};
-static const char* argreg16[] = {"di", "si", "dx", "cx", "r8w", "r9w"};
-static const char* argreg32[] = {"edi", "esi", "edx", "ecx", "r8d", "r9d"};
-static const char* argreg64[] = {"rdi", "rsi", "rdx", "rcx", "r8", "r9"};
+static const AsmReg argreg[] = {REG_DI, REG_SI, REG_DX, REG_CX, REG_R8, REG_R9};
 
-#define ASM_GEN(...) Println<CodeGenPrinter>(__VA_ARGS__, "\n");
+static const AsmOperand rax = Reg(REG_AX);
+static const AsmOperand eax = Reg(REG_AX, 4);
+static const AsmOperand al = Reg(REG_AX, 1);
+static const AsmOperand rdi = Reg(REG_DI);
 
 void CodeGenerator::GetVarAddr(NodePtr& node) {
   switch (node->kind) {
     case ND_VAR:
       if (node->var->Is<OB_LOCAL>()) {
-        ASM_GEN("  lea rax, [rbp - ", node->var->offset, "]");
+        Emit(I_LEA, rax, Mem(REG_BP, -node->var->offset));
       } else {
-        ASM_GEN("  lea rax, [rip + ", node->var->obj_name, "]");
+        Emit(I_LEA, rax, RipMem(node->var->obj_name));
       }
       return;
     case ND_DEREF:
@@ -52,7 +249,7 @@ void CodeGenerator::GetVarAddr(NodePtr& node) {
       return;
     case ND_MUMBER:
       GetVarAddr(node->lhs);
-      ASM_GEN("  add rax, ", node->mem->GetOffset());
+      Emit(I_ADD, rax, Imm(node->ext->mem->GetOffset()));
       return;
     default:
       break;
@@ -61,18 +258,70 @@ void CodeGenerator::GetVarAddr(NodePtr& node) {
   node->name->ErrorTok("not an lvalue");
 }
 
+static bool IsAggregate(const TypePtr& ty) {
+  return ty->Is<TY_ARRAY>() || ty->Is<TY_STRUCT>() || ty->Is<TY_UNION>();
+}
+
+bool CodeGenerator::VarMem(NodePtr& node, AsmOperand* mem) {
+  if (node->kind == ND_VAR) {
+    *mem = node->var->Is<OB_LOCAL>() ? Mem(REG_BP, -node->var->offset)
+                                     : RipMem(node->var->obj_name);
+    return true;
+  }
+  // a rip relative operand has no displacement besides its symbol.
+  if (node->kind == ND_MUMBER && VarMem(node->lhs, mem) && mem->reg == REG_BP) {
+    *mem = Mem(REG_BP, mem->imm + node->ext->mem->GetOffset());
+    return true;
+  }
+  return false;
+}
+
+AsmOperand CodeGenerator::DirectOperand(NodePtr& node, int sz) {
+  if (node->kind == ND_NUM) {
+    return Imm(node->val);
+  }
+  // the usual arithmetic conversions cast operands to their own type too.
+  if (node->kind == ND_CAST && node->ty->Size() == node->lhs->ty->Size()) {
+    return DirectOperand(node->lhs, sz);
+  }
+  AsmOperand mem;
+  if (!IsAggregate(node->ty) && node->ty->Size() == sz && VarMem(node, &mem)) {
+    mem.size = sz;
+    return mem;
+  }
+  return AsmOperand();
+}
+
+AsmOperand CodeGenerator::BinaryOperands(NodePtr& node, int sz, bool commute) {
+  AsmOperand opd = DirectOperand(node->rhs, sz);
+  if (opd.kind != AsmOperand::OPD_NONE) {
+    ExprGen(node->lhs);
+    return opd;
+  }
+  opd = commute ? DirectOperand(node->lhs, sz) : AsmOperand();
+  if (opd.kind != AsmOperand::OPD_NONE) {
+    ExprGen(node->rhs);
+    return opd;
+  }
+  ExprGen(node->rhs);
+  Push();
+  ExprGen(node->lhs);
+  Pop(REG_DI);
+  return Reg(REG_DI, sz);
+}
+
 void CodeGenerator::Push() {
-  ASM_GEN("  push rax");
+  Emit(I_PUSH, rax);
   depth++;
 }
 
-void CodeGenerator::Pop(const char* arg) {
-  ASM_GEN("  pop ", arg);
+void CodeGenerator::Pop(AsmReg reg) {
+  Emit(I_POP, Reg(reg));
   depth--;
 }
 
-void CodeGenerator::Load(TypePtr& ty) {
-  if (ty->Is<TY_ARRAY>() || ty->Is<TY_STRUCT>() || ty->Is<TY_UNION>()) {
+void CodeGenerator::Load(TypePtr& ty, AsmOperand addr) {
+  if (IsAggregate(ty)) {
     // If it is a array, do not attempt to load a value to
     // the register because we can't load entire array to
     // register. As a result, the evaluation's result isn't
@@ -81,47 +330,38 @@ void CodeGenerator::Load(TypePtr& ty) {
     // element of the array in C" occur.
     return;
   }
-  if (ty->Size() == 1) {
-    ASM_GEN("  movsbl eax, BYTE PTR [rax]");
-  } else if (ty->Size() == 2) {
-    ASM_GEN("  movswl eax, WORD PTR [rax]");
+  addr.size = ty->Size();
+  if (ty->Size() == 1 || ty->Size() == 2) {
+    Emit(I_MOVSX, eax, addr);
   } else if (ty->Size() == 4) {
-    ASM_GEN("  movsxd rax, DWORD PTR [rax]");
+    Emit(I_MOVSXD, rax, addr);
   } else {
-    ASM_GEN("  mov rax, [rax]");
+    Emit(I_MOV, rax, addr);
   }
 }
 
 void CodeGenerator::Store(TypePtr& ty) {
-  Pop("rdi");
+  Pop(REG_DI);
   if (ty->Is<TY_STRUCT>() || ty->Is<TY_UNION>()) {
-    for (int i = 0; i < ty->Size(); i++) {
-      ASM_GEN("  mov r8b, [rax + ", i, "]");
-      ASM_GEN("  mov [rdi + ", i, "], r8b");
+    if (ty->Size() <= kUnrolledCopyMax) {
+      EmitCopy(insts, REG_DI, REG_AX, ty->Size(), REG_R8);
+    } else {
+      Emit(I_MOV, Reg(REG_SI), Reg(REG_AX));
+      Emit(I_MOV, Reg(REG_CX, 4), Imm(ty->Size()));
+      Emit(I_REP_MOVSB);
     }
     return;
   }
 
-  if (ty->Size() == 1) {
-    ASM_GEN("  mov [rdi], al");
-  } else if (ty->Size() == 2) {
-    ASM_GEN("  mov [rdi], ax");
-  } else if (ty->Size() == 4) {
-    ASM_GEN("  mov [rdi], eax");
-  } else {
-    ASM_GEN("  mov [rdi], rax");
-  }
+  Emit(I_MOV, Mem(REG_DI, 0, ty->Size()), Reg(REG_AX, ty->Size()));
 }
 
 void CodeGenerator::Cast(TypePtr from, TypePtr to) {
-  static const char* i32i8 = "movsbl eax, al";
-  static const char* i32i16 = "movswl eax, ax";
-  static const char* i32i64 = "movsxd rax, eax";
-
-  static Matrix<const char*> cast_table = {{nullptr, nullptr, nullptr, i32i64},
-                                           {i32i8, nullptr, nullptr, i32i64},
-                                           {i32i8, i32i16, nullptr, i32i64},
-                                           {i32i8, i32i16, nullptr, nullptr}};
+  enum { NONE = 0, I32I8, I32I16, I32I64 };
+  static const int cast_table[4][4] = {{NONE, NONE, NONE, I32I64},
+                                       {I32I8, NONE, NONE, I32I64},
+                                       {I32I8, I32I16, NONE, I32I64},
+                                       {I32I8, I32I16, NONE, NONE}};
 
   auto GetTypeId = [](TypePtr& t) -> int {
     enum { I8 = 0, I16, I32, I64 };
@@ -135,36 +375,57 @@ void CodeGenerator::Cast(TypePtr from, TypePtr to) {
       return I64;
     }
   };
-  auto cmp_zero = [](const TypePtr& ty) {
-    if (ty->IsInteger() && ty->Size() <= 4) {
-      ASM_GEN("  cmp eax, 0");
-    } else {
-      ASM_GEN("  cmp rax, 0");
-    }
-  };
 
   if (to->Is<TY_VOID>()) {
     return;
   }
 
   if (to->Is<TY_BOOL>()) {
-    cmp_zero(from);
-    ASM_GEN("  setne al");
-    ASM_GEN("  movzx eax, al");
+    if (from->IsInteger() && from->Size() <= 4) {
+      Emit(I_CMP, eax, Imm(0));
+    } else {
+      Emit(I_CMP, rax, Imm(0));
+    }
+    Emit(I_SETNE, al);
+    Emit(I_MOVZX, eax, al);
     return;
   }
 
-  auto t1 = GetTypeId(from);
-  auto t2 = GetTypeId(to);
-  if (cast_table[t1][t2]) {
-    ASM_GEN("  ", cast_table[t1][t2]);
+  switch (cast_table[GetTypeId(from)][GetTypeId(to)]) {
+    case I32I8:
+      Emit(I_MOVSX, eax, al);
+      return;
+    case I32I16:
+      Emit(I_MOVSX, eax, Reg(REG_AX, 2));
+      return;
+    case I32I64:
+      Emit(I_MOVSXD, rax, eax);
+      return;
+    default:
+      return;
   }
 }
 
 void CodeGenerator::CodeGen(const ASTree& ast) {
-  Object::OffsetCal(ast.globals);
+  Object::OffsetCal(ast.globals, cfg.frame_report);
   EmitData(ast);
   EmitText(ast);
+
+  Peephole peephole(cfg.peephole_rules);
+  peephole.Run(insts);
+  if (cfg.peephole_report) {
+    peephole.Report(stderr);
+  }
+
+  if (cfg.emit_obj) {
+    ElfWriter(cfg).Write(insts);
+    return;
+  }
+  CodeGenPrinter& printer = CodeGenPrinter::GetInstance(cfg);
+  for (const AsmInst& inst : insts) {
+    printer.Print(inst);
+  }
+  printer.Flush();
 }
 
 void CodeGenerator::EmitData(const ASTree& ast) {
@@ -172,60 +433,61 @@ void CodeGenerator::EmitData(const ASTree& ast) {
     if (var->Is<OB_FUNCTION>()) {
       continue;
     }
-    ASM_GEN("  .data");
-    ASM_GEN("  .global ", var->obj_name);
-    ASM_GEN(var->obj_name, ":");
+    Emit(AS_DATA);
+    Emit(AS_GLOBAL, Label(LB_SYMBOL, var->obj_name));
+    Emit(AS_LABEL, Label(LB_SYMBOL, var->obj_name));
     if (var->is_string) {
       for (int i = 0; i < var->ty->Size(); i++) {
-        ASM_GEN("  .byte ", static_cast<int>(var->init_data[i]));
+        Emit(AS_BYTE, Imm(var->init_data[i]));
       }
     } else {
-      ASM_GEN("  .zero ", var->ty->Size());
+      Emit(AS_ZERO, Imm(var->ty->Size()));
     }
   }
 }
 
 void CodeGenerator::StoreFunctionParameter(int reg, int offset, int sz) {
-  switch (sz) {
-    case 1:
-      ASM_GEN("  mov [rbp - ", offset, "], ", argreg8[reg]);
-      break;
-    case 2:
-      ASM_GEN("  mov [rbp - ", offset, "], ", argreg16[reg]);
-      break;
-    case 4:
-      ASM_GEN("  mov [rbp - ", offset, "], ", argreg32[reg]);
-      break;
-    case 8:
-      ASM_GEN("  mov [rbp - ", offset, "], ", argreg64[reg]);
-      break;
-    default:
-      unreachable();
+  if (sz != 1 && sz != 2 && sz != 4 && sz != 8) {
+    unreachable();
   }
+  Emit(I_MOV, Mem(REG_BP, -offset, sz), Reg(argreg[reg], sz));
 }
 
 void CodeGenerator::EmitText(const ASTree& ast) {
   // using intel syntax
   // e.g. op dst, src
-  ASM_GEN("  .intel_syntax noprefix");
+  Emit(AS_INTEL);
   for (ObjectPtr fn : ast.globals) {
     if (fn->Is<OB_GLOBAL>()) {
       continue;
     }
 
     if (fn->func_attr.is_static) {
-      ASM_GEN("  .local ", fn->obj_name);
+      Emit(AS_LOCAL, Label(LB_SYMBOL, fn->obj_name));
     } else {
-      ASM_GEN("  .global ", fn->obj_name);
+      Emit(AS_GLOBAL, Label(LB_SYMBOL, fn->obj_name));
     }
-    ASM_GEN(" .text");
-    ASM_GEN(fn->obj_name, ":");
+    Emit(AS_TEXT);
+    Emit(AS_LABEL, Label(LB_SYMBOL, fn->obj_name));
     cur_func = fn;
 
+    if (cfg.opt_level > 0 || cfg.dump_ir) {
+      IRFunction ir = IRBuilder::Build(fn);
+      SSA::Construct(ir);
+      if (cfg.dump_ir) {
+        ir.Dump(stderr);
+      }
+      if (cfg.opt_level > 0) {
+        SSA::Destruct(ir);
+        IRCodeGenerator(ir, RegAlloc::Run(ir), insts).Gen();
+        continue;
+      }
+    }
+
     // prologue; equally instruction "enter 0xD0,0".
-    ASM_GEN("  push rbp");
-    ASM_GEN("  mov rbp, rsp");
-    ASM_GEN("  sub rsp, ", fn->func_attr.stack_size);
+    Emit(I_PUSH, Reg(REG_BP));
+    Emit(I_MOV, Reg(REG_BP), Reg(REG_SP));
+    Emit(I_SUB, Reg(REG_SP), Imm(fn->func_attr.stack_size));
 
     int i = 0;
     for (auto var = fn->params.rbegin(); var != fn->params.rend(); var++) {
@@ -237,88 +499,73 @@ void CodeGenerator::EmitText(const ASTree& ast) {
     DEBUG(depth == 0);
 
     // Epilogue; equally instruction leave.
-    ASM_GEN(".L.return.", fn->obj_name, ":");
-    ASM_GEN("  mov rsp, rbp");
-    ASM_GEN("  pop rbp");
-    ASM_GEN("  ret");
+    Emit(AS_LABEL, Label(LB_RETURN, fn->obj_name));
+    Emit(I_MOV, Reg(REG_SP), Reg(REG_BP));
+    Emit(I_POP, Reg(REG_BP));
+    Emit(I_RET);
   }
 }
 
 void CodeGenerator::StmtGen(NodePtr& node) {
-  ASM_GEN("  .loc 1 ", node->name->GetLineNo());
+  Emit(AS_LOC, Imm(node->name->GetLineNo()));
 
   switch (node->kind) {
     case ND_EXPR_STMT:
       ExprGen(node->lhs);
       return;
     case ND_BLOCK:
-      for (NodePtr& n = node->body; n != nullptr; n = n->next) {
+      for (NodePtr& n = node->ext->body; n != nullptr; n = n->next) {
         StmtGen(n);
       }
       return;
     case ND_GOTO:
-      ASM_GEN("  jmp ", node->unique_label);
+      Emit(I_JMP, Label(LB_UNIQUE, node->ext->unique_label));
       return;
     case ND_LABEL:
-      ASM_GEN(node->unique_label, ":");
-      StmtGen(node->body);
+      Emit(AS_LABEL, Label(LB_UNIQUE, node->ext->unique_label));
+      StmtGen(node->ext->body);
       return;
     case ND_RETURN:
       ExprGen(node->lhs);
-      ASM_GEN("  jmp .L.return.", cur_func->obj_name);
+      Emit(I_JMP, Label(LB_RETURN, cur_func->obj_name));
       return;
     case ND_IF: {
       int seq = Count();
-      ExprGen(node->cond);
-      ASM_GEN("  cmp rax, 0");
-      ASM_GEN("  je .L.else.", seq);
-      StmtGen(node->then);
-      ASM_GEN("  jmp .L.end.", seq);
-      ASM_GEN(".L.else.", seq, ":");
-      if (node->els != nullptr) {
-        StmtGen(node->els);
+      CondGen(node->ext->cond, false, Label(LB_ELSE, seq));
+      StmtGen(node->ext->then);
+      Emit(I_JMP, Label(LB_END, seq));
+      Emit(AS_LABEL, Label(LB_ELSE, seq));
+      if (node->ext->els != nullptr) {
+        StmtGen(node->ext->els);
       }
-      ASM_GEN(".L.end.", seq, ":");
+      Emit(AS_LABEL, Label(LB_END, seq));
       return;
     }
     case ND_SWITCH:
-      ExprGen(node->cond);
-      for (auto c : node->case_nodes) {
-        const char* reg = (node->cond->ty->Size() == 8 ? "rax" : "eax");
-        ASM_GEN("  cmp ", reg, ", ", c->val);
-        ASM_GEN("  je ", c->label);
-      }
-
-      if (node->default_node) {
-        ASM_GEN("  jmp ", node->default_node->label);
-      }
-
-      ASM_GEN("  jmp ", node->break_label);
-      StmtGen(node->then);
-      ASM_GEN(node->break_label, ": ");
+      SwitchGen(node);
+      StmtGen(node->ext->then);
+      Emit(AS_LABEL, Label(LB_UNIQUE, node->ext->break_label));
       return;
     case ND_CASE:
-      ASM_GEN(node->label, ":");
-      StmtGen(node->body);
+      Emit(AS_LABEL, Label(LB_UNIQUE, node->ext->unique_label));
+      StmtGen(node->ext->body);
       return;
     case ND_FOR: {
       int seq = Count();
-      if (node->init != nullptr) {
-        StmtGen(node->init);
+      if (node->ext->init != nullptr) {
+        StmtGen(node->ext->init);
       }
-      ASM_GEN(".L.begin.", seq, ":");
-      if (node->cond != nullptr) {
-        ExprGen(node->cond);
-        ASM_GEN("  cmp rax, 0");
-        ASM_GEN("  je ", node->break_label);
+      Emit(AS_LABEL, Label(LB_BEGIN, seq));
+      if (node->ext->cond != nullptr) {
+        CondGen(node->ext->cond, false, Label(LB_UNIQUE, node->ext->break_label));
       }
-      StmtGen(node->then);
-      ASM_GEN(node->continue_label, ":");
-      if (node->inc != nullptr) {
-        ExprGen(node->inc);
+      StmtGen(node->ext->then);
+      Emit(AS_LABEL, Label(LB_UNIQUE, node->ext->continue_label));
+      if (node->ext->inc != nullptr) {
+        ExprGen(node->ext->inc);
       }
-      ASM_GEN("  jmp .L.begin.", seq);
-      ASM_GEN(node->break_label, ":");
+      Emit(I_JMP, Label(LB_BEGIN, seq));
+      Emit(AS_LABEL, Label(LB_UNIQUE, node->ext->break_label));
       return;
     }
     default:
@@ -326,23 +573,131 @@ void CodeGenerator::StmtGen(NodePtr& node) {
   }
 }
 
+void CodeGenerator::CondGen(NodePtr& node, bool jump_if, const AsmOperand& target) {
+  Emit(AS_LOC, Imm(node->name->GetLineNo()));
+
+  switch (node->kind) {
+    case ND_NUM:
+      if ((node->val != 0) == jump_if) {
+        Emit(I_JMP, target);
+      }
+      return;
+    case ND_NOT:
+      CondGen(node->lhs, !jump_if, target);
+      return;
+    case ND_LOGAND:
+    case ND_LOGOR: {
+      // a || b is decided by a true side and a && b by a false one, any other
+      // outcome is only known after the right side.
+      bool is_or = node->kind == ND_LOGOR;
+      if (jump_if == is_or) {
+        CondGen(node->lhs, jump_if, target);
+        CondGen(node->rhs, jump_if, target);
+        return;
+      }
+      AsmOperand skip = Label(is_or ? LB_TRUE : LB_FALSE, Count());
+      CondGen(node->lhs, is_or, skip);
+      CondGen(node->rhs, jump_if, target);
+      Emit(AS_LABEL, skip);
+      return;
+    }
+    case ND_EQ:
+    case ND_NE:
+    case ND_LT:
+    case ND_LE: {
+      // jump taken when the relation holds, and when it does not.
+      static const AsmOp jcc[2][4] = {{I_JNE, I_JE, I_JGE, I_JG}, {I_JE, I_JNE, I_JL, I_JLE}};
+      int sz = (node->lhs->ty->Is<TY_LONG>() || node->lhs->IsPointerNode()) ? 8 : 4;
+      AsmOperand rhs = BinaryOperands(node, sz, node->kind == ND_EQ || node->kind == ND_NE);
+      if (rhs.kind == AsmOperand::OPD_IMM && !FitsInt32(rhs.imm)) {
+        Emit(I_MOV, rdi, rhs);
+        rhs = Reg(REG_DI, sz);
+      }
+      Emit(I_CMP, Reg(REG_AX, sz), rhs);
+      Emit(jcc[jump_if][node->kind - ND_EQ], target);
+      return;
+    }
+    default:
+      ExprGen(node);
+      Emit(I_CMP, rax, Imm(0));
+      Emit(jump_if ? I_JNE : I_JE, target);
+      return;
+  }
+}
+
+void CodeGenerator::SwitchGen(NodePtr& node) {
+  int sz = SwitchLowering::Size(node);
+  std::vector<SwitchCase> cases = SwitchLowering::Cases(node);
+  AsmOperand miss = Label(LB_UNIQUE, SwitchLowering::MissLabel(node));
+
+  ExprGen(node->ext->cond);
+  if (SwitchLowering::IsDenseSwitch(cases)) {
+    std::vector<AsmOperand> targets;
+    for (int label : SwitchLowering::Targets(cases)) {
+      targets.push_back(label >= 0 ? Label(LB_UNIQUE, label) : miss);
+    }
+    SwitchLowering::EmitTable(insts, Reg(REG_AX, sz), sz, cases.front().first, targets, miss,
+                              REG_DI, Count());
+    return;
+  }
+  SwitchSearch(cases, 0, cases.size(), sz, miss);
+}
+
+void CodeGenerator::SwitchSearch(const std::vector<SwitchCase>& cases, size_t lo, size_t hi,
+                                 int sz, const AsmOperand& miss) {
+  AsmOperand ax = Reg(REG_AX, sz);
+  auto compare = [&](int64_t val) {
+    if (val == static_cast<int32_t>(val)) {
+      Emit(I_CMP, ax, Imm(val));
+    } else {
+      Emit(I_MOV, rdi, Imm(val));
+      Emit(I_CMP, rax, rdi);
+    }
+  };
+
+  if (hi - lo < SwitchLowering::kMinCases) {
+    for (size_t i = lo; i < hi; i++) {
+      compare(cases[i].first);
+      Emit(I_JE, Label(LB_UNIQUE, cases[i].second));
+    }
+    Emit(I_JMP, miss);
+    return;
+  }
+  size_t mid = lo + (hi - lo) / 2;
+  AsmOperand upper = Label(LB_ELSE, Count());
+  compare(cases[mid].first);
+  Emit(I_JE, Label(LB_UNIQUE, cases[mid].second));
+  Emit(I_JG, upper);
+  SwitchSearch(cases, lo, mid, sz, miss);
+  Emit(AS_LABEL, upper);
+  SwitchSearch(cases, mid + 1, hi, sz, miss);
+}
+
 // post-order for code-gen
 void CodeGenerator::ExprGen(NodePtr& node) {
-  ASM_GEN("  .loc 1 ", node->name->GetLineNo());
+  Emit(AS_LOC, Imm(node->name->GetLineNo()));
 
   switch (node->kind) {
     case ND_NUM:
-      ASM_GEN("  mov rax, ", node->val);
+      Emit(I_MOV, rax, Imm(node->val));
       return;
     case ND_NEG:
       ExprGen(node->lhs);
-      ASM_GEN("  neg rax");
+      Emit(I_NEG, rax);
       return;
     case ND_VAR:
-    case ND_MUMBER:
-      GetVarAddr(node);
-      Load(node->ty);
+    case ND_MUMBER: {
+      AsmOperand mem;
+      if (!VarMem(node, &mem)) {
+        GetVarAddr(node);
+        Load(node->ty);
+      } else if (IsAggregate(node->ty)) {
+        Emit(I_LEA, rax, mem);
+      } else {
+        Load(node->ty, mem);
+      }
       return;
+    }
     case ND_DEREF:
       ExprGen(node->lhs);
       Load(node->ty);
@@ -350,14 +705,22 @@ void CodeGenerator::ExprGen(NodePtr& node) {
     case ND_ADDR:
       GetVarAddr(node->lhs);
       return;
-    case ND_ASSIGN:
+    case ND_ASSIGN: {
+      AsmOperand mem;
+      if (!IsAggregate(node->ty) && VarMem(node->lhs, &mem)) {
+        ExprGen(node->rhs);
+        mem.size = node->ty->Size();
+        Emit(I_MOV, mem, Reg(REG_AX, mem.size));
+        return;
+      }
       GetVarAddr(node->lhs);
       Push();
       ExprGen(node->rhs);
       Store(node->ty);
       return;
+    }
     case ND_STMT_EXPR:
-      for (NodePtr n = node->body; n != nullptr; n = n->next) {
+      for (NodePtr n = node->ext->body; n != nullptr; n = n->next) {
         StmtGen(n);
       }
       return;
@@ -371,151 +734,158 @@ void CodeGenerator::ExprGen(NodePtr& node) {
       return;
     case ND_COND: {
       int c = Count();
-      ExprGen(node->cond);
-      ASM_GEN("  cmp rax, 0");
-      ASM_GEN("  je .L.else.", c);
-      ExprGen(node->then);
-      ASM_GEN("  jmp .L.end.", c);
-      ASM_GEN(".L.else.", c, ":");
-      ExprGen(node->els);
-      ASM_GEN(".L.end.", c, ":");
+      CondGen(node->ext->cond, false, Label(LB_ELSE, c));
+      ExprGen(node->ext->then);
+      Emit(I_JMP, Label(LB_END, c));
+      Emit(AS_LABEL, Label(LB_ELSE, c));
+      ExprGen(node->ext->els);
+      Emit(AS_LABEL, Label(LB_END, c));
       return;
     }
     case ND_NOT:
       ExprGen(node->lhs);
-      ASM_GEN("  cmp rax, 0");
-      ASM_GEN("  sete al")
-      ASM_GEN("  movzx rax, al")
+      Emit(I_CMP, rax, Imm(0));
+      Emit(I_SETE, al);
+      Emit(I_MOVZX, rax, al);
       return;
     case ND_BITNOT:
       ExprGen(node->lhs);
-      ASM_GEN("   not rax")
+      Emit(I_NOT, rax);
       return;
     case ND_LOGOR: {
       int c = Count();
-      ExprGen(node->lhs);
-      ASM_GEN("  cmp rax, 0");
-      ASM_GEN("  jne .L.true.", c);
-      ExprGen(node->rhs);
-      ASM_GEN("  cmp rax, 0");
-      ASM_GEN("  jne .L.true.", c);
-      ASM_GEN("  mov rax, 0");
-      ASM_GEN("  jmp .L.end.", c);
-      ASM_GEN(".L.true.", c, ":");
-      ASM_GEN("  mov rax, 1");
-      ASM_GEN(".L.end.", c, ":");
+      CondGen(node->lhs, true, Label(LB_TRUE, c));
+      CondGen(node->rhs, true, Label(LB_TRUE, c));
+      Emit(I_MOV, rax, Imm(0));
+      Emit(I_JMP, Label(LB_END, c));
+      Emit(AS_LABEL, Label(LB_TRUE, c));
+      Emit(I_MOV, rax, Imm(1));
+      Emit(AS_LABEL, Label(LB_END, c));
       return;
     }
     case ND_LOGAND: {
       int c = Count();
-      ExprGen(node->lhs);
-      ASM_GEN("  cmp rax, 0");
-      ASM_GEN("  je .L.false.", c);
-      ExprGen(node->rhs);
-      ASM_GEN("  cmp rax, 0");
-      ASM_GEN("  je .L.false.", c);
-      ASM_GEN("  mov rax, 1");
-      ASM_GEN("  jmp .L.end.", c);
-      ASM_GEN(".L.false.", c, ":");
-      ASM_GEN("  mov rax, 0");
-      ASM_GEN(".L.end.", c, ":");
+      CondGen(node->lhs, false, Label(LB_FALSE, c));
+      CondGen(node->rhs, false, Label(LB_FALSE, c));
+      Emit(I_MOV, rax, Imm(1));
+      Emit(I_JMP, Label(LB_END, c));
+      Emit(AS_LABEL, Label(LB_FALSE, c));
+      Emit(I_MOV, rax, Imm(0));
+      Emit(AS_LABEL, Label(LB_END, c));
       return;
     }
     case ND_CALL: {
       int nargs = 0;
-      for (NodePtr& arg = node->args; arg != nullptr; arg = arg->next) {
+      for (NodePtr& arg = node->ext->args; arg != nullptr; arg = arg->next) {
         ExprGen(arg);
         Push();
         nargs++;
       }
       for (int i = nargs - 1; i >= 0; i--) {
-        Pop(argreg64[i]);
+        Pop(argreg[i]);
       }
 
-      ASM_GEN("  mov rax, 0");
-      ASM_GEN("  call ", node->call);
+      Emit(I_MOV, rax, Imm(0));
+      Emit(I_CALL, Label(LB_SYMBOL, node->name->GetIdent()));
       return;
     }
     default:
       break;
   }
 
-  ExprGen(node->rhs);
-  Push();
-  ExprGen(node->lhs);
-  Pop("rdi");
-
-  const char *ax, *di;
-  if (node->lhs->ty->Is<TY_LONG>() || node->lhs->IsPointerNode()) {
-    ax = "rax";
-    di = "rdi";
-  } else {
-    ax = "eax";
-    di = "edi";
+  int sz = (node->lhs->ty->Is<TY_LONG>() || node->lhs->IsPointerNode()) ? 8 : 4;
+  AsmOperand ax = Reg(REG_AX, sz);
+  bool commute = node->kind == ND_ADD || node->kind == ND_MUL || node->kind == ND_BITAND ||
+                 node->kind == ND_BITOR || node->kind == ND_BITXOR || node->kind == ND_EQ ||
+                 node->kind == ND_NE;
+  AsmOperand rhs = BinaryOperands(node, sz, commute);
+
+  if (rhs.kind == AsmOperand::OPD_IMM) {
+    switch (node->kind) {
+      case ND_MUL:
+        if (StrengthReduce::Mul(insts, REG_AX, rhs.imm, sz)) {
+          return;
+        }
+        break;
+      case ND_DIV:
+      case ND_MOD:
+        if (StrengthReduce::DivMod(insts, rhs.imm, sz, node->kind == ND_MOD)) {
+          return;
+        }
+        break;
+      case ND_SHL:
+      case ND_SHR:
+        // the count is taken modulo the operand width, as it is from cl.
+        Emit(node->kind == ND_SHL ? I_SHL : I_SAR, ax, Imm(rhs.imm & (sz * 8 - 1)));
+        return;
+      default:
+        break;
+    }
+    // idiv has no immediate form, the others only a 32 bit one.
+    if (!FitsInt32(rhs.imm) || node->kind == ND_DIV || node->kind == ND_MOD) {
+      Emit(I_MOV, rdi, rhs);
+      rhs = Reg(REG_DI, sz);
+    }
   }
 
   switch (node->kind) {
     case ND_ADD:
-      ASM_GEN("  add ", ax, ", ", di);
+      Emit(I_ADD, ax, rhs);
       return;
     case ND_SUB:
-      ASM_GEN("  sub  ", ax, ", ", di);
+      Emit(I_SUB, ax, rhs);
       return;
     case ND_MUL:
-      ASM_GEN("  imul  ", ax, ", ", di);
+      Emit(I_IMUL, ax, rhs);
       return;
     case ND_DIV:
     case ND_MOD:
       if (node->lhs->ty->Size() == 8) {
-        ASM_GEN("  cqo");
+        Emit(I_CQO);
       } else {
-        ASM_GEN("  cdq");
+        Emit(I_CDQ);
       }
-      ASM_GEN("  idiv ", di);
+      Emit(I_IDIV, rhs);
       if (node->kind == ND_MOD) {
-        ASM_GEN("  mov rax, rdx")
+        Emit(I_MOV, rax, Reg(REG_DX));
       }
       return;
     case ND_BITAND:
-      ASM_GEN("  and rax, rdi");
+      Emit(I_AND, ax, rhs);
       return;
     case ND_BITOR:
-      ASM_GEN("  or rax, rdi");
+      Emit(I_OR, ax, rhs);
       return;
     case ND_BITXOR:
-      ASM_GEN("  xor rax, rdi");
+      Emit(I_XOR, ax, rhs);
       return;
     case ND_EQ:
-      ASM_GEN("  cmp ", ax, ", ", di);
-      ASM_GEN("  sete al");
-      ASM_GEN("  movzb rax, al");
+      Emit(I_CMP, ax, rhs);
+      Emit(I_SETE, al);
+      Emit(I_MOVZX, rax, al);
       return;
     case ND_NE:
-      ASM_GEN("  cmp ", ax, ", ", di);
-      ASM_GEN("  setne al");
-      ASM_GEN("  movzb rax, al");
+      Emit(I_CMP, ax, rhs);
+      Emit(I_SETNE, al);
+      Emit(I_MOVZX, rax, al);
       return;
     case ND_LT:
-      ASM_GEN("  cmp ", ax, ", ", di);
-      ASM_GEN("  setl al");
-      ASM_GEN("  movzb rax, al");
+      Emit(I_CMP, ax, rhs);
+      Emit(I_SETL, al);
+      Emit(I_MOVZX, rax, al);
       return;
     case ND_LE:
-      ASM_GEN("  cmp ", ax, ", ", di);
-      ASM_GEN("  setle al");
-      ASM_GEN("  movzb rax, al");
+      Emit(I_CMP, ax, rhs);
+      Emit(I_SETLE, al);
+      Emit(I_MOVZX, rax, al);
       return;
     case ND_SHL:
-      ASM_GEN("  mov rcx, rdi")
-      ASM_GEN("  shl ", ax, ", cl");
+      Emit(I_MOV, Reg(REG_CX, sz), rhs);
+      Emit(I_SHL, ax, Reg(REG_CX, 1));
       return;
     case ND_SHR:
-      ASM_GEN("  mov rcx, rdi")
-      if (node->ty->Size() == 8) {
-        ASM_GEN("  sar ", ax, ", cl");
-      } else {
-        ASM_GEN("  sar ", ax, ", cl");
-      }
+      Emit(I_MOV, Reg(REG_CX, sz), rhs);
+      Emit(I_SAR, ax, Reg(REG_CX, 1));
       return;
     default:
       node->name->ErrorTok("invalid expression.");
@@ -12,14 +12,20 @@
 #ifndef CODEGEN_GRUAD
 #define CODEGEN_GRUAD
 
-#include <fstream>
-#include <iostream>
-#include <memory>
-#include <ostream>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+#include <vector>
 
+#include "asm_inst.h"
 #include "node.h"
+#include "switch.h"
 
 // Code generator pinter.
+//
+// The assembly is appended to one growing byte buffer, integers are
+// formatted by hand, and the whole buffer is written out by Flush() once
+// code generation is done.
 class CodeGenPrinter {
  public:
   static CodeGenPrinter& GetInstance(const Config& cfg = Config()) {
@@ -27,41 +33,65 @@ class CodeGenPrinter {
     return printor;
   }
 
-  template <typename T>
-  static void Print(T t) {
-    if (CodeGenPrinter::GetInstance().use_std) {
-      std::cout << t;
-    } else {
-      *CodeGenPrinter::GetInstance().out << t;
+  static void Print(const char* s) { Append(s, strlen(s)); }
+  static void Print(const String& s) { Append(s.data(), s.size()); }
+  static void Print(char c) { Append(&c, 1); }
+  template <typename T, typename = std::enable_if_t<std::is_integral<T>::value>>
+  static void Print(T v) {
+    // enough for the digits of a 64 bit integer and the sign.
+    char digits[24];
+    char* end = digits + sizeof(digits);
+    char* p = end;
+    uint64_t u = v < 0 ? 0 - static_cast<uint64_t>(v) : static_cast<uint64_t>(v);
+    do {
+      *--p = static_cast<char>('0' + u % 10);
+      u /= 10;
+    } while (u != 0);
+    if (v < 0) {
+      *--p = '-';
     }
+    Append(p, end - p);
   }
+  static void Print(const AsmLabel& label);
+  static void Print(const AsmOperand& opd);
+  // print an instruction or directive as a line of Intel syntax assembly.
+  static void Print(const AsmInst& inst);
+  // write the buffered assembly to the output file.
+  void Flush();
 
  private:
-  explicit CodeGenPrinter(const Config& cfg) {
-    const String& input = cfg.input_path;
-    const String& output = cfg.output_path;
-    if (output.empty() || output == "-") {
-      std::cout << ".file 1 \"" << input << "\"\n";
-      use_std = true;
-    }
-    out = std::unique_ptr<std::ofstream>(new std::ofstream(output));
-    if (!out->is_open()) {
-      Error("cannot open output file: %s.", output.c_str());
+  explicit CodeGenPrinter(const Config& cfg);
+  ~CodeGenPrinter();
+
+  static void Append(const char* s, size_t len) {
+    if (static_cast<size_t>(buf_end - buf_cur) < len) {
+      Grow(len);
     }
-    *out << ".file 1 \"" << input << "\"\n";
+    memcpy(buf_cur, s, len);
+    buf_cur += len;
   }
+  // make room for at least len more bytes.
+  static void Grow(size_t len);
 
   CodeGenPrinter(const CodeGenPrinter&) = delete;
   CodeGenPrinter operator=(const CodeGenPrinter&) = delete;
-  std::unique_ptr<std::ofstream> out;
-  bool use_std = false;
+
+  static char* buf_begin;
+  static char* buf_cur;
+  static char* buf_end;
+  // output file descriptor.
+  int fd = -1;
 };
 
 // code generator.
+//
+// The functions are lowered into a structured instruction list, which is
+// then either printed as assembly text or, with -c, encoded into an ELF
+// relocatable object.
 class CodeGenerator {
  public:
   // using specific output stream.
-  explicit CodeGenerator(const Config& cfg) { CodeGenPrinter::GetInstance(cfg); }
+  explicit CodeGenerator(const Config& cfg) : cfg(cfg) {}
   // don't allow copy constructor.
   CodeGenerator(const CodeGenerator&) = delete;
   // don't allow assign constructor.
@@ -76,25 +106,49 @@ class CodeGenerator {
   void EmitText(const ASTree& ast);
   // get var node's address.
   void GetVarAddr(NodePtr& node);
+  // the memory operand of a variable, or of a member of a local one.
+  bool VarMem(NodePtr& node, AsmOperand* mem);
+  // an operand a sz byte instruction can read node from without evaluating
+  // it: a constant, or a scalar variable of sz bytes. OPD_NONE otherwise.
+  AsmOperand DirectOperand(NodePtr& node, int sz);
+  // evaluate the left side of a binary node into rax and return the right
+  // one, as a direct operand or in rdi. With commute set the sides swap if
+  // only the left one is direct.
+  AsmOperand BinaryOperands(NodePtr& node, int sz, bool commute);
   // push rax data to stask.
   void Push(void);
   // pop a stask element to specific register.
-  void Pop(const char* arg);
+  void Pop(AsmReg reg);
   // emit exprssion assemly code.
   void ExprGen(NodePtr& node);
+  // emit a jump to target taken when the truth value of node equals jump_if.
+  void CondGen(NodePtr& node, bool jump_if, const AsmOperand& target);
+  // jump to the case matching rax, through a jump table when the case values
+  // are dense enough and a binary search over them otherwise.
+  void SwitchGen(NodePtr& node);
+  // search the sorted cases [lo, hi), small ranges are compared one by one.
+  void SwitchSearch(const std::vector<SwitchCase>& cases, size_t lo, size_t hi, int sz,
+                    const AsmOperand& miss);
   // emit statement assemly code.
   void StmtGen(NodePtr& node);
   // load a data from memory address based on type size as ty.
-  void Load(TypePtr& ty);
+  void Load(TypePtr& ty, AsmOperand addr = Mem(REG_AX));
   // store a data to memory address based on the type size as ty.
   void Store(TypePtr& ty);
   // store passed-by-register arguments to the stack.
   void StoreFunctionParameter(int reg, int offset, int sz);
   // cast type
   void Cast(TypePtr from, TypePtr to);
+  // append an instruction.
+  void Emit(AsmOp op, const AsmOperand& dst = AsmOperand(), const AsmOperand& src = AsmOperand()) {
+    insts.push_back({op, dst, src});
+  }
 
  private:
+  Config cfg;
   ObjectPtr cur_func = nullptr;
+  // instructions of the whole translation unit.
+  AsmBuffer insts{};
 };
 
 #endif  // !CODEGEN_GRUAD
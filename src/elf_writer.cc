@@ -0,0 +1,635 @@
+/*
+ * This project is exclusively owned by QingChuanWS and shall not be used for
+ * commercial and profitting purpose without QingChuanWS's permission.
+ *
+ * @ Author: bingshan45@163.com
+ * @ Github: https://github.com/QingChuanWS
+ * @ Description:
+ *
+ * Copyright (c) 2023 by QingChuanWS, All Rights Reserved.
+ */
+
+#include "elf_writer.h"
+
+#include <elf.h>
+#include <unistd.h>
+
+#include <cstring>
+
+#include "tools.h"
+
+// section header indexes of the object file.
+enum {
+  SHN_TEXT = 1,
+  SHN_DATA,
+  SHN_BSS,
+  SHN_RELA_TEXT,
+  SHN_SYMTAB,
+  SHN_STRTAB,
+  SHN_SHSTRTAB,
+  SHN_NOTE_STACK,
+  SHN_COUNT,
+};
+
+static bool FitsInt8(int64_t v) { return v >= INT8_MIN && v <= INT8_MAX; }
+
+void ElfWriter::Emit32(uint32_t v) {
+  for (int i = 0; i < 4; i++) {
+    Emit8(v >> (i * 8));
+  }
+}
+
+void ElfWriter::Emit64(uint64_t v) {
+  for (int i = 0; i < 8; i++) {
+    Emit8(v >> (i * 8));
+  }
+}
+
+uint64_t ElfWriter::LabelKey(const AsmLabel& label) {
+  return static_cast<uint64_t>(label.kind) << 32 | static_cast<uint32_t>(label.id);
+}
+
+void ElfWriter::EncodeRM(uint16_t opcode, int size, int reg, const AsmOperand& rm, bool byte_reg) {
+  bool is_mem = rm.kind == AsmOperand::OPD_MEM;
+  int base = rm.reg;
+
+  if (size == 2) {
+    Emit8(0x66);
+  }
+  uint8_t rex = 0x40;
+  if (size == 8) {
+    rex |= 8;
+  }
+  if (reg & 8) {
+    rex |= 4;
+  }
+  if (is_mem && rm.scale != 0 && (rm.index & 8)) {
+    rex |= 2;
+  }
+  if (base != REG_IP && (base & 8)) {
+    rex |= 1;
+  }
+  // spl, bpl, sil and dil are only addressable with a REX prefix.
+  bool low_byte = (byte_reg && reg >= REG_SP && reg <= REG_DI) ||
+                  (!is_mem && rm.size == 1 && base >= REG_SP && base <= REG_DI);
+  if (rex != 0x40 || low_byte) {
+    Emit8(rex);
+  }
+  if (opcode > 0xff) {
+    Emit8(opcode >> 8);
+  }
+  Emit8(opcode);
+
+  reg &= 7;
+  if (!is_mem) {
+    Emit8(0xc0 | reg << 3 | (base & 7));
+    return;
+  }
+  if (base == REG_IP) {
+    Emit8(reg << 3 | 5);
+    // the addend or base is fixed once the instruction length is known.
+    if (rm.label.kind == LB_SYMBOL) {
+      relocs.push_back({text.size(), R_X86_64_PC32, rm.label.name, 0});
+    } else {
+      fixups.push_back({text.size(), rm.label, 0});
+    }
+    Emit32(0);
+    return;
+  }
+
+  int64_t disp = rm.imm;
+  int mod = 2;
+  if (disp == 0 && (base & 7) != REG_BP) {
+    mod = 0;
+  } else if (FitsInt8(disp)) {
+    mod = 1;
+  }
+  if (rm.scale != 0) {
+    static const uint8_t scale_bits[] = {0, 0, 1, 0, 2, 0, 0, 0, 3};
+    Emit8(mod << 6 | reg << 3 | 4);
+    Emit8(scale_bits[rm.scale] << 6 | (rm.index & 7) << 3 | (base & 7));
+  } else {
+    Emit8(mod << 6 | reg << 3 | (base & 7));
+    if ((base & 7) == REG_SP) {
+      Emit8(0x24);
+    }
+  }
+  if (mod == 1) {
+    Emit8(disp);
+  } else if (mod == 2) {
+    Emit32(disp);
+  }
+}
+
+void ElfWriter::EncodeTarget(const AsmOperand& target, bool is_call) {
+  if (is_call) {
+    relocs.push_back({text.size(), R_X86_64_PLT32, target.label.name, -4});
+  } else {
+    fixups.push_back({text.size(), target.label, 0});
+  }
+  Emit32(0);
+}
+
+void ElfWriter::Encode(const AsmInst& inst) {
+  const AsmOperand& dst = inst.dst;
+  const AsmOperand& src = inst.src;
+  size_t reloc_cnt = relocs.size();
+  size_t fixup_cnt = fixups.size();
+
+  // ModRM extension and reg, r/m opcode of the arithmetic instructions.
+  int alu_ext = 0;
+  uint8_t alu_op = 0;
+  // ModRM extension of the shifts.
+  int shift_ext = 0;
+
+  switch (inst.op) {
+    case I_PUSH:
+    case I_POP:
+      if (dst.reg & 8) {
+        Emit8(0x41);
+      }
+      Emit8((inst.op == I_PUSH ? 0x50 : 0x58) + (dst.reg & 7));
+      break;
+    case I_MOV:
+      if (dst.kind == AsmOperand::OPD_REG && src.kind == AsmOperand::OPD_IMM) {
+        if (dst.size == 8 && FitsInt32(src.imm)) {
+          EncodeRM(0xc7, 8, 0, dst);
+          Emit32(src.imm);
+        } else {
+          uint8_t rex = (dst.size == 8 ? 0x48 : 0x40) | (dst.reg & 8 ? 1 : 0);
+          if (rex != 0x40) {
+            Emit8(rex);
+          }
+          Emit8(0xb8 + (dst.reg & 7));
+          if (dst.size == 8) {
+            Emit64(src.imm);
+          } else {
+            Emit32(src.imm);
+          }
+        }
+      } else if (src.kind == AsmOperand::OPD_MEM) {
+        EncodeRM(dst.size == 1 ? 0x8a : 0x8b, dst.size, dst.reg, src, dst.size == 1);
+      } else {
+        EncodeRM(src.size == 1 ? 0x88 : 0x89, src.size, src.reg, dst, src.size == 1);
+      }
+      break;
+    case I_LEA:
+      EncodeRM(0x8d, dst.size, dst.reg, src);
+      break;
+    case I_ADD:
+      alu_ext = 0, alu_op = 0x01;
+      goto alu;
+    case I_OR:
+      alu_ext = 1, alu_op = 0x09;
+      goto alu;
+    case I_AND:
+      alu_ext = 4, alu_op = 0x21;
+      goto alu;
+    case I_SUB:
+      alu_ext = 5, alu_op = 0x29;
+      goto alu;
+    case I_XOR:
+      alu_ext = 6, alu_op = 0x31;
+      goto alu;
+    case I_CMP:
+      alu_ext = 7, alu_op = 0x39;
+    alu:
+      if (src.kind == AsmOperand::OPD_IMM) {
+        // a 32 bit operation only sees the low 32 bits of the immediate.
+        int64_t imm = dst.size == 8 ? src.imm : static_cast<int32_t>(src.imm);
+        if (!FitsInt32(imm)) {
+          Error("immediate out of range: %ld.", static_cast<long>(imm));
+        }
+        EncodeRM(FitsInt8(imm) ? 0x83 : 0x81, dst.size, alu_ext, dst);
+        if (FitsInt8(imm)) {
+          Emit8(imm);
+        } else {
+          Emit32(imm);
+        }
+      } else if (src.kind == AsmOperand::OPD_MEM) {
+        EncodeRM(alu_op + 2, dst.size, dst.reg, src);
+      } else {
+        EncodeRM(alu_op, dst.size, src.reg, dst);
+      }
+      break;
+    case I_IMUL:
+      // the one operand form multiplies rax into rdx:rax.
+      if (src.kind == AsmOperand::OPD_NONE) {
+        EncodeRM(0xf7, dst.size, 5, dst);
+      } else if (src.kind == AsmOperand::OPD_IMM) {
+        // imul r, imm is imul r, r, imm.
+        EncodeRM(FitsInt8(src.imm) ? 0x6b : 0x69, dst.size, dst.reg, dst);
+        if (FitsInt8(src.imm)) {
+          Emit8(src.imm);
+        } else {
+          Emit32(src.imm);
+        }
+      } else {
+        EncodeRM(0x0faf, dst.size, dst.reg, src);
+      }
+      break;
+    case I_IDIV:
+      EncodeRM(0xf7, dst.size, 7, dst);
+      break;
+    case I_NEG:
+      EncodeRM(0xf7, dst.size, 3, dst);
+      break;
+    case I_NOT:
+      EncodeRM(0xf7, dst.size, 2, dst);
+      break;
+    case I_CQO:
+      Emit8(0x48);
+      Emit8(0x99);
+      break;
+    case I_CDQ:
+      Emit8(0x99);
+      break;
+    case I_REP_MOVSB:
+      Emit8(0xf3);
+      Emit8(0xa4);
+      break;
+    case I_SETE:
+      EncodeRM(0x0f94, 1, 0, dst);
+      break;
+    case I_SETNE:
+      EncodeRM(0x0f95, 1, 0, dst);
+      break;
+    case I_SETL:
+      EncodeRM(0x0f9c, 1, 0, dst);
+      break;
+    case I_SETLE:
+      EncodeRM(0x0f9e, 1, 0, dst);
+      break;
+    case I_MOVZX:
+      EncodeRM(src.size == 1 ? 0x0fb6 : 0x0fb7, dst.size, dst.reg, src);
+      break;
+    case I_MOVSX:
+      EncodeRM(src.size == 1 ? 0x0fbe : 0x0fbf, dst.size, dst.reg, src);
+      break;
+    case I_MOVSXD:
+      EncodeRM(0x63, 8, dst.reg, src);
+      break;
+    case I_SHL:
+      shift_ext = 4;
+      goto shift;
+    case I_SAR:
+      shift_ext = 7;
+      goto shift;
+    case I_SHR:
+      shift_ext = 5;
+    shift:
+      if (src.kind == AsmOperand::OPD_IMM) {
+        EncodeRM(0xc1, dst.size, shift_ext, dst);
+        Emit8(src.imm);
+      } else {
+        EncodeRM(0xd3, dst.size, shift_ext, dst);
+      }
+      break;
+    case I_JMP:
+      if (dst.kind == AsmOperand::OPD_REG) {
+        EncodeRM(0xff, 4, 4, dst);
+        break;
+      }
+      Emit8(0xe9);
+      EncodeTarget(dst, false);
+      break;
+    case I_JE:
+      Emit8(0x0f);
+      Emit8(0x84);
+      EncodeTarget(dst, false);
+      break;
+    case I_JNE:
+      Emit8(0x0f);
+      Emit8(0x85);
+      EncodeTarget(dst, false);
+      break;
+    case I_JL:
+      Emit8(0x0f);
+      Emit8(0x8c);
+      EncodeTarget(dst, false);
+      break;
+    case I_JLE:
+      Emit8(0x0f);
+      Emit8(0x8e);
+      EncodeTarget(dst, false);
+      break;
+    case I_JG:
+      Emit8(0x0f);
+      Emit8(0x8f);
+      EncodeTarget(dst, false);
+      break;
+    case I_JGE:
+      Emit8(0x0f);
+      Emit8(0x8d);
+      EncodeTarget(dst, false);
+      break;
+    case I_JA:
+      Emit8(0x0f);
+      Emit8(0x87);
+      EncodeTarget(dst, false);
+      break;
+    case I_CALL:
+      Emit8(0xe8);
+      EncodeTarget(dst, true);
+      break;
+    case I_RET:
+      Emit8(0xc3);
+      break;
+    default:
+      unreachable();
+  }
+
+  // a rip relative field is relative to the end of the instruction.
+  for (size_t i = reloc_cnt; i < relocs.size(); i++) {
+    if (relocs[i].type == R_X86_64_PC32) {
+      relocs[i].addend = static_cast<int64_t>(relocs[i].pos) - static_cast<int64_t>(text.size());
+    }
+  }
+  for (size_t i = fixup_cnt; i < fixups.size(); i++) {
+    fixups[i].base = text.size();
+  }
+}
+
+int ElfWriter::GetSymbol(const String& name) {
+  auto it = sym_index.find(name);
+  if (it != sym_index.end()) {
+    return it->second;
+  }
+  ElfSymbol sym;
+  sym.name = name;
+  syms.push_back(sym);
+  sym_index[name] = syms.size() - 1;
+  return syms.size() - 1;
+}
+
+void ElfWriter::DefineSymbol(const String& name, Section sec) {
+  int idx = GetSymbol(name);
+  syms[idx].sec = sec;
+  if (sec == SEC_TEXT) {
+    syms[idx].value = text.size();
+    syms[idx].is_func = true;
+    cur_func = idx;
+  } else {
+    cur_object = idx;
+  }
+}
+
+void ElfWriter::FlushObject() {
+  if (cur_object < 0) {
+    return;
+  }
+  ElfSymbol& sym = syms[cur_object];
+  sym.size = object_bytes.size();
+  // an object without initial data lives in .bss.
+  if (object_has_data) {
+    sym.value = data.size();
+    data.insert(data.end(), object_bytes.begin(), object_bytes.end());
+  } else {
+    sym.sec = SEC_BSS;
+    sym.value = bss_size;
+    bss_size += object_bytes.size();
+  }
+  object_bytes.clear();
+  object_has_data = false;
+  cur_object = -1;
+}
+
+void ElfWriter::FinishFunction() {
+  if (cur_func >= 0) {
+    syms[cur_func].size = text.size() - syms[cur_func].value;
+    cur_func = -1;
+  }
+}
+
+// string table builder.
+static uint32_t AddString(std::vector<char>& tab, const String& s) {
+  uint32_t off = tab.size();
+  tab.insert(tab.end(), s.begin(), s.end());
+  tab.push_back('\0');
+  return off;
+}
+
+template <typename T>
+static void AppendBytes(std::vector<uint8_t>& out, const T* p, size_t len) {
+  const uint8_t* b = reinterpret_cast<const uint8_t*>(p);
+  out.insert(out.end(), b, b + len);
+}
+
+static void AlignBytes(std::vector<uint8_t>& out, size_t align) {
+  out.resize((out.size() + align - 1) / align * align, 0);
+}
+
+void ElfWriter::Write(const AsmBuffer& insts) {
+  Section cur = SEC_TEXT;
+  for (const AsmInst& inst : insts) {
+    switch (inst.op) {
+      case AS_INTEL:
+      case AS_LOC:
+        break;
+      case AS_DATA:
+        FlushObject();
+        FinishFunction();
+        cur = SEC_DATA;
+        break;
+      case AS_TEXT:
+        FlushObject();
+        cur = SEC_TEXT;
+        break;
+      case AS_GLOBAL:
+        global_names[*inst.dst.label.name] = true;
+        break;
+      case AS_LOCAL:
+        break;
+      case AS_OFFSET: {
+        // the base label comes before the offset, so its position is known.
+        auto it = label_pos.find(LabelKey(inst.src.label));
+        if (it == label_pos.end()) {
+          unreachable();
+        }
+        fixups.push_back({text.size(), inst.dst.label, it->second});
+        Emit32(0);
+        break;
+      }
+      case AS_BYTE:
+        object_bytes.push_back(inst.dst.imm);
+        object_has_data = true;
+        break;
+      case AS_ZERO:
+        object_bytes.resize(object_bytes.size() + inst.dst.imm, 0);
+        break;
+      case AS_LABEL:
+        if (inst.dst.label.kind == LB_SYMBOL) {
+          FlushObject();
+          FinishFunction();
+          DefineSymbol(*inst.dst.label.name, cur);
+        } else if (inst.dst.label.name != nullptr) {
+          named_label_pos[*inst.dst.label.name] = text.size();
+        } else {
+          label_pos[LabelKey(inst.dst.label)] = text.size();
+        }
+        break;
+      default:
+        Encode(inst);
+        break;
+    }
+  }
+  FlushObject();
+  FinishFunction();
+
+  // resolve the jumps to local labels.
+  for (const Fixup& f : fixups) {
+    size_t target = 0;
+    if (f.label.name != nullptr) {
+      auto it = named_label_pos.find(*f.label.name);
+      if (it == named_label_pos.end()) {
+        unreachable();
+      }
+      target = it->second;
+    } else {
+      auto it = label_pos.find(LabelKey(f.label));
+      if (it == label_pos.end()) {
+        unreachable();
+      }
+      target = it->second;
+    }
+    int32_t rel = static_cast<int64_t>(target) - static_cast<int64_t>(f.base);
+    memcpy(&text[f.pos], &rel, 4);
+  }
+
+  // referenced but not defined symbols are external.
+  for (const Reloc& r : relocs) {
+    int idx = GetSymbol(*r.name);
+    if (syms[idx].sec == SEC_UNDEF) {
+      syms[idx].is_global = true;
+    }
+  }
+  for (ElfSymbol& sym : syms) {
+    // .L names are assembler local even if declared .global.
+    if (global_names.count(sym.name) && sym.name.compare(0, 2, ".L") != 0) {
+      sym.is_global = true;
+    }
+  }
+
+  // symbol table: null, file, locals and then globals.
+  std::vector<char> strtab(1, '\0');
+  std::vector<Elf64_Sym> symtab(2);
+  memset(symtab.data(), 0, sizeof(Elf64_Sym) * 2);
+  symtab[1].st_name = AddString(strtab, cfg.input_path);
+  symtab[1].st_info = ELF64_ST_INFO(STB_LOCAL, STT_FILE);
+  symtab[1].st_shndx = SHN_ABS;
+
+  std::vector<int> final_index(syms.size());
+  uint32_t first_global = 0;
+  for (int pass = 0; pass < 2; pass++) {
+    bool want_global = pass == 1;
+    if (want_global) {
+      first_global = symtab.size();
+    }
+    for (size_t i = 0; i < syms.size(); i++) {
+      const ElfSymbol& sym = syms[i];
+      if (sym.is_global != want_global) {
+        continue;
+      }
+      Elf64_Sym es;
+      memset(&es, 0, sizeof(es));
+      es.st_name = AddString(strtab, sym.name);
+      int type = sym.sec == SEC_UNDEF ? STT_NOTYPE : (sym.is_func ? STT_FUNC : STT_OBJECT);
+      es.st_info = ELF64_ST_INFO(sym.is_global ? STB_GLOBAL : STB_LOCAL, type);
+      es.st_shndx = sym.sec == SEC_TEXT   ? SHN_TEXT
+                    : sym.sec == SEC_DATA ? SHN_DATA
+                    : sym.sec == SEC_BSS  ? SHN_BSS
+                                          : SHN_UNDEF;
+      es.st_value = sym.value;
+      es.st_size = sym.size;
+      final_index[i] = symtab.size();
+      symtab.push_back(es);
+    }
+  }
+
+  std::vector<Elf64_Rela> rela;
+  for (const Reloc& r : relocs) {
+    Elf64_Rela er;
+    er.r_offset = r.pos;
+    er.r_info = ELF64_R_INFO(final_index[sym_index[*r.name]], r.type);
+    er.r_addend = r.addend;
+    rela.push_back(er);
+  }
+
+  // section names.
+  std::vector<char> shstrtab(1, '\0');
+  uint32_t name_off[SHN_COUNT] = {0};
+  const char* names[SHN_COUNT] = {"",        ".text",   ".data",     ".bss",           ".rela.text",
+                                  ".symtab", ".strtab", ".shstrtab", ".note.GNU-stack"};
+  for (int i = 1; i < SHN_COUNT; i++) {
+    name_off[i] = AddString(shstrtab, names[i]);
+  }
+
+  // file layout: header, section contents and the section header table.
+  std::vector<uint8_t> out(sizeof(Elf64_Ehdr), 0);
+  Elf64_Shdr sh[SHN_COUNT];
+  memset(sh, 0, sizeof(sh));
+  auto place = [&](int idx, const void* p, size_t len, size_t align) {
+    AlignBytes(out, align);
+    sh[idx].sh_offset = out.size();
+    sh[idx].sh_size = len;
+    sh[idx].sh_addralign = align;
+    AppendBytes(out, static_cast<const uint8_t*>(p), len);
+  };
+  place(SHN_TEXT, text.data(), text.size(), 16);
+  place(SHN_DATA, data.data(), data.size(), 8);
+  place(SHN_RELA_TEXT, rela.data(), rela.size() * sizeof(Elf64_Rela), 8);
+  place(SHN_SYMTAB, symtab.data(), symtab.size() * sizeof(Elf64_Sym), 8);
+  place(SHN_STRTAB, strtab.data(), strtab.size(), 1);
+  place(SHN_SHSTRTAB, shstrtab.data(), shstrtab.size(), 1);
+  place(SHN_NOTE_STACK, nullptr, 0, 1);
+
+  sh[SHN_TEXT].sh_type = SHT_PROGBITS;
+  sh[SHN_TEXT].sh_flags = SHF_ALLOC | SHF_EXECINSTR;
+  sh[SHN_DATA].sh_type = SHT_PROGBITS;
+  sh[SHN_DATA].sh_flags = SHF_ALLOC | SHF_WRITE;
+  sh[SHN_BSS].sh_type = SHT_NOBITS;
+  sh[SHN_BSS].sh_flags = SHF_ALLOC | SHF_WRITE;
+  sh[SHN_BSS].sh_offset = sh[SHN_DATA].sh_offset + sh[SHN_DATA].sh_size;
+  sh[SHN_BSS].sh_size = bss_size;
+  sh[SHN_BSS].sh_addralign = 8;
+  sh[SHN_RELA_TEXT].sh_type = SHT_RELA;
+  sh[SHN_RELA_TEXT].sh_flags = SHF_INFO_LINK;
+  sh[SHN_RELA_TEXT].sh_link = SHN_SYMTAB;
+  sh[SHN_RELA_TEXT].sh_info = SHN_TEXT;
+  sh[SHN_RELA_TEXT].sh_entsize = sizeof(Elf64_Rela);
+  sh[SHN_SYMTAB].sh_type = SHT_SYMTAB;
+  sh[SHN_SYMTAB].sh_link = SHN_STRTAB;
+  sh[SHN_SYMTAB].sh_info = first_global;
+  sh[SHN_SYMTAB].sh_entsize = sizeof(Elf64_Sym);
+  sh[SHN_STRTAB].sh_type = SHT_STRTAB;
+  sh[SHN_SHSTRTAB].sh_type = SHT_STRTAB;
+  sh[SHN_NOTE_STACK].sh_type = SHT_PROGBITS;
+  for (int i = 1; i < SHN_COUNT; i++) {
+    sh[i].sh_name = name_off[i];
+  }
+
+  AlignBytes(out, 8);
+  Elf64_Ehdr eh;
+  memset(&eh, 0, sizeof(eh));
+  memcpy(eh.e_ident, ELFMAG, SELFMAG);
+  eh.e_ident[EI_CLASS] = ELFCLASS64;
+  eh.e_ident[EI_DATA] = ELFDATA2LSB;
+  eh.e_ident[EI_VERSION] = EV_CURRENT;
+  eh.e_ident[EI_OSABI] = ELFOSABI_SYSV;
+  eh.e_type = ET_REL;
+  eh.e_machine = EM_X86_64;
+  eh.e_version = EV_CURRENT;
+  eh.e_shoff = out.size();
+  eh.e_ehsize = sizeof(Elf64_Ehdr);
+  eh.e_shentsize = sizeof(Elf64_Shdr);
+  eh.e_shnum = SHN_COUNT;
+  eh.e_shstrndx = SHN_SHSTRTAB;
+  memcpy(out.data(), &eh, sizeof(eh));
+  AppendBytes(out, sh, sizeof(sh));
+
+  int fd = OpenOutput(cfg.output_path);
+  WriteAll(fd, reinterpret_cast<const char*>(out.data()), out.size());
+  if (fd != STDOUT_FILENO) {
+    close(fd);
+  }
+}
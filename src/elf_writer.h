@@ -0,0 +1,103 @@
+/*
+ * This project is exclusively owned by QingChuanWS and shall not be used for
+ * commercial and profitting purpose without QingChuanWS's permission.
+ *
+ * @ Author: bingshan45@163.com
+ * @ Github: https://github.com/QingChuanWS
+ * @ Description:
+ *
+ * Copyright (c) 2023 by QingChuanWS, All Rights Reserved.
+ */
+
+#ifndef ELF_WRITER_GRUAD
+#define ELF_WRITER_GRUAD
+
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+#include "asm_inst.h"
+#include "utils.h"
+
+// x86-64 encoder and ELF64 relocatable object writer.
+//
+// It consumes the same instruction list as the assembly printer, so no
+// assembly text is produced or parsed. Calls to functions are relocated
+// with R_X86_64_PLT32 and rip relative addresses with R_X86_64_PC32. Jumps,
+// addresses and jump table entries referring to local labels are resolved in
+// place.
+class ElfWriter {
+ public:
+  explicit ElfWriter(const Config& cfg) : cfg(cfg) {}
+  // encode the instruction list and write the object file.
+  void Write(const AsmBuffer& insts);
+
+ private:
+  enum Section { SEC_UNDEF, SEC_TEXT, SEC_DATA, SEC_BSS };
+
+  struct ElfSymbol {
+    String name;
+    Section sec = SEC_UNDEF;
+    uint64_t value = 0;
+    uint64_t size = 0;
+    bool is_func = false;
+    bool is_global = false;
+  };
+  // a rel32 field of .text referring to a local label, relative to base.
+  struct Fixup {
+    size_t pos;
+    AsmLabel label;
+    size_t base;
+  };
+  // a rel32 field of .text referring to a symbol.
+  struct Reloc {
+    size_t pos;
+    uint32_t type;
+    const String* name;
+    int64_t addend;
+  };
+
+  // encode one instruction into .text.
+  void Encode(const AsmInst& inst);
+  // encode [66] [REX] opcode ModRM [SIB] [disp] with reg in the ModRM reg field.
+  void EncodeRM(uint16_t opcode, int size, int reg, const AsmOperand& rm, bool byte_reg = false);
+  // encode a rel32 jump or call target.
+  void EncodeTarget(const AsmOperand& target, bool is_call);
+  void Emit8(uint8_t v) { text.push_back(v); }
+  void Emit32(uint32_t v);
+  void Emit64(uint64_t v);
+  // label position key.
+  static uint64_t LabelKey(const AsmLabel& label);
+  // start a symbol definition at the current position of sec.
+  void DefineSymbol(const String& name, Section sec);
+  // move the pending data object into .data or .bss.
+  void FlushObject();
+  // close the size of the current function.
+  void FinishFunction();
+  // get or create the symbol index of name.
+  int GetSymbol(const String& name);
+
+  Config cfg;
+  std::vector<uint8_t> text{};
+  std::vector<uint8_t> data{};
+  uint64_t bss_size = 0;
+
+  std::vector<ElfSymbol> syms{};
+  std::unordered_map<String, int> sym_index{};
+  // names declared by .global.
+  std::unordered_map<String, bool> global_names{};
+  // positions of the id labels and the named local labels.
+  std::unordered_map<uint64_t, size_t> label_pos{};
+  std::unordered_map<String, size_t> named_label_pos{};
+  std::vector<Fixup> fixups{};
+  std::vector<Reloc> relocs{};
+
+  // data object being defined.
+  int cur_object = -1;
+  std::vector<uint8_t> object_bytes{};
+  bool object_has_data = false;
+  // function being defined.
+  int cur_func = -1;
+};
+
+#endif  // !ELF_WRITER_GRUAD
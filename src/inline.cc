@@ -0,0 +1,297 @@
+/*
+ * This project is exclusively owned by QingChuanWS and shall not be used for
+ * commercial and profitting purpose without QingChuanWS's permission.
+ *
+ * @ Author: bingshan45@163.com
+ * @ Github: https://github.com/QingChuanWS
+ * @ Description:
+ *
+ * Copyright (c) 2023 by QingChuanWS, All Rights Reserved.
+ */
+
+#include "inline.h"
+
+#include <algorithm>
+#include <utility>
+
+#include "tools.h"
+#include "type.h"
+
+void Inliner::Run(ASTree& ast) {
+  if (limit <= 0) {
+    return;
+  }
+  for (ObjectPtr fn : ast.globals) {
+    if (fn->Is<OB_FUNCTION>() && fn->func_attr.is_static) {
+      funcs[fn->obj_name] = fn;
+    }
+  }
+  for (ObjectPtr fn : ast.globals) {
+    if (fn->Is<OB_FUNCTION>()) {
+      caller = fn;
+      Walk(fn->body);
+    }
+  }
+
+  // drop the static functions nothing calls or takes the address of any more.
+  std::unordered_set<String> used;
+  for (ObjectPtr fn : ast.globals) {
+    if (fn->Is<OB_FUNCTION>()) {
+      Refs(fn->body, used);
+    }
+  }
+  auto unused = [&](const ObjectPtr& fn) {
+    return fn->Is<OB_FUNCTION>() && fn->func_attr.is_static && !used.count(fn->obj_name);
+  };
+  ast.globals.erase(std::remove_if(ast.globals.begin(), ast.globals.end(), unused),
+                    ast.globals.end());
+}
+
+ObjectPtr Inliner::Callee(const NodePtr& call) const {
+  auto it = funcs.find(call->name->GetIdent());
+  if (it == funcs.end() || it->second == caller) {
+    return nullptr;
+  }
+  ObjectPtr fn = it->second;
+  if (call->ty->Is<TY_STRUCT>() || call->ty->Is<TY_UNION>()) {
+    return nullptr;
+  }
+  size_t nargs = 0;
+  for (NodePtr arg = call->ext->args; arg != nullptr; arg = arg->next) {
+    nargs++;
+  }
+  if (nargs != fn->params.size()) {
+    return nullptr;
+  }
+  std::unordered_map<const Node*, std::pair<int, int>> ranges;
+  int size = 0;
+  Node::NumberTree(fn->body, size, ranges);
+  return size <= limit ? fn : nullptr;
+}
+
+void Inliner::Walk(NodePtr& node) {
+  if (node == nullptr) {
+    return;
+  }
+  Walk(node->lhs);
+  Walk(node->rhs);
+  if (node->ext != nullptr) {
+    for (NodePtr* n = &node->ext->body; *n != nullptr; n = &(*n)->next) {
+      Walk(*n);
+    }
+    for (NodePtr* n = &node->ext->args; *n != nullptr; n = &(*n)->next) {
+      Walk(*n);
+    }
+    Walk(node->ext->cond);
+    Walk(node->ext->then);
+    Walk(node->ext->els);
+    Walk(node->ext->init);
+    Walk(node->ext->inc);
+  }
+  if (node->kind != ND_CALL) {
+    return;
+  }
+  ObjectPtr callee = Callee(node);
+  if (callee != nullptr) {
+    node = Expand(node, callee);
+  }
+}
+
+NodePtr Inliner::Expand(const NodePtr& call, const ObjectPtr& callee) {
+  TokenPtr tok = call->name;
+  size_t first = caller->loc_list.size();
+  vars.clear();
+  nodes.clear();
+  labels.clear();
+  for (ObjectPtr v : callee->loc_list) {
+    vars[&*v] = NewLocal(v->obj_name, v->ty);
+  }
+
+  // the return ending the body just leaves its value, if there are others
+  // they all store it and jump to the end of the copy.
+  NodePtr last = callee->body->ext->body;
+  while (last != nullptr && last->next != nullptr) {
+    last = last->next;
+  }
+  tail = last != nullptr && last->kind == ND_RETURN ? &*last : nullptr;
+  result = nullptr;
+  end_label = -1;
+  if (Returns(callee->body) > (tail != nullptr ? 1 : 0)) {
+    tail = nullptr;
+    end_label = CreateUniqueId();
+    if (!call->ty->Is<TY_VOID>()) {
+      result = NewLocal(callee->obj_name, call->ty);
+    }
+  }
+
+  auto head = MakeIR<Node>(ND_END, tok);
+  NodePtr cur = head;
+  // the arguments are assigned in order, the parameters are stored in reverse.
+  NodePtr arg = call->ext->args;
+  for (auto p = callee->params.rbegin(); p != callee->params.rend(); p++) {
+    NodePtr next = arg->next;
+    arg->next = nullptr;
+    cur = cur->next = AssignStmt(vars[&**p], arg, tok);
+    arg = next;
+  }
+  cur = cur->next = Clone(callee->body);
+  if (end_label >= 0) {
+    NodePtr value = nullptr;
+    if (result != nullptr) {
+      value = Node::CreateVarNode(result, tok);
+      Type::TypeInfer(value);
+      value = Node::CreateUnaryNode(ND_EXPR_STMT, tok, value);
+    }
+    NodePtr end = Node::CreateBlockNode(ND_LABEL, tok, value);
+    if (value == nullptr) {
+      end->ext->body = Node::CreateBlockNode(ND_BLOCK, tok, nullptr);
+    }
+    end->ext->unique_label = end_label;
+    cur = cur->next = end;
+  }
+
+  NodePtr res = Node::CreateBlockNode(ND_STMT_EXPR, tok, head->next);
+  res->ty = call->ty;
+  res->next = call->next;
+  // the callee's block scoped locals keep their blocks, the others live in the copy.
+  for (ObjectPtr v : callee->loc_list) {
+    auto it = v->scope != nullptr ? nodes.find(v->scope) : nodes.end();
+    if (it != nodes.end()) {
+      vars[&*v]->scope = &*it->second;
+    }
+  }
+  Object::SetScope(caller->loc_list, first, res);
+  return res;
+}
+
+NodePtr Inliner::Clone(const NodePtr& node) {
+  if (node == nullptr) {
+    return nullptr;
+  }
+  if (node->kind == ND_RETURN) {
+    return CloneReturn(node);
+  }
+  auto res = MakeIR<Node>(node->kind, node->name);
+  res->ty = node->ty;
+  res->val = node->val;
+  res->var = node->var;
+  if (res->var != nullptr) {
+    auto it = vars.find(&*res->var);
+    if (it != vars.end()) {
+      res->var = it->second;
+    }
+  }
+  res->lhs = Clone(node->lhs);
+  res->rhs = Clone(node->rhs);
+
+  if (node->ext != nullptr) {
+    res->ext = MakeIR<NodeExt>();
+    NodeExtPtr ext = res->ext;
+    *ext = *node->ext;
+    ext->body = CloneList(node->ext->body);
+    ext->args = CloneList(node->ext->args);
+    ext->cond = Clone(node->ext->cond);
+    ext->then = Clone(node->ext->then);
+    ext->els = Clone(node->ext->els);
+    ext->init = Clone(node->ext->init);
+    ext->inc = Clone(node->ext->inc);
+    ext->break_label = CloneLabel(ext->break_label);
+    ext->continue_label = CloneLabel(ext->continue_label);
+    ext->unique_label = CloneLabel(ext->unique_label);
+    // the cases are in the switch body, which has been copied by now.
+    for (NodePtr& c : ext->case_nodes) {
+      c = nodes.at(&*c);
+    }
+    if (ext->default_node != nullptr) {
+      ext->default_node = nodes.at(&*ext->default_node);
+    }
+  }
+  nodes[&*node] = res;
+  return res;
+}
+
+NodePtr Inliner::CloneList(const NodePtr& list) {
+  NodePtr res = nullptr;
+  NodePtr* cur = &res;
+  for (NodePtr n = list; n != nullptr; n = n->next) {
+    *cur = Clone(n);
+    cur = &(*cur)->next;
+  }
+  return res;
+}
+
+NodePtr Inliner::CloneReturn(const NodePtr& node) {
+  NodePtr val = Clone(node->lhs);
+  if (&*node == tail) {
+    return Node::CreateUnaryNode(ND_EXPR_STMT, node->name, val);
+  }
+  NodePtr stmt = result != nullptr ? AssignStmt(result, val, node->name)
+                                   : Node::CreateUnaryNode(ND_EXPR_STMT, node->name, val);
+  stmt->next = Node::CreateJumpNode(node->name, end_label);
+  return Node::CreateBlockNode(ND_BLOCK, node->name, stmt);
+}
+
+int Inliner::CloneLabel(int label) {
+  if (label < 0) {
+    return label;
+  }
+  auto it = labels.find(label);
+  if (it != labels.end()) {
+    return it->second;
+  }
+  return labels[label] = CreateUniqueId();
+}
+
+ObjectPtr Inliner::NewLocal(const String& name, const TypePtr& ty) {
+  auto var = MakeIR<Object>(Objectkind::OB_LOCAL, name, ty);
+  caller->loc_list.push_back(var);
+  return var;
+}
+
+NodePtr Inliner::AssignStmt(const ObjectPtr& var, const NodePtr& val, TokenPtr tok) {
+  NodePtr assign = Node::CreateBinaryNode(ND_ASSIGN, tok, Node::CreateVarNode(var, tok), val);
+  Type::TypeInfer(assign);
+  return Node::CreateUnaryNode(ND_EXPR_STMT, tok, assign);
+}
+
+int Inliner::Returns(const NodePtr& node) {
+  if (node == nullptr) {
+    return 0;
+  }
+  int n = (node->kind == ND_RETURN) + Returns(node->lhs) + Returns(node->rhs);
+  if (node->ext != nullptr) {
+    for (NodePtr s = node->ext->body; s != nullptr; s = s->next) {
+      n += Returns(s);
+    }
+    n += Returns(node->ext->cond) + Returns(node->ext->then) + Returns(node->ext->els) +
+         Returns(node->ext->init) + Returns(node->ext->inc);
+  }
+  return n;
+}
+
+void Inliner::Refs(const NodePtr& node, std::unordered_set<String>& names) {
+  if (node == nullptr) {
+    return;
+  }
+  if (node->kind == ND_CALL) {
+    names.insert(node->name->GetIdent());
+  }
+  if (node->kind == ND_VAR && node->var->Is<OB_FUNCTION>()) {
+    names.insert(node->var->obj_name);
+  }
+  Refs(node->lhs, names);
+  Refs(node->rhs, names);
+  if (node->ext != nullptr) {
+    for (NodePtr n = node->ext->body; n != nullptr; n = n->next) {
+      Refs(n, names);
+    }
+    for (NodePtr n = node->ext->args; n != nullptr; n = n->next) {
+      Refs(n, names);
+    }
+    Refs(node->ext->cond, names);
+    Refs(node->ext->then, names);
+    Refs(node->ext->els, names);
+    Refs(node->ext->init, names);
+    Refs(node->ext->inc, names);
+  }
+}
@@ -0,0 +1,73 @@
+/*
+ * This project is exclusively owned by QingChuanWS and shall not be used for
+ * commercial and profitting purpose without QingChuanWS's permission.
+ *
+ * @ Author: bingshan45@163.com
+ * @ Github: https://github.com/QingChuanWS
+ * @ Description:
+ *
+ * Copyright (c) 2023 by QingChuanWS, All Rights Reserved.
+ */
+
+#ifndef INLINE_GRUAD
+#define INLINE_GRUAD
+
+#include <unordered_map>
+#include <unordered_set>
+
+#include "node.h"
+#include "object.h"
+#include "parser.h"
+#include "utils.h"
+
+// Replaces the calls of small static functions by a statement expression
+// holding a copy of the callee body.
+//
+// The copy gets its own locals and labels in the caller. The arguments are
+// assigned to the copied parameters, and a return stores the result and jumps
+// to the end of the copy. Copies are not inlined into again, so a recursive
+// function is expanded by one level at most. Static functions no call is left
+// to are dropped.
+class Inliner {
+ public:
+  // size of the largest body in nodes inlined at -O1.
+  static constexpr int kDefaultLimit = 80;
+
+  // bodies of more than limit nodes are not inlined, 0 turns inlining off.
+  explicit Inliner(int limit) : limit(limit) {}
+  void Run(ASTree& ast);
+
+ private:
+  // the static function a call can be replaced by, null if there is none.
+  ObjectPtr Callee(const NodePtr& call) const;
+  // inline the calls in the tree, bottom up.
+  void Walk(NodePtr& node);
+  NodePtr Expand(const NodePtr& call, const ObjectPtr& callee);
+  // copy a tree, mapping the callee's locals, labels and returns.
+  NodePtr Clone(const NodePtr& node);
+  NodePtr CloneList(const NodePtr& list);
+  NodePtr CloneReturn(const NodePtr& node);
+  int CloneLabel(int label);
+  ObjectPtr NewLocal(const String& name, const TypePtr& ty);
+  static NodePtr AssignStmt(const ObjectPtr& var, const NodePtr& val, TokenPtr tok);
+  // number of return statements in a tree.
+  static int Returns(const NodePtr& node);
+  // collect the names of the functions a tree calls or takes the address of.
+  static void Refs(const NodePtr& node, std::unordered_set<String>& names);
+
+  int limit;
+  // static function definitions by name.
+  std::unordered_map<String, ObjectPtr> funcs{};
+  ObjectPtr caller = nullptr;
+
+  // state of the current expansion.
+  std::unordered_map<const Object*, ObjectPtr> vars{};
+  std::unordered_map<const Node*, NodePtr> nodes{};
+  std::unordered_map<int, int> labels{};
+  // the return that ends the callee body, it just leaves its value.
+  const Node* tail = nullptr;
+  ObjectPtr result = nullptr;
+  int end_label = -1;
+};
+
+#endif  // !INLINE_GRUAD
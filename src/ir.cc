@@ -0,0 +1,879 @@
+/*
+ * This project is exclusively owned by QingChuanWS and shall not be used for
+ * commercial and profitting purpose without QingChuanWS's permission.
+ *
+ * @ Author: bingshan45@163.com
+ * @ Github: https://github.com/QingChuanWS
+ * @ Description:
+ *
+ * Copyright (c) 2023 by QingChuanWS, All Rights Reserved.
+ */
+
+#include "ir.h"
+
+#include "object.h"
+#include "tools.h"
+#include "type.h"
+
+// whether a value of type ty fits in a register.
+static bool IsScalar(const TypePtr& ty) {
+  return ty->IsInteger() || (ty->Is<TY_PRT>() && !ty->Is<TY_ARRAY>());
+}
+
+static IRType ToIRType(const TypePtr& ty) {
+  if (ty->Is<TY_BOOL>()) {
+    return IRT_I1;
+  }
+  if (!ty->IsInteger()) {
+    return ty->Is<TY_VOID>() ? IRT_I64 : IRT_PTR;
+  }
+  switch (ty->Size()) {
+    case 1:
+      return IRT_I8;
+    case 2:
+      return IRT_I16;
+    case 4:
+      return IRT_I32;
+    default:
+      return IRT_I64;
+  }
+}
+
+// type of the result of op before the expression it computes is known.
+static IRType ResultType(IROp op, int size) {
+  switch (op) {
+    case IR_LOCAL_ADDR:
+    case IR_GLOBAL_ADDR:
+      return IRT_PTR;
+    case IR_EQ:
+    case IR_NE:
+    case IR_LT:
+    case IR_LE:
+    case IR_NOT:
+    case IR_BOOL:
+      return IRT_I1;
+    case IR_LOAD:
+    case IR_SEXT:
+      return size == 1 ? IRT_I8 : size == 2 ? IRT_I16 : size == 4 ? IRT_I32 : IRT_I64;
+    default:
+      return size == 4 ? IRT_I32 : IRT_I64;
+  }
+}
+
+bool IRBuilder::HasAssign(const NodePtr& node) {
+  if (node == nullptr) {
+    return false;
+  }
+  if (node->kind == ND_ASSIGN) {
+    return true;
+  }
+  if (HasAssign(node->lhs) || HasAssign(node->rhs)) {
+    return true;
+  }
+  if (node->ext == nullptr) {
+    return false;
+  }
+  for (NodePtr n = node->ext->body; n != nullptr; n = n->next) {
+    if (HasAssign(n)) {
+      return true;
+    }
+  }
+  for (NodePtr n = node->ext->args; n != nullptr; n = n->next) {
+    if (HasAssign(n)) {
+      return true;
+    }
+  }
+  return HasAssign(node->ext->cond) || HasAssign(node->ext->then) || HasAssign(node->ext->els) ||
+         HasAssign(node->ext->init) || HasAssign(node->ext->inc);
+}
+
+bool IRBuilder::IsConst(const NodePtr& node, int64_t* val) {
+  if (node->kind == ND_NUM) {
+    *val = node->val;
+    return true;
+  }
+  if (node->kind != ND_CAST || !node->ty->IsInteger() || !IsConst(node->lhs, val)) {
+    return false;
+  }
+  if (node->ty->Is<TY_BOOL>()) {
+    *val = *val != 0;
+    return true;
+  }
+  switch (node->ty->Size()) {
+    case 1:
+      *val = static_cast<int8_t>(*val);
+      break;
+    case 2:
+      *val = static_cast<int16_t>(*val);
+      break;
+    case 4:
+      *val = static_cast<int32_t>(*val);
+      break;
+    default:
+      break;
+  }
+  return true;
+}
+
+IRFunction IRBuilder::Build(ObjectPtr fn) {
+  IRFunction f;
+  f.fn = fn;
+  f.name = &fn->obj_name;
+  f.stack_size = fn->func_attr.stack_size;
+
+  IRBuilder b(f);
+  b.Analyze(fn->body);
+  // pointer arithmetic from one local to its neighbours only works if they
+  // all stay in memory, so a function taking a local's address keeps them.
+  bool keep_frame = false;
+  for (ObjectPtr var : b.addr_taken) {
+    keep_frame |= var->Is<OB_LOCAL>();
+  }
+  for (ObjectPtr var : fn->loc_list) {
+    if (!keep_frame && IsScalar(var->ty) && !b.addr_taken.count(var) && !b.temp_vars.count(var)) {
+      b.var_reg[var] = b.NewReg(ToIRType(var->ty));
+    }
+  }
+  b.var_reg_cnt = f.vreg_cnt;
+  // the parameters are stored in reverse order.
+  for (auto p = fn->params.rbegin(); p != fn->params.rend(); p++) {
+    auto it = b.var_reg.find(*p);
+    f.params.push_back({it != b.var_reg.end() ? it->second : -1, (*p)->ty->Size(), (*p)->offset});
+  }
+
+  b.SetBlock(b.NewBlock());
+  b.StmtGen(fn->body);
+  b.Emit({IR_RET});
+
+  // drop the blocks no branch reaches.
+  std::vector<bool> reachable(f.blocks.size(), false);
+  std::vector<int> work = {0};
+  reachable[0] = true;
+  while (!work.empty()) {
+    const std::vector<IRInst>& insts = f.blocks[work.back()].insts;
+    work.pop_back();
+    if (insts.empty()) {
+      unreachable();
+    }
+    const IRInst& term = insts.back();
+    term.ForEachSucc([&](int succ) {
+      if (!reachable[succ]) {
+        reachable[succ] = true;
+        work.push_back(succ);
+      }
+    });
+  }
+  std::vector<int> layout;
+  for (int block : f.layout) {
+    if (reachable[block]) {
+      layout.push_back(block);
+    }
+  }
+  f.layout = std::move(layout);
+  return f;
+}
+
+bool IRBuilder::IsTempVar(const NodePtr& node) const {
+  return node->kind == ND_VAR && node->var->Is<OB_LOCAL>() && node->var->obj_name.empty() &&
+         node->var->ty->Is<TY_PRT>() && !node->var->ty->Is<TY_ARRAY>();
+}
+
+NodePtr* IRBuilder::TempTarget(NodePtr& assign) const {
+  if (!IsTempVar(assign->lhs)) {
+    return nullptr;
+  }
+  NodePtr* rhs = &assign->rhs;
+  while ((*rhs)->kind == ND_CAST && (*rhs)->ty->Is<TY_PRT>()) {
+    rhs = &(*rhs)->lhs;
+  }
+  return (*rhs)->kind == ND_ADDR ? &(*rhs)->lhs : nullptr;
+}
+
+void IRBuilder::Analyze(NodePtr& body) {
+  Scan(body);
+  for (auto& target : temp_targets) {
+    if (bad_temps.count(target.first)) {
+      for (NodePtr& node : target.second) {
+        MarkAddrTaken(node);
+      }
+    } else {
+      temp_vars.insert(target.first);
+    }
+  }
+}
+
+void IRBuilder::MarkAddrTaken(NodePtr& node) {
+  switch (node->kind) {
+    case ND_VAR:
+      addr_taken.insert(node->var);
+      return;
+    case ND_COMMON:
+      MarkAddrTaken(node->rhs);
+      return;
+    case ND_MUMBER:
+      MarkAddrTaken(node->lhs);
+      return;
+    default:
+      return;
+  }
+}
+
+void IRBuilder::ScanList(NodePtr& list) {
+  for (NodePtr n = list; n != nullptr; n = n->next) {
+    Scan(n);
+  }
+}
+
+void IRBuilder::Scan(NodePtr& node) {
+  if (node == nullptr) {
+    return;
+  }
+  switch (node->kind) {
+    case ND_ADDR:
+      // the address of a temporary's target can't be taken again.
+      if (node->lhs->kind == ND_DEREF && IsTempVar(node->lhs->lhs)) {
+        bad_temps.insert(node->lhs->lhs->var);
+      }
+      MarkAddrTaken(node->lhs);
+      Scan(node->lhs);
+      return;
+    case ND_ASSIGN:
+      // tmp = &A
+      if (NodePtr* target = TempTarget(node)) {
+        temp_targets[node->lhs->var].push_back(*target);
+        Scan(*target);
+        return;
+      }
+      break;
+    case ND_DEREF:
+      // *tmp
+      if (IsTempVar(node->lhs)) {
+        return;
+      }
+      break;
+    case ND_VAR:
+      if (IsTempVar(node)) {
+        bad_temps.insert(node->var);
+      }
+      return;
+    default:
+      break;
+  }
+
+  Scan(node->lhs);
+  Scan(node->rhs);
+  if (node->ext != nullptr) {
+    ScanList(node->ext->body);
+    ScanList(node->ext->args);
+    Scan(node->ext->cond);
+    Scan(node->ext->then);
+    Scan(node->ext->els);
+    Scan(node->ext->init);
+    Scan(node->ext->inc);
+  }
+}
+
+int IRBuilder::NewBlock() {
+  f.blocks.push_back({CreateUniqueId()});
+  return f.blocks.size() - 1;
+}
+
+int IRBuilder::BlockOf(int label) {
+  auto it = label_block.find(label);
+  if (it != label_block.end()) {
+    return it->second;
+  }
+  f.blocks.push_back({label});
+  label_block[label] = f.blocks.size() - 1;
+  return f.blocks.size() - 1;
+}
+
+void IRBuilder::SetBlock(int block) {
+  if (cur_block >= 0) {
+    const std::vector<IRInst>& insts = f.blocks[cur_block].insts;
+    if (insts.empty() || !insts.back().IsTerminator()) {
+      Jump(block);
+    }
+  }
+  cur_block = block;
+  f.layout.push_back(block);
+}
+
+void IRBuilder::Emit(IRInst inst) {
+  // code after a jump or return starts an unreachable block.
+  const std::vector<IRInst>& insts = f.blocks[cur_block].insts;
+  if (!insts.empty() && insts.back().IsTerminator()) {
+    cur_block = NewBlock();
+    f.layout.push_back(cur_block);
+  }
+  f.blocks[cur_block].insts.push_back(std::move(inst));
+}
+
+VReg IRBuilder::EmitOp(IROp op, int size, VReg a, VReg b, int64_t imm) {
+  IRInst inst;
+  inst.op = op;
+  inst.size = size;
+  inst.dst = NewReg(ResultType(op, size));
+  inst.a = a;
+  inst.b = b;
+  inst.imm = imm;
+  Emit(inst);
+  return inst.dst;
+}
+
+void IRBuilder::Jump(int target) {
+  IRInst inst;
+  inst.op = IR_JMP;
+  inst.then = target;
+  Emit(inst);
+}
+
+void IRBuilder::Branch(VReg cond, int then, int els) {
+  IRInst inst;
+  inst.op = IR_BR;
+  inst.a = cond;
+  inst.then = then;
+  inst.els = els;
+  Emit(inst);
+}
+
+VReg IRBuilder::Pin(VReg v, NodePtr& later) {
+  if (IsVarReg(v) && HasAssign(later)) {
+    return EmitOp(IR_MOV, 8, v);
+  }
+  return v;
+}
+
+IRBuilder::LValue IRBuilder::GetLValue(NodePtr& node) {
+  switch (node->kind) {
+    case ND_VAR: {
+      auto it = var_reg.find(node->var);
+      if (it != var_reg.end()) {
+        return {it->second, -1};
+      }
+      if (node->var->Is<OB_LOCAL>()) {
+        return {-1, EmitOp(IR_LOCAL_ADDR, 8, -1, -1, node->var->offset)};
+      }
+      IRInst inst;
+      inst.op = IR_GLOBAL_ADDR;
+      inst.dst = NewReg(IRT_PTR);
+      inst.name = &node->var->obj_name;
+      Emit(inst);
+      return {-1, inst.dst};
+    }
+    case ND_DEREF:
+      if (IsTempVar(node->lhs) && temp_vars.count(node->lhs->var)) {
+        return temp_binding[node->lhs->var];
+      }
+      return {-1, ExprGen(node->lhs)};
+    case ND_COMMON:
+      ExprGen(node->lhs);
+      return GetLValue(node->rhs);
+    case ND_MUMBER: {
+      LValue lv = GetLValue(node->lhs);
+      return {-1, EmitOp(IR_ADD, 8, lv.addr, -1, node->ext->mem->GetOffset())};
+    }
+    default:
+      break;
+  }
+  node->name->ErrorTok("not an lvalue");
+  return {};
+}
+
+VReg IRBuilder::Load(const LValue& lv, TypePtr& ty) {
+  if (lv.var >= 0) {
+    return lv.var;
+  }
+  // arrays and structs are represented by their address.
+  if (ty->Is<TY_ARRAY>() || ty->Is<TY_STRUCT>() || ty->Is<TY_UNION>()) {
+    return lv.addr;
+  }
+  return EmitOp(IR_LOAD, ty->Size(), lv.addr);
+}
+
+bool IRBuilder::Retarget(VReg v, VReg var, int size) {
+  std::vector<IRInst>& insts = f.blocks[cur_block].insts;
+  if (IsVarReg(v) || insts.empty() || insts.back().dst != v) {
+    return false;
+  }
+  IRInst& last = insts.back();
+  bool fits = size == 8;
+  switch (last.op) {
+    case IR_IMM:
+      fits |= (size == 4 && last.imm == static_cast<int32_t>(last.imm)) ||
+              (size == 2 && last.imm == static_cast<int16_t>(last.imm)) ||
+              (size == 1 && last.imm == static_cast<int8_t>(last.imm));
+      break;
+    case IR_LOAD:
+    case IR_SEXT:
+      fits |= last.size <= size;
+      break;
+    case IR_EQ:
+    case IR_NE:
+    case IR_LT:
+    case IR_LE:
+    case IR_NOT:
+    case IR_BOOL:
+      fits = true;
+      break;
+    default:
+      break;
+  }
+  if (fits) {
+    last.dst = var;
+  }
+  return fits;
+}
+
+VReg IRBuilder::Store(const LValue& lv, TypePtr& ty, VReg v) {
+  IRInst inst;
+  inst.size = ty->Size();
+  if (lv.var >= 0) {
+    if (Retarget(v, lv.var, ty->Size())) {
+      return lv.var;
+    }
+    // a promoted variable keeps the value it would read back from memory.
+    inst.op = ty->Size() == 8 ? IR_MOV : IR_SEXT;
+    inst.dst = lv.var;
+    inst.a = v;
+  } else if (ty->Is<TY_STRUCT>() || ty->Is<TY_UNION>()) {
+    inst.op = IR_COPY;
+    inst.a = lv.addr;
+    inst.b = v;
+    inst.imm = ty->Size();
+  } else {
+    inst.op = IR_STORE;
+    inst.a = lv.addr;
+    inst.b = v;
+  }
+  Emit(inst);
+  return v;
+}
+
+VReg IRBuilder::Cast(VReg v, TypePtr& from, TypePtr& to) {
+  enum { NONE = 0, I32I8, I32I16, I32I64 };
+  static const int cast_table[4][4] = {{NONE, NONE, NONE, I32I64},
+                                       {I32I8, NONE, NONE, I32I64},
+                                       {I32I8, I32I16, NONE, I32I64},
+                                       {I32I8, I32I16, NONE, NONE}};
+
+  auto GetTypeId = [](TypePtr& t) -> int {
+    enum { I8 = 0, I16, I32, I64 };
+    if (t->Is<TY_CHAR>()) {
+      return I8;
+    } else if (t->Is<TY_SHORT>()) {
+      return I16;
+    } else if (t->Is<TY_INT>()) {
+      return I32;
+    } else {
+      return I64;
+    }
+  };
+
+  if (to->Is<TY_VOID>()) {
+    return v;
+  }
+  if (to->Is<TY_BOOL>()) {
+    return EmitOp(IR_BOOL, from->IsInteger() && from->Size() <= 4 ? 4 : 8, v);
+  }
+  switch (cast_table[GetTypeId(from)][GetTypeId(to)]) {
+    case I32I8:
+      return EmitOp(IR_SEXT, 1, v);
+    case I32I16:
+      return EmitOp(IR_SEXT, 2, v);
+    case I32I64:
+      return EmitOp(IR_SEXT, 4, v);
+    default:
+      return v;
+  }
+}
+
+VReg IRBuilder::ExprGen(NodePtr& node) {
+  VReg v = ExprValue(node);
+  if (!IsVarReg(v) && node->ty != nullptr) {
+    f.types[v] = ToIRType(node->ty);
+  }
+  return v;
+}
+
+VReg IRBuilder::ExprValue(NodePtr& node) {
+  switch (node->kind) {
+    case ND_NUM:
+      return EmitOp(IR_IMM, 8, -1, -1, node->val);
+    case ND_NEG:
+      return EmitOp(IR_NEG, 8, ExprGen(node->lhs));
+    case ND_VAR:
+    case ND_MUMBER:
+    case ND_DEREF:
+      return Load(GetLValue(node), node->ty);
+    case ND_ADDR: {
+      LValue lv = GetLValue(node->lhs);
+      if (lv.var >= 0) {
+        unreachable();
+      }
+      return lv.addr;
+    }
+    case ND_ASSIGN: {
+      // tmp = &A binds tmp to A.
+      if (IsTempVar(node->lhs) && temp_vars.count(node->lhs->var)) {
+        LValue lv = GetLValue(*TempTarget(node));
+        // the pointer variable may change before the temporary is read.
+        if (lv.var < 0 && IsVarReg(lv.addr)) {
+          lv.addr = EmitOp(IR_MOV, 8, lv.addr);
+        }
+        temp_binding[node->lhs->var] = lv;
+        return lv.var >= 0 ? lv.var : lv.addr;
+      }
+      LValue lv = GetLValue(node->lhs);
+      if (lv.var < 0) {
+        lv.addr = Pin(lv.addr, node->rhs);
+      }
+      return Store(lv, node->ty, ExprGen(node->rhs));
+    }
+    case ND_STMT_EXPR:
+      last_value = -1;
+      for (NodePtr n = node->ext->body; n != nullptr; n = n->next) {
+        StmtGen(n);
+      }
+      return last_value >= 0 ? last_value : EmitOp(IR_IMM, 8);
+    case ND_COMMON:
+      ExprGen(node->lhs);
+      return ExprGen(node->rhs);
+    case ND_CAST: {
+      int64_t val = 0;
+      if (IsConst(node, &val)) {
+        return EmitOp(IR_IMM, 8, -1, -1, val);
+      }
+      return Cast(ExprGen(node->lhs), node->lhs->ty, node->ty);
+    }
+    case ND_COND: {
+      VReg res = NewReg();
+      int then = NewBlock(), els = NewBlock(), end = NewBlock();
+      Branch(ExprGen(node->ext->cond), then, els);
+      SetBlock(then);
+      Emit({IR_MOV, 8, res, ExprGen(node->ext->then)});
+      Jump(end);
+      SetBlock(els);
+      Emit({IR_MOV, 8, res, ExprGen(node->ext->els)});
+      SetBlock(end);
+      return res;
+    }
+    case ND_NOT:
+      return EmitOp(IR_NOT, 8, ExprGen(node->lhs));
+    case ND_BITNOT:
+      return EmitOp(IR_BITNOT, 8, ExprGen(node->lhs));
+    case ND_LOGOR:
+    case ND_LOGAND: {
+      VReg res = NewReg(IRT_I1);
+      int rhs = NewBlock(), yes = NewBlock(), no = NewBlock(), end = NewBlock();
+      if (node->kind == ND_LOGOR) {
+        Branch(ExprGen(node->lhs), yes, rhs);
+      } else {
+        Branch(ExprGen(node->lhs), rhs, no);
+      }
+      SetBlock(rhs);
+      Branch(ExprGen(node->rhs), yes, no);
+      SetBlock(yes);
+      Emit({IR_IMM, 8, res, -1, -1, 1});
+      Jump(end);
+      SetBlock(no);
+      Emit({IR_IMM, 8, res, -1, -1, 0});
+      SetBlock(end);
+      return res;
+    }
+    case ND_CALL: {
+      IRInst inst;
+      inst.op = IR_CALL;
+      for (NodePtr arg = node->ext->args; arg != nullptr; arg = arg->next) {
+        VReg v = ExprGen(arg);
+        for (NodePtr later = arg->next; later != nullptr; later = later->next) {
+          if (IsVarReg(v) && HasAssign(later)) {
+            v = EmitOp(IR_MOV, 8, v);
+            break;
+          }
+        }
+        inst.args.push_back(v);
+      }
+      inst.dst = NewReg();
+      inst.name = &node->name->GetIdent();
+      Emit(inst);
+      return inst.dst;
+    }
+    default:
+      break;
+  }
+
+  // a small constant right operand becomes an immediate. Any constant factor or
+  // divisor does, the code generator strength reduces them or loads them itself.
+  VReg r = -1;
+  int64_t imm = 0;
+  bool any_imm = node->kind == ND_MUL || node->kind == ND_DIV || node->kind == ND_MOD;
+  if (!IsConst(node->rhs, &imm) || (!any_imm && (imm < INT32_MIN || imm > INT32_MAX))) {
+    imm = 0;
+    r = Pin(ExprGen(node->rhs), node->lhs);
+  }
+  VReg l = ExprGen(node->lhs);
+
+  int sz = (node->lhs->ty->Is<TY_LONG>() || node->lhs->IsPointerNode()) ? 8 : 4;
+  switch (node->kind) {
+    case ND_ADD:
+      return EmitOp(IR_ADD, sz, l, r, imm);
+    case ND_SUB:
+      return EmitOp(IR_SUB, sz, l, r, imm);
+    case ND_MUL:
+      return EmitOp(IR_MUL, sz, l, r, imm);
+    case ND_DIV:
+      return EmitOp(IR_DIV, sz, l, r, imm);
+    case ND_MOD:
+      return EmitOp(IR_MOD, sz, l, r, imm);
+    case ND_BITAND:
+      return EmitOp(IR_AND, 8, l, r, imm);
+    case ND_BITOR:
+      return EmitOp(IR_OR, 8, l, r, imm);
+    case ND_BITXOR:
+      return EmitOp(IR_XOR, 8, l, r, imm);
+    case ND_EQ:
+      return EmitOp(IR_EQ, sz, l, r, imm);
+    case ND_NE:
+      return EmitOp(IR_NE, sz, l, r, imm);
+    case ND_LT:
+      return EmitOp(IR_LT, sz, l, r, imm);
+    case ND_LE:
+      return EmitOp(IR_LE, sz, l, r, imm);
+    case ND_SHL:
+      return EmitOp(IR_SHL, sz, l, r, imm);
+    case ND_SHR:
+      return EmitOp(IR_SAR, sz, l, r, imm);
+    default:
+      node->name->ErrorTok("invalid expression.");
+  }
+  return -1;
+}
+
+void IRBuilder::SwitchSearch(VReg v, int sz, const std::vector<SwitchCase>& cases, size_t lo,
+                             size_t hi, int miss) {
+  auto compare = [&](IROp op, int64_t val) {
+    VReg b = -1;
+    if (val < INT32_MIN || val > INT32_MAX) {
+      b = EmitOp(IR_IMM, 8, -1, -1, val);
+    }
+    return EmitOp(op, sz, v, b, val);
+  };
+
+  if (hi - lo < SwitchLowering::kMinCases) {
+    for (size_t i = lo; i < hi; i++) {
+      int next = NewBlock();
+      Branch(compare(IR_EQ, cases[i].first), BlockOf(cases[i].second), next);
+      SetBlock(next);
+    }
+    Jump(miss);
+    return;
+  }
+  size_t mid = lo + (hi - lo) / 2;
+  int next = NewBlock(), lower = NewBlock(), upper = NewBlock();
+  Branch(compare(IR_EQ, cases[mid].first), BlockOf(cases[mid].second), next);
+  SetBlock(next);
+  Branch(compare(IR_LT, cases[mid].first), lower, upper);
+  SetBlock(lower);
+  SwitchSearch(v, sz, cases, lo, mid, miss);
+  SetBlock(upper);
+  SwitchSearch(v, sz, cases, mid + 1, hi, miss);
+}
+
+void IRBuilder::SwitchTable(VReg v, int sz, const std::vector<SwitchCase>& cases, int miss) {
+  IRInst inst{IR_SWITCH, static_cast<uint8_t>(sz), -1, v};
+  inst.imm = cases.front().first;
+  inst.els = miss;
+  for (int label : SwitchLowering::Targets(cases)) {
+    inst.table.push_back(label >= 0 ? BlockOf(label) : miss);
+  }
+  Emit(inst);
+}
+
+void IRBuilder::StmtGen(NodePtr& node) {
+  switch (node->kind) {
+    case ND_EXPR_STMT:
+      last_value = ExprGen(node->lhs);
+      return;
+    case ND_BLOCK:
+      for (NodePtr n = node->ext->body; n != nullptr; n = n->next) {
+        StmtGen(n);
+      }
+      return;
+    case ND_GOTO:
+      Jump(BlockOf(node->ext->unique_label));
+      return;
+    case ND_LABEL:
+    case ND_CASE:
+      SetBlock(BlockOf(node->ext->unique_label));
+      StmtGen(node->ext->body);
+      return;
+    case ND_RETURN:
+      Emit({IR_RET, 8, -1, ExprGen(node->lhs)});
+      return;
+    case ND_IF: {
+      int then = NewBlock(), els = NewBlock(), end = NewBlock();
+      Branch(ExprGen(node->ext->cond), then, els);
+      SetBlock(then);
+      StmtGen(node->ext->then);
+      Jump(end);
+      SetBlock(els);
+      if (node->ext->els != nullptr) {
+        StmtGen(node->ext->els);
+      }
+      SetBlock(end);
+      return;
+    }
+    case ND_SWITCH: {
+      VReg v = ExprGen(node->ext->cond);
+      int sz = SwitchLowering::Size(node);
+      std::vector<SwitchCase> cases = SwitchLowering::Cases(node);
+      int miss = BlockOf(SwitchLowering::MissLabel(node));
+      if (SwitchLowering::IsDenseSwitch(cases)) {
+        SwitchTable(v, sz, cases, miss);
+      } else {
+        SwitchSearch(v, sz, cases, 0, cases.size(), miss);
+      }
+      StmtGen(node->ext->then);
+      SetBlock(BlockOf(node->ext->break_label));
+      return;
+    }
+    case ND_FOR: {
+      if (node->ext->init != nullptr) {
+        StmtGen(node->ext->init);
+      }
+      int begin = NewBlock(), body = NewBlock();
+      SetBlock(begin);
+      if (node->ext->cond != nullptr) {
+        Branch(ExprGen(node->ext->cond), body, BlockOf(node->ext->break_label));
+      }
+      SetBlock(body);
+      StmtGen(node->ext->then);
+      SetBlock(BlockOf(node->ext->continue_label));
+      if (node->ext->inc != nullptr) {
+        ExprGen(node->ext->inc);
+      }
+      Jump(begin);
+      SetBlock(BlockOf(node->ext->break_label));
+      return;
+    }
+    default:
+      node->name->ErrorTok("invalid statement");
+  }
+}
+
+void IRFunction::Dump(FILE* out) const {
+  // indexed by IROp.
+  static const char* op_names[] = {"imm",    "mov",  "local_addr", "global_addr", "load",   "store",
+                                   "copy",   "add",  "sub",        "mul",         "div",    "mod",
+                                   "and",    "or",   "xor",        "shl",         "sar",    "eq",
+                                   "ne",     "lt",   "le",         "neg",         "bitnot", "not",
+                                   "sext",   "bool", "call",       "jmp",         "br",     "ret",
+                                   "switch", "phi"};
+  static const char* type_names[] = {"i1", "i8", "i16", "i32", "i64", "ptr"};
+  auto reg = [&](VReg v) { fprintf(out, "%%%d", v); };
+  auto label = [&](int block) { fprintf(out, ".L..%d", blocks[block].label); };
+
+  fprintf(out, "function %s(", name->c_str());
+  for (size_t i = 0; i < params.size(); i++) {
+    fprintf(out, i ? ", " : "");
+    if (params[i].reg >= 0) {
+      fprintf(out, "%%%d:%s", params[i].reg, type_names[types[params[i].reg]]);
+    } else {
+      fprintf(out, "[rbp - %d]", params[i].offset);
+    }
+  }
+  fprintf(out, ") {\n");
+  for (int b : layout) {
+    label(b);
+    fprintf(out, ":\n");
+    for (const IRInst& inst : blocks[b].insts) {
+      fprintf(out, "  ");
+      if (inst.dst >= 0) {
+        fprintf(out, "%%%d:%s = ", inst.dst, type_names[types[inst.dst]]);
+      }
+      fprintf(out, "%s", op_names[inst.op]);
+      switch (inst.op) {
+        case IR_IMM:
+          fprintf(out, " %ld", inst.imm);
+          break;
+        case IR_LOCAL_ADDR:
+          fprintf(out, " [rbp - %ld]", inst.imm);
+          break;
+        case IR_GLOBAL_ADDR:
+          fprintf(out, " @%s", inst.name->c_str());
+          break;
+        case IR_MOV:
+          fprintf(out, " ");
+          reg(inst.a);
+          break;
+        case IR_COPY:
+          fprintf(out, " ");
+          reg(inst.a);
+          fprintf(out, ", ");
+          reg(inst.b);
+          fprintf(out, ", %ld", inst.imm);
+          break;
+        case IR_CALL:
+          fprintf(out, " @%s(", inst.name->c_str());
+          for (size_t i = 0; i < inst.args.size(); i++) {
+            fprintf(out, i ? ", " : "");
+            reg(inst.args[i]);
+          }
+          fprintf(out, ")");
+          break;
+        case IR_JMP:
+          fprintf(out, " ");
+          label(inst.then);
+          break;
+        case IR_BR:
+          fprintf(out, " ");
+          reg(inst.a);
+          fprintf(out, ", ");
+          label(inst.then);
+          fprintf(out, ", ");
+          label(inst.els);
+          break;
+        case IR_SWITCH:
+          fprintf(out, ".%d ", inst.size);
+          reg(inst.a);
+          fprintf(out, " - %ld, [", inst.imm);
+          for (size_t i = 0; i < inst.table.size(); i++) {
+            fprintf(out, i ? ", " : "");
+            label(inst.table[i]);
+          }
+          fprintf(out, "], ");
+          label(inst.els);
+          break;
+        case IR_RET:
+          if (inst.a >= 0) {
+            fprintf(out, " ");
+            reg(inst.a);
+          }
+          break;
+        case IR_PHI:
+          for (size_t i = 0; i < inst.args.size(); i++) {
+            fprintf(out, i ? ", [" : " [");
+            reg(inst.args[i]);
+            fprintf(out, ", ");
+            label(inst.from[i]);
+            fprintf(out, "]");
+          }
+          break;
+        default:
+          // the sized operations.
+          fprintf(out, ".%d ", inst.size);
+          reg(inst.a);
+          if (inst.op == IR_STORE || inst.b >= 0) {
+            fprintf(out, ", ");
+            reg(inst.b);
+          } else if (inst.op >= IR_ADD && inst.op <= IR_LE) {
+            fprintf(out, ", %ld", inst.imm);
+          }
+          break;
+      }
+      fprintf(out, "\n");
+    }
+  }
+  fprintf(out, "}\n\n");
+}
@@ -0,0 +1,245 @@
+/*
+ * This project is exclusively owned by QingChuanWS and shall not be used for
+ * commercial and profitting purpose without QingChuanWS's permission.
+ *
+ * @ Author: bingshan45@163.com
+ * @ Github: https://github.com/QingChuanWS
+ * @ Description:
+ *
+ * Copyright (c) 2023 by QingChuanWS, All Rights Reserved.
+ */
+
+#ifndef IR_GRUAD
+#define IR_GRUAD
+
+#include <cstdint>
+#include <cstdio>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include "node.h"
+#include "switch.h"
+#include "utils.h"
+
+// virtual register number, -1 for none.
+using VReg = int;
+
+// type of the value a virtual register holds.
+enum IRType : uint8_t {
+  IRT_I1,
+  IRT_I8,
+  IRT_I16,
+  IRT_I32,
+  IRT_I64,
+  IRT_PTR,
+};
+
+enum IROp : uint8_t {
+  IR_IMM,          // dst = imm
+  IR_MOV,          // dst = a
+  IR_LOCAL_ADDR,   // dst = rbp - imm
+  IR_GLOBAL_ADDR,  // dst = &name
+  IR_LOAD,         // dst = *a, size bytes sign extended
+  IR_STORE,        // *a = b, size bytes
+  IR_COPY,         // copy imm bytes from address b to address a
+  IR_ADD,          // dst = a + b
+  IR_SUB,          // dst = a - b
+  IR_MUL,          // dst = a * b
+  IR_DIV,          // dst = a / b
+  IR_MOD,          // dst = a % b
+  IR_AND,          // dst = a & b
+  IR_OR,           // dst = a | b
+  IR_XOR,          // dst = a ^ b
+  IR_SHL,          // dst = a << b
+  IR_SAR,          // dst = a >> b
+  IR_EQ,           // dst = a == b
+  IR_NE,           // dst = a != b
+  IR_LT,           // dst = a < b
+  IR_LE,           // dst = a <= b
+  IR_NEG,          // dst = -a
+  IR_BITNOT,       // dst = ~a
+  IR_NOT,          // dst = !a
+  IR_SEXT,         // dst = a sign extended from size bytes
+  IR_BOOL,         // dst = a != 0
+  IR_CALL,         // dst = name(args...)
+  IR_JMP,          // goto then
+  IR_BR,           // if (a) goto then; else goto els
+  IR_RET,          // return a
+  IR_SWITCH,       // goto table[a - imm] if a - imm is in the table, else goto els
+  IR_PHI,          // dst = args[i] when entered from block from[i]
+  IR_END,
+};
+
+struct IRInst {
+  IROp op = IR_END;
+  // operation width or memory access size in bytes.
+  uint8_t size = 8;
+  VReg dst = -1;
+  VReg a = -1;
+  // second operand, the binary operations use imm instead if it is -1.
+  VReg b = -1;
+  int64_t imm = 0;
+  // global variable or callee, owned by the IR object that names it.
+  const String* name = nullptr;
+  // call arguments or phi operands.
+  std::vector<VReg> args{};
+  // phi predecessor blocks, parallel to args.
+  std::vector<int> from{};
+  // branch target blocks.
+  int then = -1;
+  int els = -1;
+  // switch target blocks, indexed by the value minus imm.
+  std::vector<int> table{};
+
+  bool IsTerminator() const {
+    return op == IR_JMP || op == IR_BR || op == IR_RET || op == IR_SWITCH;
+  }
+  // call fn on every block the terminator can branch to, a block may come twice.
+  template <typename F>
+  void ForEachSucc(F fn) const {
+    for (int b : {then, els}) {
+      if (b >= 0) {
+        fn(b);
+      }
+    }
+    for (int b : table) {
+      fn(b);
+    }
+  }
+  // call fn on every virtual register the instruction reads.
+  template <typename F>
+  void ForEachUse(F fn) const {
+    if (a >= 0) {
+      fn(a);
+    }
+    if (b >= 0) {
+      fn(b);
+    }
+    for (VReg v : args) {
+      fn(v);
+    }
+  }
+};
+
+struct IRBlock {
+  // assembly label id, see CreateUniqueId().
+  int label = -1;
+  std::vector<IRInst> insts{};
+};
+
+// a parameter either lives in a virtual register or in its stack slot.
+struct IRParam {
+  VReg reg = -1;
+  int size = 8;
+  int offset = 0;
+};
+
+struct IRFunction {
+  ObjectPtr fn = nullptr;
+  const String* name = nullptr;
+  std::vector<IRBlock> blocks{};
+  // block indexes in the emitted order, unreachable blocks are left out.
+  std::vector<int> layout{};
+  // parameters in argument register order.
+  std::vector<IRParam> params{};
+  int vreg_cnt = 0;
+  // type of each virtual register.
+  std::vector<IRType> types{};
+  // bytes of the stack frame used by the memory resident locals.
+  int stack_size = 0;
+
+  VReg NewReg(IRType type) {
+    types.push_back(type);
+    return vreg_cnt++;
+  }
+  // print the function in a readable text form.
+  void Dump(FILE* out) const;
+};
+
+// Lower a function body into the virtual register IR.
+//
+// Scalar locals and parameters whose address is never taken live in virtual
+// registers, everything else keeps its stack slot from Object::OffsetCal.
+// The temporaries of "+=" and "++" only ever hold the address of their
+// operand, so they are folded away instead of forcing the operand to memory.
+class IRBuilder {
+ public:
+  static IRFunction Build(ObjectPtr fn);
+
+ private:
+  // a promoted variable or a memory address.
+  struct LValue {
+    VReg var = -1;
+    VReg addr = -1;
+  };
+
+  explicit IRBuilder(IRFunction& f) : f(f) {}
+
+  // find the promotable locals and the "+=" temporaries.
+  void Analyze(NodePtr& body);
+  void Scan(NodePtr& node);
+  void ScanList(NodePtr& list);
+  void MarkAddrTaken(NodePtr& node);
+  // whether the node is a "+=" temporary candidate.
+  bool IsTempVar(const NodePtr& node) const;
+  // the operand A of "tmp = &A", looking through the cast type inference adds.
+  NodePtr* TempTarget(NodePtr& assign) const;
+
+  VReg NewReg(IRType type = IRT_I64) { return f.NewReg(type); }
+  int NewBlock();
+  // get the block of an assembly label id.
+  int BlockOf(int label);
+  // continue code generation in block, falling through from the current one.
+  void SetBlock(int block);
+  // emit an instruction to the current block.
+  void Emit(IRInst inst);
+  VReg EmitOp(IROp op, int size, VReg a = -1, VReg b = -1, int64_t imm = 0);
+  void Jump(int target);
+  void Branch(VReg cond, int then, int els);
+  // whether v is the register of a promoted variable.
+  bool IsVarReg(VReg v) const { return v < var_reg_cnt; }
+  // whether evaluating node may assign a variable.
+  static bool HasAssign(const NodePtr& node);
+  // whether node is an integer constant, possibly behind integer casts.
+  static bool IsConst(const NodePtr& node, int64_t* val);
+  // copy v if evaluating later may assign the variable v belongs to.
+  VReg Pin(VReg v, NodePtr& later);
+
+  LValue GetLValue(NodePtr& node);
+  VReg Load(const LValue& lv, TypePtr& ty);
+  // store v, returns the register holding the stored value.
+  VReg Store(const LValue& lv, TypePtr& ty, VReg v);
+  // make the instruction that just computed v write the variable var instead,
+  // if v already holds the value a store of size bytes would read back.
+  bool Retarget(VReg v, VReg var, int size);
+  VReg Cast(VReg v, TypePtr& from, TypePtr& to);
+  // evaluate node into a register typed after node.
+  VReg ExprGen(NodePtr& node);
+  // branch to the case of the sorted cases [lo, hi) matching v by binary search.
+  void SwitchSearch(VReg v, int sz, const std::vector<SwitchCase>& cases, size_t lo, size_t hi,
+                    int miss);
+  // jump through a table indexed by v minus the smallest case, for dense cases.
+  void SwitchTable(VReg v, int sz, const std::vector<SwitchCase>& cases, int miss);
+  VReg ExprValue(NodePtr& node);
+  void StmtGen(NodePtr& node);
+
+  IRFunction& f;
+  int cur_block = -1;
+  // value of the last expression statement, for statement expressions.
+  VReg last_value = -1;
+
+  // promoted variables take the first virtual registers.
+  std::unordered_map<ObjectPtr, VReg> var_reg{};
+  int var_reg_cnt = 0;
+  std::unordered_set<ObjectPtr> addr_taken{};
+  // "+=" temporaries and the operands they are bound to.
+  std::unordered_set<ObjectPtr> temp_vars{};
+  std::unordered_set<ObjectPtr> bad_temps{};
+  std::unordered_map<ObjectPtr, std::vector<NodePtr>> temp_targets{};
+  std::unordered_map<ObjectPtr, LValue> temp_binding{};
+  // blocks of the assembly label ids of goto, break, continue and case.
+  std::unordered_map<int, int> label_block{};
+};
+
+#endif  // !IR_GRUAD
@@ -0,0 +1,441 @@
+/*
+ * This project is exclusively owned by QingChuanWS and shall not be used for
+ * commercial and profitting purpose without QingChuanWS's permission.
+ *
+ * @ Author: bingshan45@163.com
+ * @ Github: https://github.com/QingChuanWS
+ * @ Description:
+ *
+ * Copyright (c) 2023 by QingChuanWS, All Rights Reserved.
+ */
+
+#include "ir_codegen.h"
+
+#include "strength.h"
+#include "switch.h"
+#include "tools.h"
+
+static const AsmReg argreg[] = {REG_DI, REG_SI, REG_DX, REG_CX, REG_R8, REG_R9};
+
+AsmOperand IRCodeGenerator::Loc(VReg v, int size) const {
+  const VRegLoc& loc = ra.locs[v];
+  if (loc.IsSpilled()) {
+    return Mem(REG_BP, -loc.slot, size);
+  }
+  return Reg(loc.reg, size);
+}
+
+AsmOperand IRCodeGenerator::InReg(VReg v, AsmReg scratch, int size) {
+  const VRegLoc& loc = ra.locs[v];
+  if (loc.IsSpilled()) {
+    Emit(I_MOV, Reg(scratch), Mem(REG_BP, -loc.slot));
+    return Reg(scratch, size);
+  }
+  return Reg(loc.reg, size);
+}
+
+AsmOperand IRCodeGenerator::Operand(const IRInst& inst, AsmReg scratch) {
+  if (inst.b < 0) {
+    return Imm(inst.imm);
+  }
+  return InReg(inst.b, scratch, inst.size);
+}
+
+AsmReg IRCodeGenerator::DstReg(VReg v) const {
+  const VRegLoc& loc = ra.locs[v];
+  return loc.IsSpilled() ? REG_AX : loc.reg;
+}
+
+void IRCodeGenerator::WriteBack(VReg v, AsmReg reg) {
+  const VRegLoc& loc = ra.locs[v];
+  if (loc.IsSpilled()) {
+    Emit(I_MOV, Mem(REG_BP, -loc.slot), Reg(reg));
+  } else if (loc.reg != reg) {
+    Emit(I_MOV, Reg(loc.reg), Reg(reg));
+  }
+}
+
+// frame offset of the k-th saved callee saved register.
+static int SaveSlot(const IRFunction& f, const RegAllocResult& ra, int k) {
+  return f.stack_size + ra.spill_size + 8 * (k + 1);
+}
+
+void IRCodeGenerator::Prologue() {
+  int frame = AlignTo(f.stack_size + ra.spill_size + 8 * ra.saved.size(), 16);
+  Emit(I_PUSH, Reg(REG_BP));
+  Emit(I_MOV, Reg(REG_BP), Reg(REG_SP));
+  Emit(I_SUB, Reg(REG_SP), Imm(frame));
+  for (size_t k = 0; k < ra.saved.size(); k++) {
+    Emit(I_MOV, Mem(REG_BP, -SaveSlot(f, ra, k)), Reg(ra.saved[k]));
+  }
+
+  // memory resident parameters go to their stack slots first, the argument
+  // registers may be allocated to the others.
+  for (size_t i = 0; i < f.params.size(); i++) {
+    const IRParam& p = f.params[i];
+    if (p.reg < 0) {
+      Emit(I_MOV, Mem(REG_BP, -p.offset, p.size), Reg(argreg[i], p.size));
+    }
+  }
+  // move the rest straight into place, last one first, unless that overwrites
+  // an argument register before it is read, then go through the stack.
+  bool direct = true;
+  for (size_t i = 0; i < f.params.size(); i++) {
+    for (size_t j = 0; j < i; j++) {
+      direct &= f.params[i].reg < 0 || ra.locs[f.params[i].reg].IsSpilled() ||
+                ra.locs[f.params[i].reg].reg != argreg[j];
+    }
+  }
+  if (!direct) {
+    for (size_t i = 0; i < f.params.size(); i++) {
+      if (f.params[i].reg >= 0) {
+        Emit(I_PUSH, Reg(argreg[i]));
+      }
+    }
+  }
+  for (int i = f.params.size() - 1; i >= 0; i--) {
+    const IRParam& p = f.params[i];
+    if (p.reg < 0) {
+      continue;
+    }
+    AsmReg src = argreg[i];
+    if (!direct) {
+      Emit(I_POP, Reg(REG_R11));
+      src = REG_R11;
+    }
+    // the value reads back as if it was stored to a stack slot.
+    AsmReg dst = DstReg(p.reg);
+    if (p.size == 4) {
+      Emit(I_MOVSXD, Reg(dst), Reg(src, 4));
+    } else if (p.size < 4) {
+      Emit(I_MOVSX, Reg(dst, 4), Reg(src, p.size));
+    } else if (dst != src) {
+      Emit(I_MOV, Reg(dst), Reg(src));
+    }
+    WriteBack(p.reg, dst);
+  }
+}
+
+void IRCodeGenerator::Epilogue() {
+  Emit(AS_LABEL, Label(LB_RETURN, *f.name));
+  for (size_t k = 0; k < ra.saved.size(); k++) {
+    Emit(I_MOV, Reg(ra.saved[k]), Mem(REG_BP, -SaveSlot(f, ra, k)));
+  }
+  Emit(I_MOV, Reg(REG_SP), Reg(REG_BP));
+  Emit(I_POP, Reg(REG_BP));
+  Emit(I_RET);
+}
+
+void IRCodeGenerator::Gen() {
+  uses.assign(f.vreg_cnt, 0);
+  for (int b : f.layout) {
+    for (const IRInst& inst : f.blocks[b].insts) {
+      inst.ForEachUse([&](VReg v) { uses[v]++; });
+    }
+  }
+
+  Prologue();
+  for (size_t i = 0; i < f.layout.size(); i++) {
+    const std::vector<IRInst>& insts = f.blocks[f.layout[i]].insts;
+    int next = i + 1 < f.layout.size() ? f.layout[i + 1] : -1;
+    Emit(AS_LABEL, Label(LB_UNIQUE, f.blocks[f.layout[i]].label));
+    size_t n = insts.size();
+    bool fuse = n >= 2 && insts[n - 1].op == IR_BR && insts[n - 2].op >= IR_EQ &&
+                insts[n - 2].op <= IR_LE && insts[n - 2].dst == insts[n - 1].a &&
+                uses[insts[n - 1].a] == 1;
+    for (size_t k = 0; k < (fuse ? n - 2 : n); k++) {
+      GenInst(insts[k], next);
+    }
+    if (fuse) {
+      GenCompareBranch(insts[n - 2], insts[n - 1], next);
+    }
+  }
+  Epilogue();
+}
+
+void IRCodeGenerator::GenBinary(const IRInst& inst) {
+  // indexed from IR_ADD to IR_XOR, division has its own lowering.
+  static const AsmOp ops[] = {I_ADD, I_SUB, I_IMUL, I_END, I_END, I_AND, I_OR, I_XOR};
+  AsmOp op = ops[inst.op - IR_ADD];
+  AsmReg r = DstReg(inst.dst);
+  if (inst.b < 0 && inst.op == IR_MUL) {
+    AsmOperand a = Loc(inst.a);
+    if (a.kind != AsmOperand::OPD_REG || a.reg != r) {
+      Emit(I_MOV, Reg(r), a);
+    }
+    if (!StrengthReduce::Mul(out, r, inst.imm, inst.size)) {
+      // imul has no register, immediate form here.
+      Emit(I_MOV, Reg(REG_R11), Imm(inst.imm));
+      Emit(I_IMUL, Reg(r, inst.size), Reg(REG_R11, inst.size));
+    }
+    WriteBack(inst.dst, r);
+    return;
+  }
+
+  AsmOperand b = Operand(inst, REG_R11);
+  // don't overwrite b before it is read, unless the operands can swap.
+  if (b.kind == AsmOperand::OPD_REG && b.reg == r && inst.a != inst.b) {
+    if (inst.op != IR_SUB) {
+      Emit(op, Reg(r, inst.size), InReg(inst.a, REG_AX, inst.size));
+      WriteBack(inst.dst, r);
+      return;
+    }
+    r = REG_AX;
+  }
+  AsmOperand a = Loc(inst.a);
+  if (a.kind != AsmOperand::OPD_REG || a.reg != r) {
+    Emit(I_MOV, Reg(r), a);
+  }
+  Emit(op, Reg(r, inst.size), b);
+  WriteBack(inst.dst, r);
+}
+
+void IRCodeGenerator::GenDivMod(const IRInst& inst) {
+  Emit(I_MOV, Reg(REG_AX), Loc(inst.a));
+  if (inst.b < 0 && StrengthReduce::DivMod(out, inst.imm, inst.size, inst.op == IR_MOD)) {
+    WriteBack(inst.dst, REG_AX);
+    return;
+  }
+  AsmOperand divisor;
+  if (inst.b < 0) {
+    Emit(I_MOV, Reg(REG_R11), Imm(inst.imm));
+    divisor = Reg(REG_R11, inst.size);
+  } else {
+    divisor = InReg(inst.b, REG_R11, inst.size);
+  }
+  Emit(inst.size == 8 ? I_CQO : I_CDQ);
+  Emit(I_IDIV, divisor);
+  WriteBack(inst.dst, inst.op == IR_DIV ? REG_AX : REG_DX);
+}
+
+void IRCodeGenerator::GenShift(const IRInst& inst) {
+  Emit(I_MOV, Reg(REG_CX), inst.b < 0 ? Imm(inst.imm) : Loc(inst.b));
+  AsmReg r = DstReg(inst.dst);
+  AsmOperand a = Loc(inst.a);
+  if (a.kind != AsmOperand::OPD_REG || a.reg != r) {
+    Emit(I_MOV, Reg(r), a);
+  }
+  Emit(inst.op == IR_SHL ? I_SHL : I_SAR, Reg(r, inst.size), Reg(REG_CX, 1));
+  WriteBack(inst.dst, r);
+}
+
+void IRCodeGenerator::GenCompare(const IRInst& inst) {
+  static const AsmOp setcc[] = {I_SETE, I_SETNE, I_SETL, I_SETLE};
+  AsmOperand a = InReg(inst.a, REG_AX, inst.size);
+  Emit(I_CMP, a, Operand(inst, REG_R11));
+  AsmReg r = DstReg(inst.dst);
+  Emit(setcc[inst.op - IR_EQ], Reg(r, 1));
+  Emit(I_MOVZX, Reg(r), Reg(r, 1));
+  WriteBack(inst.dst, r);
+}
+
+void IRCodeGenerator::GenCall(const IRInst& inst) {
+  // move the arguments straight into their registers unless one of them is
+  // held in an argument register written before it is read.
+  bool direct = true;
+  for (size_t i = 0; i < inst.args.size(); i++) {
+    const VRegLoc& loc = ra.locs[inst.args[i]];
+    for (size_t j = 0; j < i; j++) {
+      direct &= loc.IsSpilled() || loc.reg != argreg[j];
+    }
+  }
+  if (direct) {
+    for (size_t i = 0; i < inst.args.size(); i++) {
+      if (ra.locs[inst.args[i]].IsSpilled() || ra.locs[inst.args[i]].reg != argreg[i]) {
+        Emit(I_MOV, Reg(argreg[i]), Loc(inst.args[i]));
+      }
+    }
+  } else {
+    for (VReg v : inst.args) {
+      Emit(I_PUSH, InReg(v, REG_AX));
+    }
+    for (int i = inst.args.size() - 1; i >= 0; i--) {
+      Emit(I_POP, Reg(argreg[i]));
+    }
+  }
+  Emit(I_MOV, Reg(REG_AX), Imm(0));
+  Emit(I_CALL, Label(LB_SYMBOL, *inst.name));
+  WriteBack(inst.dst, REG_AX);
+}
+
+void IRCodeGenerator::GenBranch(const IRInst& inst, int next) {
+  Emit(I_CMP, InReg(inst.a, REG_AX), Imm(0));
+  AsmOperand then = Label(LB_UNIQUE, f.blocks[inst.then].label);
+  AsmOperand els = Label(LB_UNIQUE, f.blocks[inst.els].label);
+  if (inst.then == next) {
+    Emit(I_JE, els);
+    return;
+  }
+  Emit(I_JNE, then);
+  if (inst.els != next) {
+    Emit(I_JMP, els);
+  }
+}
+
+void IRCodeGenerator::GenSwitch(const IRInst& inst) {
+  std::vector<AsmOperand> targets;
+  for (int b : inst.table) {
+    targets.push_back(Label(LB_UNIQUE, f.blocks[b].label));
+  }
+  SwitchLowering::EmitTable(out, InReg(inst.a, REG_AX, inst.size), inst.size, inst.imm, targets,
+                            Label(LB_UNIQUE, f.blocks[inst.els].label), REG_R11, CreateUniqueId());
+}
+
+void IRCodeGenerator::GenCompareBranch(const IRInst& cmp, const IRInst& br, int next) {
+  // indexed from IR_EQ to IR_LE.
+  static const AsmOp holds[] = {I_JE, I_JNE, I_JL, I_JLE};
+  static const AsmOp fails[] = {I_JNE, I_JE, I_JGE, I_JG};
+  Emit(I_CMP, InReg(cmp.a, REG_AX, cmp.size), Operand(cmp, REG_R11));
+  AsmOperand then = Label(LB_UNIQUE, f.blocks[br.then].label);
+  AsmOperand els = Label(LB_UNIQUE, f.blocks[br.els].label);
+  if (br.then == next) {
+    Emit(fails[cmp.op - IR_EQ], els);
+    return;
+  }
+  Emit(holds[cmp.op - IR_EQ], then);
+  if (br.els != next) {
+    Emit(I_JMP, els);
+  }
+}
+
+void IRCodeGenerator::GenInst(const IRInst& inst, int next) {
+  switch (inst.op) {
+    case IR_IMM: {
+      AsmReg r = DstReg(inst.dst);
+      Emit(I_MOV, Reg(r), Imm(inst.imm));
+      WriteBack(inst.dst, r);
+      return;
+    }
+    case IR_MOV: {
+      AsmOperand src = Loc(inst.a);
+      if (src.kind == AsmOperand::OPD_MEM) {
+        src = InReg(inst.a, DstReg(inst.dst));
+      }
+      WriteBack(inst.dst, src.reg);
+      return;
+    }
+    case IR_LOCAL_ADDR:
+    case IR_GLOBAL_ADDR: {
+      AsmReg r = DstReg(inst.dst);
+      Emit(I_LEA, Reg(r),
+           inst.op == IR_LOCAL_ADDR ? Mem(REG_BP, -inst.imm) : RipMem(*inst.name));
+      WriteBack(inst.dst, r);
+      return;
+    }
+    case IR_LOAD: {
+      AsmReg addr = InReg(inst.a, REG_R11).reg;
+      AsmReg r = DstReg(inst.dst);
+      if (inst.size == 8) {
+        Emit(I_MOV, Reg(r), Mem(addr));
+      } else if (inst.size == 4) {
+        Emit(I_MOVSXD, Reg(r), Mem(addr, 0, 4));
+      } else {
+        Emit(I_MOVSX, Reg(r, 4), Mem(addr, 0, inst.size));
+      }
+      WriteBack(inst.dst, r);
+      return;
+    }
+    case IR_STORE: {
+      AsmReg addr = InReg(inst.a, REG_R11).reg;
+      Emit(I_MOV, Mem(addr, 0, inst.size), InReg(inst.b, REG_AX, inst.size));
+      return;
+    }
+    case IR_COPY: {
+      if (inst.imm <= kUnrolledCopyMax) {
+        AsmReg dst = InReg(inst.a, REG_DX).reg;
+        AsmReg src = InReg(inst.b, REG_AX).reg;
+        EmitCopy(out, dst, src, inst.imm, REG_R11);
+        return;
+      }
+      // rsi and rdi may be allocated, save them around the rep movsb.
+      Emit(I_MOV, Reg(REG_DX), Loc(inst.a));
+      Emit(I_MOV, Reg(REG_AX), Loc(inst.b));
+      Emit(I_PUSH, Reg(REG_SI));
+      Emit(I_PUSH, Reg(REG_DI));
+      Emit(I_MOV, Reg(REG_DI), Reg(REG_DX));
+      Emit(I_MOV, Reg(REG_SI), Reg(REG_AX));
+      Emit(I_MOV, Reg(REG_CX, 4), Imm(inst.imm));
+      Emit(I_REP_MOVSB);
+      Emit(I_POP, Reg(REG_DI));
+      Emit(I_POP, Reg(REG_SI));
+      return;
+    }
+    case IR_ADD:
+    case IR_SUB:
+    case IR_MUL:
+    case IR_AND:
+    case IR_OR:
+    case IR_XOR:
+      GenBinary(inst);
+      return;
+    case IR_DIV:
+    case IR_MOD:
+      GenDivMod(inst);
+      return;
+    case IR_SHL:
+    case IR_SAR:
+      GenShift(inst);
+      return;
+    case IR_EQ:
+    case IR_NE:
+    case IR_LT:
+    case IR_LE:
+      GenCompare(inst);
+      return;
+    case IR_NEG:
+    case IR_BITNOT: {
+      AsmReg r = DstReg(inst.dst);
+      AsmOperand a = Loc(inst.a);
+      if (a.kind != AsmOperand::OPD_REG || a.reg != r) {
+        Emit(I_MOV, Reg(r), a);
+      }
+      Emit(inst.op == IR_NEG ? I_NEG : I_NOT, Reg(r));
+      WriteBack(inst.dst, r);
+      return;
+    }
+    case IR_NOT:
+    case IR_BOOL: {
+      Emit(I_CMP, InReg(inst.a, REG_AX, inst.op == IR_NOT ? 8 : inst.size), Imm(0));
+      AsmReg r = DstReg(inst.dst);
+      Emit(inst.op == IR_NOT ? I_SETE : I_SETNE, Reg(r, 1));
+      Emit(I_MOVZX, Reg(r), Reg(r, 1));
+      WriteBack(inst.dst, r);
+      return;
+    }
+    case IR_SEXT: {
+      AsmOperand src = InReg(inst.a, REG_AX, inst.size);
+      AsmReg r = DstReg(inst.dst);
+      if (inst.size == 4) {
+        Emit(I_MOVSXD, Reg(r), src);
+      } else {
+        Emit(I_MOVSX, Reg(r, 4), src);
+      }
+      WriteBack(inst.dst, r);
+      return;
+    }
+    case IR_CALL:
+      GenCall(inst);
+      return;
+    case IR_JMP:
+      if (inst.then != next) {
+        Emit(I_JMP, Label(LB_UNIQUE, f.blocks[inst.then].label));
+      }
+      return;
+    case IR_BR:
+      GenBranch(inst, next);
+      return;
+    case IR_SWITCH:
+      GenSwitch(inst);
+      return;
+    case IR_RET:
+      if (inst.a >= 0) {
+        Emit(I_MOV, Reg(REG_AX), Loc(inst.a));
+      }
+      if (next >= 0) {
+        Emit(I_JMP, Label(LB_RETURN, *f.name));
+      }
+      return;
+    default:
+      unreachable();
+  }
+}
@@ -0,0 +1,67 @@
+/*
+ * This project is exclusively owned by QingChuanWS and shall not be used for
+ * commercial and profitting purpose without QingChuanWS's permission.
+ *
+ * @ Author: bingshan45@163.com
+ * @ Github: https://github.com/QingChuanWS
+ * @ Description:
+ *
+ * Copyright (c) 2023 by QingChuanWS, All Rights Reserved.
+ */
+
+#ifndef IR_CODEGEN_GRUAD
+#define IR_CODEGEN_GRUAD
+
+#include <vector>
+
+#include "asm_inst.h"
+#include "ir.h"
+#include "regalloc.h"
+
+// Lower a register allocated IR function to x86-64 instructions.
+//
+// Spilled operands are reloaded into rax or r11 around each instruction, so
+// every instruction has at most one memory operand.
+class IRCodeGenerator {
+ public:
+  IRCodeGenerator(const IRFunction& f, const RegAllocResult& ra, AsmBuffer& out)
+      : f(f), ra(ra), out(out) {}
+  // emit the function body between its label and the return label.
+  void Gen();
+
+ private:
+  void Emit(AsmOp op, const AsmOperand& dst = AsmOperand(), const AsmOperand& src = AsmOperand()) {
+    out.push_back({op, dst, src});
+  }
+  // the register or stack slot of v.
+  AsmOperand Loc(VReg v, int size = 8) const;
+  // v in a register, reloaded into scratch if it is spilled.
+  AsmOperand InReg(VReg v, AsmReg scratch, int size = 8);
+  // the second operand of a binary operation.
+  AsmOperand Operand(const IRInst& inst, AsmReg scratch);
+  // the register to compute v in, rax if v is spilled.
+  AsmReg DstReg(VReg v) const;
+  // store a result computed in reg to v.
+  void WriteBack(VReg v, AsmReg reg);
+  void Prologue();
+  void Epilogue();
+  // next is the block emitted after the current one, -1 for none.
+  void GenInst(const IRInst& inst, int next);
+  void GenBinary(const IRInst& inst);
+  void GenDivMod(const IRInst& inst);
+  void GenShift(const IRInst& inst);
+  void GenCompare(const IRInst& inst);
+  void GenCall(const IRInst& inst);
+  void GenBranch(const IRInst& inst, int next);
+  void GenSwitch(const IRInst& inst);
+  // a compare read by nothing but the branch after it sets the flags for it.
+  void GenCompareBranch(const IRInst& cmp, const IRInst& br, int next);
+
+  const IRFunction& f;
+  const RegAllocResult& ra;
+  AsmBuffer& out;
+  // number of reads of each virtual register.
+  std::vector<int> uses{};
+};
+
+#endif  // !IR_CODEGEN_GRUAD
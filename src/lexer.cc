@@ -0,0 +1,207 @@
+/*
+ * This project is exclusively owned by QingChuanWS and shall not be used for
+ * commercial and profitting purpose without QingChuanWS's permission.
+ *
+ * @ Author: bingshan45@163.com
+ * @ Github: https://github.com/QingChuanWS
+ * @ Description:
+ *
+ * Copyright (c) 2023 by QingChuanWS, All Rights Reserved.
+ */
+
+#include "lexer.h"
+
+#include <cstdint>
+
+#if defined(__x86_64__)
+#include <immintrin.h>
+#endif
+
+static inline bool IsHorizontalSpace(const char c) {
+  return c == ' ' || c == '\t' || c == '\v' || c == '\f' || c == '\r';
+}
+
+static inline bool IsIdentChar(const char c) {
+  return ('a' <= c && c <= 'z') || ('A' <= c && c <= 'Z') || ('0' <= c && c <= '9') || c == '_';
+}
+
+static const char* ScalarSkipSpace(const char* p) {
+  while (IsHorizontalSpace(*p)) {
+    p++;
+  }
+  return p;
+}
+
+static const char* ScalarSkipIdent(const char* p) {
+  while (IsIdentChar(*p)) {
+    p++;
+  }
+  return p;
+}
+
+static const char* ScalarFindCommentEnd(const char* p) {
+  for (; *p != '\0'; p++) {
+    if (p[0] == '*' && p[1] == '/') {
+      return p;
+    }
+  }
+  return nullptr;
+}
+
+const ScanKernels scalar_kernels = {"scalar", ScalarSkipSpace, ScalarSkipIdent,
+                                    ScalarFindCommentEnd};
+
+#if defined(__x86_64__)
+
+// ---- SSE2, part of the x86-64 baseline ----
+
+// bytes of v in the range [lo, hi], using a wrapping add to move the range to
+// the bottom of the signed byte range.
+static inline __m128i InRange16(__m128i v, char lo, char hi) {
+  __m128i shifted = _mm_add_epi8(v, _mm_set1_epi8(static_cast<char>(128 - lo)));
+  return _mm_cmplt_epi8(shifted, _mm_set1_epi8(static_cast<char>(-128 + (hi - lo + 1))));
+}
+
+static inline __m128i SpaceMask16(__m128i v) {
+  __m128i sp = _mm_cmpeq_epi8(v, _mm_set1_epi8(' '));
+  __m128i ctrl = InRange16(v, '\t', '\r');
+  __m128i nl = _mm_cmpeq_epi8(v, _mm_set1_epi8('\n'));
+  return _mm_or_si128(sp, _mm_andnot_si128(nl, ctrl));
+}
+
+static inline __m128i IdentMask16(__m128i v) {
+  __m128i alpha = InRange16(_mm_or_si128(v, _mm_set1_epi8(0x20)), 'a', 'z');
+  __m128i digit = InRange16(v, '0', '9');
+  __m128i under = _mm_cmpeq_epi8(v, _mm_set1_epi8('_'));
+  return _mm_or_si128(_mm_or_si128(alpha, digit), under);
+}
+
+static const char* Sse2SkipSpace(const char* p) {
+  for (;; p += 16) {
+    __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+    uint32_t stop = ~_mm_movemask_epi8(SpaceMask16(v)) & 0xffff;
+    if (stop) {
+      return p + __builtin_ctz(stop);
+    }
+  }
+}
+
+static const char* Sse2SkipIdent(const char* p) {
+  for (;; p += 16) {
+    __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+    uint32_t stop = ~_mm_movemask_epi8(IdentMask16(v)) & 0xffff;
+    if (stop) {
+      return p + __builtin_ctz(stop);
+    }
+  }
+}
+
+static const char* Sse2FindCommentEnd(const char* p) {
+  for (;; p += 16) {
+    __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+    __m128i next = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + 1));
+    __m128i end = _mm_and_si128(_mm_cmpeq_epi8(v, _mm_set1_epi8('*')),
+                                _mm_cmpeq_epi8(next, _mm_set1_epi8('/')));
+    __m128i nul = _mm_cmpeq_epi8(v, _mm_setzero_si128());
+    uint32_t hit = _mm_movemask_epi8(_mm_or_si128(end, nul));
+    if (hit) {
+      const char* q = p + __builtin_ctz(hit);
+      return *q == '\0' ? nullptr : q;
+    }
+  }
+}
+
+const ScanKernels sse2_kernels = {"sse2", Sse2SkipSpace, Sse2SkipIdent, Sse2FindCommentEnd};
+
+// ---- AVX2, selected at runtime ----
+
+#define AVX2_TARGET __attribute__((target("avx2")))
+
+AVX2_TARGET static inline __m256i InRange32(__m256i v, char lo, char hi) {
+  __m256i shifted = _mm256_add_epi8(v, _mm256_set1_epi8(static_cast<char>(128 - lo)));
+  return _mm256_cmpgt_epi8(_mm256_set1_epi8(static_cast<char>(-128 + (hi - lo + 1))), shifted);
+}
+
+AVX2_TARGET static inline __m256i SpaceMask32(__m256i v) {
+  __m256i sp = _mm256_cmpeq_epi8(v, _mm256_set1_epi8(' '));
+  __m256i ctrl = InRange32(v, '\t', '\r');
+  __m256i nl = _mm256_cmpeq_epi8(v, _mm256_set1_epi8('\n'));
+  return _mm256_or_si256(sp, _mm256_andnot_si256(nl, ctrl));
+}
+
+AVX2_TARGET static inline __m256i IdentMask32(__m256i v) {
+  __m256i alpha = InRange32(_mm256_or_si256(v, _mm256_set1_epi8(0x20)), 'a', 'z');
+  __m256i digit = InRange32(v, '0', '9');
+  __m256i under = _mm256_cmpeq_epi8(v, _mm256_set1_epi8('_'));
+  return _mm256_or_si256(_mm256_or_si256(alpha, digit), under);
+}
+
+AVX2_TARGET static const char* Avx2SkipSpace(const char* p) {
+  // most runs are shorter than 16 bytes, probe them with a single SSE2 block.
+  __m128i head = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+  uint32_t head_stop = ~_mm_movemask_epi8(SpaceMask16(head)) & 0xffff;
+  if (head_stop) {
+    return p + __builtin_ctz(head_stop);
+  }
+  for (p += 16;; p += 32) {
+    __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+    uint32_t stop = ~static_cast<uint32_t>(_mm256_movemask_epi8(SpaceMask32(v)));
+    if (stop) {
+      return p + __builtin_ctz(stop);
+    }
+  }
+}
+
+AVX2_TARGET static const char* Avx2SkipIdent(const char* p) {
+  // most runs are shorter than 16 bytes, probe them with a single SSE2 block.
+  __m128i head = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+  uint32_t head_stop = ~_mm_movemask_epi8(IdentMask16(head)) & 0xffff;
+  if (head_stop) {
+    return p + __builtin_ctz(head_stop);
+  }
+  for (p += 16;; p += 32) {
+    __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+    uint32_t stop = ~static_cast<uint32_t>(_mm256_movemask_epi8(IdentMask32(v)));
+    if (stop) {
+      return p + __builtin_ctz(stop);
+    }
+  }
+}
+
+AVX2_TARGET static const char* Avx2FindCommentEnd(const char* p) {
+  for (;; p += 32) {
+    __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+    __m256i next = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p + 1));
+    __m256i end = _mm256_and_si256(_mm256_cmpeq_epi8(v, _mm256_set1_epi8('*')),
+                                   _mm256_cmpeq_epi8(next, _mm256_set1_epi8('/')));
+    __m256i nul = _mm256_cmpeq_epi8(v, _mm256_setzero_si256());
+    uint32_t hit = static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_or_si256(end, nul)));
+    if (hit) {
+      const char* q = p + __builtin_ctz(hit);
+      return *q == '\0' ? nullptr : q;
+    }
+  }
+}
+
+#undef AVX2_TARGET
+
+const ScanKernels avx2_kernels = {"avx2", Avx2SkipSpace, Avx2SkipIdent, Avx2FindCommentEnd};
+
+static const ScanKernels& SelectScanKernels() {
+  __builtin_cpu_init();
+  if (__builtin_cpu_supports("avx2")) {
+    return avx2_kernels;
+  }
+  return sse2_kernels;
+}
+
+#else
+
+const ScanKernels sse2_kernels = {nullptr, ScalarSkipSpace, ScalarSkipIdent, ScalarFindCommentEnd};
+const ScanKernels avx2_kernels = {nullptr, ScalarSkipSpace, ScalarSkipIdent, ScalarFindCommentEnd};
+
+static const ScanKernels& SelectScanKernels() { return scalar_kernels; }
+
+#endif
+
+const ScanKernels& scan_kernels = SelectScanKernels();
@@ -0,0 +1,210 @@
+/*
+ * This project is exclusively owned by QingChuanWS and shall not be used for
+ * commercial and profitting purpose without QingChuanWS's permission.
+ *
+ * @ Author: bingshan45@163.com
+ * @ Github: https://github.com/QingChuanWS
+ * @ Description:
+ *
+ * Copyright (c) 2023 by QingChuanWS, All Rights Reserved.
+ */
+
+#ifndef LEXER_GRUAD
+#define LEXER_GRUAD
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+// Reserved keyword, the order is the same as `keyword_str`.
+enum KeywordKind {
+  KW_RETURN,
+  KW_IF,
+  KW_ELSE,
+  KW_FOR,
+  KW_WHILE,
+  KW_INT,
+  KW_SIZEOF,
+  KW_CHAR,
+  KW_STRUCT,
+  KW_UNION,
+  KW_SHORT,
+  KW_LONG,
+  KW_VOID,
+  KW_TYPEDEF,
+  KW_BOOL,
+  KW_ENUM,
+  KW_STATIC,
+  KW_GOTO,
+  KW_BREAK,
+  KW_CONTINUE,
+  KW_SWITCH,
+  KW_CASE,
+  KW_DEFAULT,
+  KW_END,
+};
+
+constexpr const char* keyword_str[KW_END] = {
+    "return", "if", "else", "for", "while", "int", "sizeof", "char",
+    "struct", "union", "short", "long", "void", "typedef", "_Bool", "enum",
+    "static", "goto", "break", "continue", "switch", "case", "default"};
+
+// keywords that start a type name.
+constexpr uint32_t typename_keywords = 1u << KW_VOID | 1u << KW_CHAR | 1u << KW_SHORT |
+                                       1u << KW_INT | 1u << KW_LONG | 1u << KW_STRUCT |
+                                       1u << KW_UNION | 1u << KW_TYPEDEF | 1u << KW_BOOL |
+                                       1u << KW_ENUM | 1u << KW_STATIC;
+
+// Perfect hash of the keywords keyed on the length and the first and last
+// character. The table is generated at compile time and the static_assert
+// below rejects any keyword list that makes two keywords collide.
+constexpr int kKeywordSlots = 64;
+
+constexpr int KeywordHash(const char* s, int len) {
+  return (static_cast<uint8_t>(s[0]) + static_cast<uint8_t>(s[len - 1]) + (len << 2)) &
+         (kKeywordSlots - 1);
+}
+
+struct KeywordTable {
+  // keyword kind of each hash slot, KW_END for a empty slot.
+  int8_t kind[kKeywordSlots];
+  // keyword length of each keyword kind.
+  int8_t len[KW_END];
+  // whether two keywords are hashed to the same slot.
+  bool collision;
+};
+
+constexpr KeywordTable CreateKeywordTable() {
+  KeywordTable t{};
+  for (int i = 0; i < kKeywordSlots; i++) {
+    t.kind[i] = KW_END;
+  }
+  for (int k = 0; k < KW_END; k++) {
+    int len = 0;
+    while (keyword_str[k][len] != '\0') {
+      len++;
+    }
+    int slot = KeywordHash(keyword_str[k], len);
+    if (t.kind[slot] != KW_END) {
+      t.collision = true;
+    }
+    t.kind[slot] = k;
+    t.len[k] = len;
+  }
+  return t;
+}
+
+constexpr KeywordTable keyword_table = CreateKeywordTable();
+static_assert(!keyword_table.collision, "keyword hash is not perfect.");
+
+// classify the identifier [s, s + len) with a single probe,
+// return KW_END if it is not a keyword.
+inline KeywordKind FindKeyword(const char* s, int len) {
+  int k = keyword_table.kind[KeywordHash(s, len)];
+  if (k == KW_END || keyword_table.len[k] != len || memcmp(s, keyword_str[k], len) != 0) {
+    return KW_END;
+  }
+  return static_cast<KeywordKind>(k);
+}
+
+// Punctuators longer than one character.
+constexpr const char* punct_str[] = {"<<=", ">>=", ">=", "==", "!=", "<=", "->",
+                                     "+=",  "-=",  "*=", "/=", "++", "--", "%=",
+                                     "&=",  "|=",  "^=", "&&", "||", "<<", ">>"};
+
+// Maximal-munch punctuator table.
+//
+// `row` maps the first character to a row of `follow`, row 0 means the
+// character is a punctuator but nothing longer starts with it. `follow`
+// maps the second character to the punctuator length:
+//   0: only the first character is a punctuator,
+//   2: the first two characters are a punctuator,
+//   3: the first two characters are a punctuator, and so are the first
+//      three if the third one is '='.
+constexpr int kPunctRows = 16;
+
+struct PunctTable {
+  bool punct[256];
+  uint8_t row[256];
+  uint8_t follow[kPunctRows][256];
+  // number of rows used.
+  int rows;
+};
+
+constexpr bool IsPunctChar(int c) {
+  return (33 <= c && c <= 47) || (58 <= c && c <= 64) || (91 <= c && c <= 96) ||
+         (123 <= c && c <= 126);
+}
+
+constexpr PunctTable CreatePunctTable() {
+  PunctTable t{};
+  t.rows = 1;
+  for (int c = 0; c < 256; c++) {
+    t.punct[c] = IsPunctChar(c);
+  }
+  for (const char* op : punct_str) {
+    auto c1 = static_cast<uint8_t>(op[0]);
+    auto c2 = static_cast<uint8_t>(op[1]);
+    if (t.row[c1] == 0) {
+      t.row[c1] = t.rows++;
+    }
+    uint8_t& f = t.follow[t.row[c1]][c2];
+    if (op[2] == '\0') {
+      f = f == 3 ? 3 : 2;
+    } else {
+      f = 3;
+    }
+  }
+  return t;
+}
+
+constexpr PunctTable punct_table = CreatePunctTable();
+static_assert(punct_table.rows <= kPunctRows, "too many punctuator rows.");
+
+// read a punctuator at p and return its length, return 0 if p is not a punctuator.
+inline int ReadPunct(const char* p) {
+  const auto c1 = static_cast<uint8_t>(p[0]);
+  const uint8_t row = punct_table.row[c1];
+  if (row == 0) {
+    return punct_table.punct[c1] ? 1 : 0;
+  }
+  switch (punct_table.follow[row][static_cast<uint8_t>(p[1])]) {
+    case 2:
+      return 2;
+    case 3:
+      return p[2] == '=' ? 3 : 2;
+    default:
+      return 1;
+  }
+}
+
+// Scanner kernels. Every kernel may read up to 33 bytes past the position it
+// stops at, so the input must be terminated by '\0' and followed by at least
+// kScanPadding readable bytes.
+constexpr size_t kScanPadding = 64;
+
+struct ScanKernels {
+  // kernel set name.
+  const char* name;
+  // skip ' ', '\t', '\v', '\f' and '\r', stop at '\n' or any other character.
+  const char* (*skip_space)(const char* p);
+  // skip identifier characters [a-zA-Z0-9_].
+  const char* (*skip_ident)(const char* p);
+  // find the "*/" closing a block comment, return nullptr if '\0' comes first.
+  const char* (*find_comment_end)(const char* p);
+};
+
+// byte-at-a-time kernels, available on every target.
+extern const ScanKernels scalar_kernels;
+// 16 bytes at a time kernels, nullptr name if the target isn't x86-64.
+extern const ScanKernels sse2_kernels;
+// 32 bytes at a time kernels, nullptr name if the target isn't x86-64.
+extern const ScanKernels avx2_kernels;
+// the best kernels supported by the running cpu, selected once via cpuid.
+extern const ScanKernels& scan_kernels;
+
+inline const char* SkipSpace(const char* p) { return scan_kernels.skip_space(p); }
+inline const char* SkipIdent(const char* p) { return scan_kernels.skip_ident(p); }
+inline const char* FindCommentEnd(const char* p) { return scan_kernels.find_comment_end(p); }
+
+#endif  // LEXER_GRUAD
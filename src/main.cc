@@ -18,6 +18,7 @@
 #include <ostream>
 
 #include "codegen.h"
+#include "inline.h"
 #include "node.h"
 #include "object.h"
 #include "parser.h"
@@ -31,10 +32,16 @@ int main(int argc, char** argv) {
   TokenPtr cur = Token::TokenizeFile(cfg.input_path);
   // parse token list generate AST.
   ASTree astree = Parser::Run(cur);
+  // replace the calls of small static functions by their bodies.
+  Inliner(cfg.inline_limit).Run(astree);
   // config code generator.
   CodeGenerator gene(cfg);
   // generate source code.
   gene.CodeGen(astree);
+  // report the IR memory usage.
+  if (cfg.mem_report) {
+    Node::MemReport();
+  }
 
   return 0;
 }
@@ -14,6 +14,7 @@
 #include <cstdarg>
 #include <cstddef>
 #include <cstdint>
+#include <cstdio>
 #include <cstring>
 #include <memory>
 
@@ -29,6 +30,54 @@ NodePtrVec label_list{};
 
 NodePtr cur_swt = nullptr;
 
+// number of nodes and node payloads, for the memory report.
+static size_t node_cnt = 0;
+static size_t ext_cnt = 0;
+
+Node::Node(NodeKind kind, TokenPtr tok) : kind(kind), name(tok) { node_cnt++; }
+
+NodeExt::NodeExt() { ext_cnt++; }
+
+NodePtr Node::CreateExtNode(NodeKind kind, TokenPtr node_name) {
+  auto res = MakeIR<Node>(kind, node_name);
+  res->ext = MakeIR<NodeExt>();
+  return res;
+}
+
+void Node::MemReport() {
+  size_t bytes = node_cnt * sizeof(Node) + ext_cnt * sizeof(NodeExt);
+  fprintf(stderr, "nodes: %zu x %zu bytes\n", node_cnt, sizeof(Node));
+  fprintf(stderr, "node payloads: %zu x %zu bytes\n", ext_cnt, sizeof(NodeExt));
+  fprintf(stderr, "bytes per node: %.1f\n", node_cnt ? static_cast<double>(bytes) / node_cnt : 0.0);
+}
+
+void Node::NumberTree(const NodePtr& node, int& counter,
+                      std::unordered_map<const Node*, std::pair<int, int>>& ranges) {
+  if (node == nullptr) {
+    return;
+  }
+  int begin = counter++;
+  NumberTree(node->lhs, counter, ranges);
+  NumberTree(node->rhs, counter, ranges);
+  if (node->ext != nullptr) {
+    for (NodePtr n = node->ext->body; n != nullptr; n = n->next) {
+      NumberTree(n, counter, ranges);
+    }
+    for (NodePtr n = node->ext->args; n != nullptr; n = n->next) {
+      NumberTree(n, counter, ranges);
+    }
+    NumberTree(node->ext->cond, counter, ranges);
+    NumberTree(node->ext->then, counter, ranges);
+    NumberTree(node->ext->els, counter, ranges);
+    NumberTree(node->ext->init, counter, ranges);
+    NumberTree(node->ext->inc, counter, ranges);
+  }
+  auto it = ranges.find(&*node);
+  if (it != ranges.end()) {
+    it->second = {begin, counter - 1};
+  }
+}
+
 void Node::Error(const char* fmt, ...) const {
   va_list ap;
   va_start(ap, fmt);
@@ -36,7 +85,7 @@ void Node::Error(const char* fmt, ...) const {
 }
 
 NodePtr Node::CreateConstNode(int64_t val, TokenPtr tok) {
-  auto node = std::make_shared<Node>(NodeKind::ND_NUM, tok);
+  auto node = MakeIR<Node>(NodeKind::ND_NUM, tok);
   node->val = val;
   return node;
 }
@@ -48,13 +97,13 @@ NodePtr Node::CreateLongConstNode(int64_t val, TokenPtr node_name) {
 }
 
 NodePtr Node::CreateVarNode(ObjectPtr var, TokenPtr tok) {
-  auto node = std::make_shared<Node>(NodeKind::ND_VAR, tok);
+  auto node = MakeIR<Node>(NodeKind::ND_VAR, tok);
   node->var = var;
   return node;
 }
 
 NodePtr Node::CreateIdentNode(TokenPtr tok) {
-  VarScopePtr sc = Scope::FindVarScope(tok->GetIdent());
+  VarScopePtr sc = Scope::FindVarScope(tok->GetSymbol());
   if (!sc || (!sc->var && !sc->IsEnum())) {
     tok->ErrorTok("undefined variable.");
   }
@@ -68,16 +117,15 @@ NodePtr Node::CreateIdentNode(TokenPtr tok) {
 }
 
 NodePtr Node::CreateCallNode(TokenPtr call_name, NodePtr args, TypePtr func_ty) {
-  auto call_node = std::make_shared<Node>(NodeKind::ND_CALL, call_name);
-  call_node->call = call_name->GetIdent();
-  call_node->args = args;
-  call_node->fun_ty = func_ty;
+  auto call_node = CreateExtNode(NodeKind::ND_CALL, call_name);
+  call_node->ext->args = args;
+  call_node->ext->fun_ty = func_ty;
   call_node->ty = func_ty->return_ty;
   return call_node;
 }
 
 NodePtr Node::CreateUnaryNode(NodeKind kind, TokenPtr node_name, NodePtr op) {
-  auto res = std::make_shared<Node>(kind, node_name);
+  auto res = MakeIR<Node>(kind, node_name);
   res->lhs = op;
   return res;
 }
@@ -134,7 +182,7 @@ NodePtr Node::CreateSubNode(TokenPtr node_name, NodePtr op_left, NodePtr op_righ
 
 NodePtr Node::CreateBinaryNode(NodeKind kind, TokenPtr node_name, NodePtr op_left,
                                NodePtr op_right) {
-  auto res = std::make_shared<Node>(kind, node_name);
+  auto res = MakeIR<Node>(kind, node_name);
   res->lhs = op_left;
   res->rhs = op_right;
   return res;
@@ -142,28 +190,28 @@ NodePtr Node::CreateBinaryNode(NodeKind kind, TokenPtr node_name, NodePtr op_lef
 
 NodePtr Node::CreateIfNode(NodeKind kind, TokenPtr node_name, NodePtr cond, NodePtr then,
                            NodePtr els) {
-  auto res = std::make_shared<Node>(kind, node_name);
-  res->cond = cond;
-  res->then = then;
-  res->els = els;
+  auto res = CreateExtNode(kind, node_name);
+  res->ext->cond = cond;
+  res->ext->then = then;
+  res->ext->els = els;
   return res;
 }
 
 NodePtr Node::CreateForNode(TokenPtr node_name, NodePtr init, NodePtr cond, NodePtr inc,
-                            NodePtr then, String brk_label, String cnt_label) {
-  auto res = std::make_shared<Node>(NodeKind::ND_FOR, node_name);
-  res->init = init;
-  res->cond = cond;
-  res->inc = inc;
-  res->then = then;
-  res->break_label = brk_label;
-  res->continue_label = cnt_label;
+                            NodePtr then, int brk_label, int cnt_label) {
+  auto res = CreateExtNode(NodeKind::ND_FOR, node_name);
+  res->ext->init = init;
+  res->ext->cond = cond;
+  res->ext->inc = inc;
+  res->ext->then = then;
+  res->ext->break_label = brk_label;
+  res->ext->continue_label = cnt_label;
   return res;
 }
 
 NodePtr Node::CreateBlockNode(NodeKind kind, TokenPtr node_name, NodePtr body) {
-  auto res = std::make_shared<Node>(kind, node_name);
-  res->body = body;
+  auto res = CreateExtNode(kind, node_name);
+  res->ext->body = body;
   return res;
 }
 
@@ -174,15 +222,16 @@ NodePtr Node::CreateMemberNode(NodePtr parent, TokenPtr node_name) {
     node_name->ErrorTok("not a struct.");
   }
 
-  NodePtr res = CreateUnaryNode(NodeKind::ND_MUMBER, node_name, parent);
-  res->mem = parent->ty->GetStructMember(node_name);
+  NodePtr res = CreateExtNode(NodeKind::ND_MUMBER, node_name);
+  res->lhs = parent;
+  res->ext->mem = parent->ty->GetStructMember(node_name);
   return res;
 }
 
 NodePtr Node::CreateCastNode(TokenPtr node_name, NodePtr expr, TypePtr ty) {
   Type::TypeInfer(expr);
 
-  auto res = std::make_shared<Node>(NodeKind::ND_CAST, node_name);
+  auto res = MakeIR<Node>(NodeKind::ND_CAST, node_name);
   res->lhs = expr;
   res->ty = ty;
   return res;
@@ -195,7 +244,8 @@ NodePtr Node::CreateCombinedNode(NodePtr binary, ObjectList& locals) {
   Type::TypeInfer(binary->rhs);
 
   TokenPtr root_name = binary->name;
-  // generate fresh pointer variable.
+  // generate fresh pointer variable, it is only used by the returned node.
+  size_t first = locals.size();
   ObjectPtr var = Object::CreateLocalVar("", Type::CreatePointerType(binary->lhs->ty), locals);
   // &A
   NodePtr lhs_addr = CreateUnaryNode(ND_ADDR, root_name, binary->lhs);
@@ -211,7 +261,9 @@ NodePtr Node::CreateCombinedNode(NodePtr binary, ObjectList& locals) {
   NodePtr compute = CreateBinaryNode(binary->kind, root_name, deref_rval, binary->rhs);
   // *tmp = *tmp op rhs.
   NodePtr expr2 = CreateBinaryNode(ND_ASSIGN, root_name, deref_lval, compute);
-  return CreateBinaryNode(ND_COMMON, root_name, expr1, expr2);
+  NodePtr res = CreateBinaryNode(ND_COMMON, root_name, expr1, expr2);
+  Object::SetScope(locals, first, res);
+  return res;
 }
 
 // Convert A++ to `(typeof A)(A += 1) -1`
@@ -227,22 +279,24 @@ NodePtr Node::CreateIncdecNode(TokenPtr name, NodePtr prefix, int addend, Object
   return CreateCastNode(name, sub, prefix->ty);
 }
 
-NodePtr Node::CreateGotoNode(TokenPtr label, String label_name, bool need_update) {
-  auto res = std::make_shared<Node>(ND_GOTO, label);
-  if (need_update) {
-    res->label = label_name;
-    goto_list.push_back(res);
-  } else {
-    res->unique_label = label_name;
-  }
+NodePtr Node::CreateGotoNode(TokenPtr label, SymbolPtr label_name) {
+  auto res = CreateExtNode(ND_GOTO, label);
+  res->ext->label = label_name;
+  goto_list.push_back(res);
+  return res;
+}
+
+NodePtr Node::CreateJumpNode(TokenPtr tok, int label) {
+  auto res = CreateExtNode(ND_GOTO, tok);
+  res->ext->unique_label = label;
   return res;
 }
 
 NodePtr Node::CreateGotoLableNode(TokenPtr label_name, NodePtr body) {
-  auto res = std::make_shared<Node>(ND_LABEL, label_name);
-  res->label = label_name->GetIdent();
-  res->unique_label = CreateUniqueName();
-  res->body = body;
+  auto res = CreateExtNode(ND_LABEL, label_name);
+  res->ext->label = label_name->GetSymbol();
+  res->ext->unique_label = CreateUniqueId();
+  res->ext->body = body;
   label_list.push_back(res);
   return res;
 }
@@ -255,12 +309,12 @@ NodePtr Node::CreateGotoLableNode(TokenPtr label_name, NodePtr body) {
 void Node::UpdateGotoLabel() {
   for (auto g : goto_list) {
     for (auto l : label_list) {
-      if (g->label == l->label) {
-        g->unique_label = l->unique_label;
+      if (g->ext->label == l->ext->label) {
+        g->ext->unique_label = l->ext->unique_label;
         break;
       }
     }
-    if (g->unique_label.empty()) {
+    if (g->ext->unique_label < 0) {
       Token::GetNext<1>(g->name)->ErrorTok("use of undeclared label.");
     }
   }
@@ -269,23 +323,23 @@ void Node::UpdateGotoLabel() {
 }
 
 NodePtr Node::CreateSwitchNode(TokenPtr node_name, NodePtr cond) {
-  NodePtr res = std::make_shared<Node>(ND_SWITCH, node_name);
-  res->cond = cond;
+  NodePtr res = CreateExtNode(ND_SWITCH, node_name);
+  res->ext->cond = cond;
   return res;
 }
 
 NodePtr Node::CreateCaseNode(TokenPtr node_name, int64_t val, NodePtr body) {
-  NodePtr res = std::make_shared<Node>(ND_CASE, node_name);
-  res->label = CreateUniqueName();
+  NodePtr res = CreateExtNode(ND_CASE, node_name);
+  res->ext->unique_label = CreateUniqueId();
   res->val = val;
-  res->body = body;
+  res->ext->body = body;
   return res;
 }
 
 NodePtr Node::CreateDefaultNode(TokenPtr node_name, NodePtr body) {
-  NodePtr res = std::make_shared<Node>(ND_CASE, node_name);
-  res->label = CreateUniqueName();
-  res->body = body;
+  NodePtr res = CreateExtNode(ND_CASE, node_name);
+  res->ext->unique_label = CreateUniqueId();
+  res->ext->body = body;
   return res;
 }
 
@@ -324,7 +378,7 @@ int64_t Node::Eval(NodePtr node) {
     case ND_LE:
       return Eval(node->lhs) <= Eval(node->rhs);
     case ND_COND:
-      return Eval(node->cond) ? Eval(node->then) : Eval(node->els);
+      return Eval(node->ext->cond) ? Eval(node->ext->then) : Eval(node->ext->els);
     case ND_COMMON:
       return Eval(node->rhs);
     case ND_NOT:
@@ -336,14 +390,18 @@ int64_t Node::Eval(NodePtr node) {
     case ND_LOGOR:
       return Eval(node->lhs) || Eval(node->rhs);
     case ND_CAST:
+      if (node->ty->Is<TY_BOOL>()) {
+        return Eval(node->lhs) != 0;
+      }
+      // the integer types are signed.
       if (node->ty->IsInteger()) {
         switch (node->ty->Size()) {
           case 1:
-            return (uint8_t)Eval(node->lhs);
+            return (int8_t)Eval(node->lhs);
           case 2:
-            return (uint16_t)Eval(node->lhs);
+            return (int16_t)Eval(node->lhs);
           case 4:
-            return (uint64_t)Eval(node->lhs);
+            return (int32_t)Eval(node->lhs);
         }
       }
       return Eval(node->lhs);
@@ -353,4 +411,111 @@ int64_t Node::Eval(NodePtr node) {
       node->name->ErrorTok("not a complier-time contant");
       return -1;
   }
-}
\ No newline at end of file
+}
+// the value the generated code holds for an integer of type ty.
+static int64_t Normalize(int64_t val, const TypePtr& ty) {
+  if (ty->Is<TY_BOOL>()) {
+    return val != 0;
+  }
+  switch (ty->Size()) {
+    case 1:
+      return static_cast<int8_t>(val);
+    case 2:
+      return static_cast<int16_t>(val);
+    case 4:
+      return static_cast<int32_t>(val);
+    default:
+      return val;
+  }
+}
+
+void Node::FoldConst(NodePtr& node) {
+  if (node == nullptr) {
+    return;
+  }
+  FoldConst(node->lhs);
+  FoldConst(node->rhs);
+  if (node->ext != nullptr) {
+    for (NodePtr* n = &node->ext->body; *n != nullptr; n = &(*n)->next) {
+      FoldConst(*n);
+    }
+    for (NodePtr* n = &node->ext->args; *n != nullptr; n = &(*n)->next) {
+      FoldConst(*n);
+    }
+    FoldConst(node->ext->cond);
+    FoldConst(node->ext->then);
+    FoldConst(node->ext->els);
+    FoldConst(node->ext->init);
+    FoldConst(node->ext->inc);
+  }
+  if (node->ty == nullptr) {
+    return;
+  }
+
+  auto is_num = [](const NodePtr& n) { return n != nullptr && n->kind == ND_NUM; };
+  auto replace = [&](NodePtr with) {
+    with->next = node->next;
+    node = with;
+  };
+  auto fold = [&](int64_t val) {
+    NodePtr num = CreateConstNode(Normalize(val, node->ty), node->name);
+    num->ty = node->ty;
+    replace(num);
+  };
+
+  switch (node->kind) {
+    case ND_COND:
+      // the branch not taken is dropped even if it isn't constant.
+      if (is_num(node->ext->cond)) {
+        replace(node->ext->cond->val ? node->ext->then : node->ext->els);
+      }
+      return;
+    case ND_COMMON:
+      if (is_num(node->lhs)) {
+        replace(node->rhs);
+      }
+      return;
+    case ND_LOGAND:
+    case ND_LOGOR:
+      // "0 && x" and "1 || x" don't evaluate x.
+      if (is_num(node->lhs) && (node->lhs->val != 0) == (node->kind == ND_LOGOR)) {
+        fold(node->kind == ND_LOGOR);
+      } else if (is_num(node->lhs) && is_num(node->rhs)) {
+        fold(Eval(node));
+      }
+      return;
+    case ND_DIV:
+    case ND_MOD:
+      // leave the traps and the INT64_MIN / -1 overflow to run time.
+      if (is_num(node->rhs) && (node->rhs->val == 0 || node->rhs->val == -1)) {
+        return;
+      }
+      break;
+    case ND_SHL:
+    case ND_SHR:
+      if (is_num(node->rhs) && (node->rhs->val < 0 || node->rhs->val > 63)) {
+        return;
+      }
+      break;
+    case ND_ADD:
+    case ND_SUB:
+    case ND_MUL:
+    case ND_EQ:
+    case ND_NE:
+    case ND_LT:
+    case ND_LE:
+    case ND_BITAND:
+    case ND_BITOR:
+    case ND_BITXOR:
+    case ND_NEG:
+    case ND_NOT:
+    case ND_BITNOT:
+    case ND_CAST:
+      break;
+    default:
+      return;
+  }
+  if (node->ty->IsInteger() && is_num(node->lhs) && (node->rhs == nullptr || is_num(node->rhs))) {
+    fold(Eval(node));
+  }
+}
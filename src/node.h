@@ -16,6 +16,8 @@
 #include <cstdint>
 #include <memory>
 #include <string>
+#include <unordered_map>
+#include <utility>
 
 #include "object.h"
 #include "struct.h"
@@ -66,20 +68,47 @@ enum NodeKind {
   ND_END,
 };
 
-// for rafactor
-class NodeObject {
-  NodeObject(NodeKind kind, TokenPtr tok) : kind(kind), name(tok) {}
+// Kind specific payload of the statement, call and member access nodes.
+// The far more common expression nodes never carry one, so only the
+// fields every node needs are kept in Node itself.
+struct NodeExt {
+  NodeExt();
 
- private:
-  // Node kind
-  NodeKind kind = NodeKind::ND_END;
-  // Representative node, node name
-  TokenPtr name = nullptr;
+  // block, statement expression, label or case body.
+  NodePtr body = nullptr;
+
+  // "if", "for", "switch" statement and "?:" expression.
+  NodePtr cond = nullptr;
+  NodePtr then = nullptr;
+  NodePtr els = nullptr;
+
+  // "for" statement
+  NodePtr init = nullptr;
+  NodePtr inc = nullptr;
+
+  // switch node
+  NodePtrVec case_nodes{};
+  NodePtr default_node = nullptr;
+
+  // struct member access.
+  MemberPtr mem = nullptr;
+
+  // ------ function ------;
+  TypePtr fun_ty = nullptr;
+  NodePtr args = nullptr;
+
+  // ----- goto ------;
+  // name of a goto target.
+  SymbolPtr label = nullptr;
+  // assembly label ids, see CreateUniqueId().
+  int break_label = -1;
+  int continue_label = -1;
+  int unique_label = -1;
 };
 
 class Node {
  public:
-  Node(NodeKind kind, TokenPtr tok) : kind(kind), name(tok) {}
+  Node(NodeKind kind, TokenPtr tok);
   // whether the node is point.
   inline bool IsPointerNode() const { return ty->Is<TY_PRT>(); }
   // whether the node is array node.
@@ -111,7 +140,7 @@ class Node {
                               NodePtr els);
   // create for expration node.
   static NodePtr CreateForNode(TokenPtr node_name, NodePtr init, NodePtr cond, NodePtr inc,
-                               NodePtr then, String brk_label, String cnt_label);
+                               NodePtr then, int brk_label, int cnt_label);
   // create block expression node.
   static NodePtr CreateBlockNode(NodeKind kind, TokenPtr node_name, NodePtr body);
   // create struct member node.
@@ -123,8 +152,10 @@ class Node {
   // create a post inc and dec node.
   static NodePtr CreateIncdecNode(TokenPtr node_name, NodePtr prefix, int addend,
                                   ObjectList& locals);
-  // create a goto node.
-  static NodePtr CreateGotoNode(TokenPtr label, String label_name, bool need_update = true);
+  // create a goto node to a named label.
+  static NodePtr CreateGotoNode(TokenPtr label, SymbolPtr label_name);
+  // create a goto node to an assembly label, for break and continue.
+  static NodePtr CreateJumpNode(TokenPtr tok, int label);
   // create a goto label node.
   static NodePtr CreateGotoLableNode(TokenPtr label, NodePtr body);
   // create a switch node.
@@ -137,12 +168,26 @@ class Node {
   static void UpdateGotoLabel();
   // for eval a constant node tree
   static int64_t Eval(NodePtr node);
+  // replace the constant integer subexpressions of a typed tree by numbers.
+  static void FoldConst(NodePtr& node);
+  // print the number and size of the nodes created so far.
+  static void MemReport();
+  // number the nodes of a tree in pre-order and record the range of numbers
+  // in the subtree of each node that has an entry in ranges.
+  static void NumberTree(const NodePtr& node, int& counter,
+                         std::unordered_map<const Node*, std::pair<int, int>>& ranges);
 
  private:
   friend class CodeGenerator;
+  friend class IRBuilder;
+  friend class Inliner;
   friend class Parser;
+  friend class SwitchLowering;
   friend class Type;
 
+  // create a node carrying a NodeExt payload.
+  static NodePtr CreateExtNode(NodeKind kind, TokenPtr node_name);
+
   // Node kind
   NodeKind kind = NodeKind::ND_END;
   // Representative node, node name
@@ -157,41 +202,14 @@ class Node {
   NodePtr lhs = nullptr;  // left-head side
   NodePtr rhs = nullptr;  // right-head side
 
-  // block or statment expression.
-  NodePtr body = nullptr;
-
-  // "if" statement
-  NodePtr cond = nullptr;
-  NodePtr then = nullptr;
-  NodePtr els = nullptr;
-
-  // "for" statement
-  NodePtr init = nullptr;
-  NodePtr inc = nullptr;
-  String break_label = "";     // break; label
-  String continue_label = "";  // continue label
-
-  // switch node
-  NodePtrVec case_nodes{};
-  NodePtr default_node = nullptr;
-
-  // struct member access.
-  MemberPtr mem = nullptr;
-
-  // ------ function ------;
-  String call = String();
-  TypePtr fun_ty = nullptr;
-  NodePtr args = nullptr;
-
-  // ----- goto ------;
-  String label = "";
-  String unique_label = "";
-
   //  ------  Var ------;
   ObjectPtr var = nullptr;
 
-  //  ------  const ------;
+  //  ------  const or case ------;
   int64_t val = 0;
+
+  // kind specific payload, see CreateExtNode().
+  NodeExtPtr ext = nullptr;
 };
 
 #endif  // !NODE_GRUAD
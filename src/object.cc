@@ -11,23 +11,29 @@
 
 #include "object.h"
 
+#include <algorithm>
+#include <climits>
 #include <cstddef>
+#include <cstdio>
 #include <cstdlib>
 #include <cstring>
 #include <memory>
+#include <unordered_map>
+#include <utility>
 #include <vector>
 
 #include "node.h"
 #include "parser.h"
 #include "scope.h"
+#include "symbol.h"
 #include "token.h"
 #include "tools.h"
 #include "type.h"
 #include "utils.h"
 
 ObjectPtr Object::CreateVar(Objectkind kind, const String& name, const TypePtr& ty) {
-  auto obj = std::make_shared<Object>(kind, name, ty);
-  Scope::PushVarScope(name)->var = obj;
+  auto obj = MakeIR<Object>(kind, name, ty);
+  Scope::PushVarScope(Symbol::Intern(name))->var = obj;
   return obj;
 }
 
@@ -69,19 +75,67 @@ ObjectPtr Object::CreateFunction(String func_name, TypePtr func_type, ObjectList
   return fn;
 }
 
-void Object::OffsetCal(ObjectList program) {
+void Object::SetScope(ObjectList& locals, size_t first, const NodePtr& scope) {
+  for (size_t i = first; i < locals.size(); i++) {
+    if (locals[i]->scope == nullptr) {
+      locals[i]->scope = &*scope;
+    }
+  }
+}
+
+void Object::OffsetCal(ObjectList program, bool report) {
+  struct Slot {
+    // lifetime in pre-order node numbers and the bytes [offset - size, offset) below rbp.
+    std::pair<int, int> life;
+    int offset;
+    int size;
+  };
+
   for (auto fn : program) {
     if (!fn->Is<OB_FUNCTION>()) {
       continue;
     }
 
-    int ofs = 0;
+    // a scope that was folded away keeps the whole function as its lifetime.
+    std::unordered_map<const Node*, std::pair<int, int>> ranges;
+    for (ObjectPtr v : fn->loc_list) {
+      if (v->scope != nullptr) {
+        ranges[v->scope] = {0, INT_MAX};
+      }
+    }
+    int counter = 0;
+    Node::NumberTree(fn->body, counter, ranges);
+
+    // first fit: the lowest offset no local with an overlapping lifetime uses.
+    std::vector<Slot> slots;
+    int unshared = 0, frame = 0;
     for (auto v = fn->loc_list.rbegin(); v != fn->loc_list.rend(); v++) {
-      ofs += (*v)->ty->size;
-      ofs = AlignTo(ofs, (*v)->ty->align);
+      int size = (*v)->ty->size, align = (*v)->ty->align;
+      unshared = AlignTo(unshared + size, align);
+      std::pair<int, int> life = {0, INT_MAX};
+      if ((*v)->scope != nullptr) {
+        life = ranges[(*v)->scope];
+      }
+      int ofs = AlignTo(std::max(size, 1), align);
+      for (bool moved = true; moved;) {
+        moved = false;
+        for (const Slot& s : slots) {
+          bool live = s.life.first <= life.second && life.first <= s.life.second;
+          if (live && s.offset - s.size < ofs && ofs - size < s.offset) {
+            ofs = AlignTo(s.offset + size, align);
+            moved = true;
+          }
+        }
+      }
+      slots.push_back({life, ofs, size});
       (*v)->offset = ofs;
+      frame = std::max(frame, ofs);
+    }
+    fn->func_attr.stack_size = AlignTo(frame, 16);
+    if (report) {
+      fprintf(stderr, "%s: frame %d -> %d bytes\n", fn->obj_name.c_str(), AlignTo(unshared, 16),
+              fn->func_attr.stack_size);
     }
-    fn->func_attr.stack_size = AlignTo(ofs, 16);
   }
 }
 
@@ -37,8 +37,11 @@ class Object {
   // construct a Object object based on kind.
   Object(Objectkind kind, const String& name, const TypePtr& ty)
       : kind(kind), obj_name(name), ty(ty) {}
-  // calculate the function local variable offset.
-  static void OffsetCal(ObjectList program);
+  // calculate the function local variable offset. Locals whose scopes don't
+  // overlap share stack slots, report prints the frame size of each function.
+  static void OffsetCal(ObjectList program, bool report = false);
+  // set the scope of the locals from first on that don't have one yet.
+  static void SetScope(ObjectList& locals, size_t first, const NodePtr& scope);
   // whether the object is a <kind> object
   template <Objectkind kind>
   bool Is() {
@@ -61,6 +64,8 @@ class Object {
 
  private:
   friend class CodeGenerator;
+  friend class IRBuilder;
+  friend class Inliner;
   // label the object type
   Objectkind kind = Objectkind::OB_END;
   // for object list
@@ -72,6 +77,9 @@ class Object {
 
   // local variable offset
   int offset = 0;
+  // the block, statement expression, for statement or compound assignment the
+  // local is declared in, null for the whole function.
+  const Node* scope = nullptr;
 
   // Global Variable
   String init_data = String();
@@ -25,6 +25,9 @@
 #include "type.h"
 #include "utils.h"
 
+// arguments are only passed in the six argument registers, there is no stack passing.
+static const size_t kMaxArgs = 6;
+
 // Lookahead tokens and returns true if a given token is a start
 // of a function definition or declaration.
 static bool IsFuncToks(TokenPtr tok) {
@@ -47,7 +50,7 @@ static bool IsFuncToks(TokenPtr tok) {
 ASTree Parser::Run(TokenPtr tok) {
   ASTree ast;
   // enter scope
-  Scope::EnterScope(scope);
+  Scope::EnterScope();
   while (!tok->Is<TK_EOF>()) {
     auto attr = std::make_shared<VarAttr>();
     TypePtr basety = Parser::Declspec(&tok, tok, attr, ast);
@@ -55,7 +58,7 @@ ASTree Parser::Run(TokenPtr tok) {
     if (attr->is_typedef) {
       TypePtrVector ty_list = Parser::TypedefDecl(&tok, tok, basety, ast);
       for (auto t : ty_list) {
-        Scope::PushVarScope(t->name->GetIdent())->tydef = t;
+        Scope::PushTypedef(t->name->GetSymbol(), t);
       }
       continue;
     }
@@ -71,7 +74,7 @@ ASTree Parser::Run(TokenPtr tok) {
     }
   }
   // leave scope.
-  Scope::LevarScope(scope);
+  Scope::LevarScope();
   return ast;
 }
 
@@ -91,19 +94,20 @@ TokenPtr Parser::GlobalFunction(TokenPtr tok, TypePtr basety, VarAttrPtr attr, A
   func_attr.is_static = attr->is_static;
 
   // create scope.
-  Scope::EnterScope(scope);
+  Scope::EnterScope();
 
   // funtion defination.
   for (auto i = ty->params.rbegin(); i != ty->params.rend(); ++i) {
-    ObjectPtr v = Object::CreateLocalVar((*i)->name->GetIdent(), *i, ct.locals);
+    Object::CreateLocalVar((*i)->name->GetIdent(), *i, ct.locals);
   }
 
   ObjectList params = ct.locals;
   NodePtr body = Parser::Program(&tok, tok, ct);
+  Node::FoldConst(body);
   ObjectList loc_list = ct.locals;
 
   // leave scope.
-  Scope::LevarScope(scope);
+  Scope::LevarScope();
 
   ct.globals.push_back(
       Object::CreateFunction(name, ty, std::move(params), std::move(loc_list), body, func_attr));
@@ -135,10 +139,10 @@ NodePtr Parser::Program(TokenPtr* rest, TokenPtr tok, ASTree& ct) {
 
 // compound-stmt  = (typedef | declaration | stmt)* "}"
 NodePtr Parser::CompoundStmt(TokenPtr* rest, TokenPtr tok, ASTree& ct) {
-  auto sub_expr = std::make_shared<Node>(ND_END, tok);
+  auto sub_expr = MakeIR<Node>(ND_END, tok);
   NodePtr cur = sub_expr;
 
-  Scope::EnterScope(scope);
+  Scope::EnterScope();
 
   while (!tok->Equal("}")) {
     // parser declaration.
@@ -150,7 +154,7 @@ NodePtr Parser::CompoundStmt(TokenPtr* rest, TokenPtr tok, ASTree& ct) {
       if (attr->is_typedef) {
         TypePtrVector ty_list = TypedefDecl(&tok, tok, basety, ct);
         for (auto t : ty_list) {
-          Scope::PushVarScope(t->name->GetIdent())->tydef = t;
+          Scope::PushTypedef(t->name->GetSymbol(), t);
         }
         continue;
       }
@@ -163,7 +167,7 @@ NodePtr Parser::CompoundStmt(TokenPtr* rest, TokenPtr tok, ASTree& ct) {
     Type::TypeInfer(cur);
   }
 
-  Scope::LevarScope(scope);
+  Scope::LevarScope();
 
   *rest = Token::GetNext<1>(tok);
   return Node::CreateBlockNode(ND_BLOCK, tok, sub_expr->next);
@@ -173,7 +177,7 @@ NodePtr Parser::CompoundStmt(TokenPtr* rest, TokenPtr tok, ASTree& ct) {
 //                 declarator ( "=" expr)?
 //                 ("," declarator ("=" expr)? ) * )? ";"
 NodePtr Parser::Declaration(TokenPtr* rest, TokenPtr tok, TypePtr basety, ASTree& ct) {
-  auto decl_expr = std::make_shared<Node>(ND_END, tok);
+  auto decl_expr = MakeIR<Node>(ND_END, tok);
   NodePtr cur = decl_expr;
   int i = 0;
 
@@ -234,13 +238,14 @@ TypePtr Parser::Declspec(TokenPtr* rest, TokenPtr tok, VarAttrPtr attr, ASTree&
   TypePtr ty = ty_int;
   int counter = 0;
   while (tok->IsTypename()) {
+    KeywordKind kw = tok->GetKeyword();
     // handle strong class specifiers.
-    if (tok->Equal("typedef") || tok->Equal("static")) {
+    if (kw == KW_TYPEDEF || kw == KW_STATIC) {
       if (attr == nullptr) {
         tok->ErrorTok("storage class specifier is not allow in this context.");
       }
 
-      if (tok->Equal("typedef")) {
+      if (kw == KW_TYPEDEF) {
         attr->is_typedef = true;
       } else {
         attr->is_static = true;
@@ -255,16 +260,16 @@ TypePtr Parser::Declspec(TokenPtr* rest, TokenPtr tok, VarAttrPtr attr, ASTree&
 
     // Handle user-define types.
     TypePtr tydef = Scope::FindTypedef(tok);
-    if (tok->Equal("struct") || tok->Equal("union") || tok->Equal("enum") || tydef != nullptr) {
+    if (kw == KW_STRUCT || kw == KW_UNION || kw == KW_ENUM || tydef != nullptr) {
       if (counter) {
         break;
       }
 
-      if (tok->Equal("struct")) {
+      if (kw == KW_STRUCT) {
         ty = StructDecl(&tok, Token::GetNext<1>(tok), ct);
-      } else if (tok->Equal("union")) {
+      } else if (kw == KW_UNION) {
         ty = UnionDecl(&tok, Token::GetNext<1>(tok), ct);
-      } else if (tok->Equal("enum")) {
+      } else if (kw == KW_ENUM) {
         ty = EnumDecl(&tok, Token::GetNext<1>(tok), ct);
       } else {
         ty = tydef;
@@ -274,20 +279,27 @@ TypePtr Parser::Declspec(TokenPtr* rest, TokenPtr tok, VarAttrPtr attr, ASTree&
       continue;
     }
 
-    if (tok->Equal("void")) {
-      counter += VOID;
-    } else if (tok->Equal("_Bool")) {
-      counter += BOOL;
-    } else if (tok->Equal("char")) {
-      counter += CHAR;
-    } else if (tok->Equal("short")) {
-      counter += SHORT;
-    } else if (tok->Equal("int")) {
-      counter += INT;
-    } else if (tok->Equal("long")) {
-      counter += LONG;
-    } else {
-      unreachable();
+    switch (kw) {
+      case KW_VOID:
+        counter += VOID;
+        break;
+      case KW_BOOL:
+        counter += BOOL;
+        break;
+      case KW_CHAR:
+        counter += CHAR;
+        break;
+      case KW_SHORT:
+        counter += SHORT;
+        break;
+      case KW_INT:
+        counter += INT;
+        break;
+      case KW_LONG:
+        counter += LONG;
+        break;
+      default:
+        unreachable();
     }
 
     switch (counter) {
@@ -331,7 +343,7 @@ TypePtr Parser::Declarator(TokenPtr* rest, TokenPtr tok, TypePtr ty, ASTree& ct)
 
   if (tok->Equal("(")) {
     TokenPtr start = tok;
-    auto head = std::make_shared<Type>(TY_END, 0, 0);
+    auto head = MakeIR<Type>(TY_END, 0, 0);
     Declarator(&tok, Token::GetNext<1>(start), head, ct);
     tok = tok->SkipToken(")");
     ty = TypeSuffix(rest, tok, ty, ct);
@@ -372,8 +384,6 @@ TypePtr Parser::TypeSuffix(TokenPtr* rest, TokenPtr tok, TypePtr ty, ASTree& ct)
 }
 
 TypePtrVector Parser::TypedefDecl(TokenPtr* rest, TokenPtr tok, TypePtr basety, ASTree& ct) {
-  auto head = std::make_shared<Type>(TY_END, 1, 1);
-  TypePtr cur = head;
   bool first = true;
   TypePtrVector res;
   while (!tok->Equal(";")) {
@@ -396,7 +406,7 @@ static TypePtr AbstractDeclarator(TokenPtr* rest, TokenPtr tok, TypePtr ty, ASTr
 
   if (tok->Equal("(")) {
     TokenPtr start = tok;
-    auto head = std::make_shared<Type>(TY_END, 0, 0);
+    auto head = MakeIR<Type>(TY_END, 0, 0);
     AbstractDeclarator(&tok, Token::GetNext<1>(start), head, ct);
     tok = tok->SkipToken(")");
     ty = Parser::TypeSuffix(rest, tok, ty, ct);
@@ -415,7 +425,6 @@ TypePtr Parser::Typename(TokenPtr* rest, TokenPtr tok, ASTree& ct) {
 // func-param = param ("," param) *
 // param = declspec declarator
 TypePtr Parser::FunctionParam(TokenPtr* rest, TokenPtr tok, TypePtr ty, ASTree& ct) {
-  auto params = std::make_shared<Type>(TY_END, 0, 0);
   TypePtrVector param;
   bool first = true;
 
@@ -424,6 +433,9 @@ TypePtr Parser::FunctionParam(TokenPtr* rest, TokenPtr tok, TypePtr ty, ASTree&
       tok = tok->SkipToken(",");
     }
     first = false;
+    if (param.size() == kMaxArgs) {
+      tok->ErrorTok("too many parameters.");
+    }
     TypePtr param_ty = Declspec(&tok, tok, nullptr, ct);
     param_ty = Declarator(&tok, tok, param_ty, ct);
 
@@ -433,7 +445,7 @@ TypePtr Parser::FunctionParam(TokenPtr* rest, TokenPtr tok, TypePtr ty, ASTree&
       param_ty = Type::CreatePointerType(param_ty->GetBase());
       param_ty->name = name;
     }
-    param.push_back(std::make_shared<Type>(*param_ty));
+    param.push_back(MakeIR<Type>(*param_ty));
   }
   ty = Type::CreateFunctionType(ty, param);
 
@@ -453,13 +465,13 @@ static TypePtr StructOrUnionDecl(TypeKind kind, TokenPtr* rest, TokenPtr tok, AS
 
   if (tag && !tok->Equal("{")) {
     *rest = tok;
-    ty = Scope::FindTag(tag->GetIdent());
+    ty = Scope::FindTag(tag->GetSymbol());
     if (ty != nullptr) {
       return ty;
     } else {
       // imcompleted type.
-      auto ty = std::make_shared<Type>(TY_STRUCT, -1, 1);
-      Scope::PushTagScope(tag->GetIdent(), ty);
+      auto ty = MakeIR<Type>(TY_STRUCT, -1, 1);
+      Scope::PushTagScope(tag->GetSymbol(), ty);
       return ty;
     }
   }
@@ -473,15 +485,14 @@ static TypePtr StructOrUnionDecl(TypeKind kind, TokenPtr* rest, TokenPtr tok, AS
   if (tag) {
     // If this is a redefinition, overwrite a previous type.
     // Otherwise, register the struct type.
-    const String& name = tag->GetIdent();
-    auto t = scope->GetTagScope().find(name);
-    if (t != scope->GetTagScope().end()) {
-      *(t->second) = *ty;
+    TypePtr t = Scope::FindCurrentTag(tag->GetSymbol());
+    if (t != nullptr) {
+      *t = *ty;
       // avoid cyclic reference
-      t->second->UpdateStructMember(mem);
-      return t->second;
+      t->UpdateStructMember(mem);
+      return t;
     }
-    Scope::PushTagScope(tag->GetIdent(), ty);
+    Scope::PushTagScope(tag->GetSymbol(), ty);
   }
   return ty;
 }
@@ -508,7 +519,7 @@ TypePtr Parser::EnumDecl(TokenPtr* rest, TokenPtr tok, ASTree& ct) {
   }
   if (tag && !tok->Equal("{")) {
     *rest = tok;
-    TypePtr res = Scope::FindTag(tag->GetIdent());
+    TypePtr res = Scope::FindTag(tag->GetSymbol());
     if (!res) {
       tok->ErrorTok("unknow enum tag");
     }
@@ -526,7 +537,7 @@ TypePtr Parser::EnumDecl(TokenPtr* rest, TokenPtr tok, ASTree& ct) {
       tok = tok->SkipToken(",");
     }
 
-    const String& name = tok->GetIdent();
+    SymbolPtr name = tok->GetSymbol();
     tok = Token::GetNext<1>(tok);
     if (tok->Equal("=")) {
       val = ConstExprEval(&tok, Token::GetNext<1>(tok), ct);
@@ -536,7 +547,7 @@ TypePtr Parser::EnumDecl(TokenPtr* rest, TokenPtr tok, ASTree& ct) {
   }
   *rest = tok->SkipToken("}");
   if (tag) {
-    Scope::PushTagScope(tag->GetIdent(), ty);
+    Scope::PushTagScope(tag->GetSymbol(), ty);
   }
   return ty;
 }
@@ -586,10 +597,10 @@ NodePtr Parser::Stmt(TokenPtr* rest, TokenPtr tok, ASTree& ct) {
     NodePtr swt = cur_swt;
     cur_swt = Node::CreateSwitchNode(start, body);
     // buffer break;
-    String brk = ct.cur_brk;
-    ct.cur_brk = cur_swt->break_label = CreateUniqueName();
+    int brk = ct.cur_brk;
+    ct.cur_brk = cur_swt->ext->break_label = CreateUniqueId();
     // parse switch body
-    cur_swt->then = Stmt(rest, tok, ct);
+    cur_swt->ext->then = Stmt(rest, tok, ct);
 
     ct.cur_brk = brk;
     NodePtr res = cur_swt;
@@ -606,7 +617,7 @@ NodePtr Parser::Stmt(TokenPtr* rest, TokenPtr tok, ASTree& ct) {
     tok = tok->SkipToken(":");
 
     NodePtr res = Node::CreateCaseNode(start, v, Stmt(rest, tok, ct));
-    cur_swt->case_nodes.push_back(res);
+    cur_swt->ext->case_nodes.push_back(res);
     return res;
   }
 
@@ -618,7 +629,7 @@ NodePtr Parser::Stmt(TokenPtr* rest, TokenPtr tok, ASTree& ct) {
     tok = Token::GetNext<1>(tok)->SkipToken(":");
 
     NodePtr res = Node::CreateDefaultNode(start, Stmt(rest, tok, ct));
-    cur_swt->default_node = res;
+    cur_swt->ext->default_node = res;
     return res;
   }
 
@@ -630,12 +641,13 @@ NodePtr Parser::Stmt(TokenPtr* rest, TokenPtr tok, ASTree& ct) {
     NodePtr cond = nullptr;
     NodePtr inc = nullptr;
 
-    Scope::EnterScope(scope);
+    Scope::EnterScope();
+    size_t first = ct.locals.size();
 
-    String brk = ct.cur_brk;
-    String cnt = ct.cur_cnt;
-    ct.cur_brk = CreateUniqueName();
-    ct.cur_cnt = CreateUniqueName();
+    int brk = ct.cur_brk;
+    int cnt = ct.cur_cnt;
+    ct.cur_brk = CreateUniqueId();
+    ct.cur_cnt = CreateUniqueId();
 
     if (tok->IsTypename()) {
       TypePtr basety = Declspec(&tok, tok, nullptr, ct);
@@ -655,8 +667,9 @@ NodePtr Parser::Stmt(TokenPtr* rest, TokenPtr tok, ASTree& ct) {
 
     NodePtr body = Stmt(rest, tok, ct);
 
-    Scope::LevarScope(scope);
+    Scope::LevarScope();
     NodePtr res = Node::CreateForNode(node_name, init, cond, inc, body, ct.cur_brk, ct.cur_cnt);
+    Object::SetScope(ct.locals, first, res);
     ct.cur_brk = brk;
     ct.cur_cnt = cnt;
     return res;
@@ -669,10 +682,10 @@ NodePtr Parser::Stmt(TokenPtr* rest, TokenPtr tok, ASTree& ct) {
     NodePtr cond = Expr(&tok, tok, ct);
     tok = tok->SkipToken(")");
 
-    String brk = ct.cur_brk;
-    String cnt = ct.cur_cnt;
-    ct.cur_brk = CreateUniqueName();
-    ct.cur_cnt = CreateUniqueName();
+    int brk = ct.cur_brk;
+    int cnt = ct.cur_cnt;
+    ct.cur_brk = CreateUniqueId();
+    ct.cur_cnt = CreateUniqueId();
 
     NodePtr then = Stmt(rest, tok, ct);
     NodePtr res =
@@ -684,25 +697,25 @@ NodePtr Parser::Stmt(TokenPtr* rest, TokenPtr tok, ASTree& ct) {
   }
 
   if (tok->Equal("goto")) {
-    NodePtr node = Node::CreateGotoNode(tok, Token::GetNext<1>(tok)->GetIdent());
+    NodePtr node = Node::CreateGotoNode(tok, Token::GetNext<1>(tok)->GetSymbol());
     *rest = Token::GetNext<2>(tok)->SkipToken(";");
     return node;
   }
 
   if (tok->Equal("break")) {
-    if (ct.cur_brk.empty()) {
+    if (ct.cur_brk < 0) {
       tok->ErrorTok("stray break");
     }
-    NodePtr res = Node::CreateGotoNode(tok, ct.cur_brk, false);
+    NodePtr res = Node::CreateJumpNode(tok, ct.cur_brk);
     *rest = Token::GetNext<1>(tok)->SkipToken(";");
     return res;
   }
 
   if (tok->Equal("continue")) {
-    if (ct.cur_cnt.empty()) {
+    if (ct.cur_cnt < 0) {
       tok->ErrorTok("stray continue");
     }
-    NodePtr res = Node::CreateGotoNode(tok, ct.cur_cnt, false);
+    NodePtr res = Node::CreateJumpNode(tok, ct.cur_cnt);
     *rest = Token::GetNext<1>(tok)->SkipToken(";");
     return res;
   }
@@ -712,7 +725,10 @@ NodePtr Parser::Stmt(TokenPtr* rest, TokenPtr tok, ASTree& ct) {
   }
 
   if (tok->Equal("{")) {
-    return CompoundStmt(rest, Token::GetNext<1>(tok), ct);
+    size_t first = ct.locals.size();
+    NodePtr res = CompoundStmt(rest, Token::GetNext<1>(tok), ct);
+    Object::SetScope(ct.locals, first, res);
+    return res;
   }
 
   return ExprStmt(rest, tok, ct);
@@ -1071,9 +1087,12 @@ NodePtr Parser::Primary(TokenPtr* rest, TokenPtr tok, ASTree& ct) {
   // This is a GNU statement expression.
   if (tok->Equal("(") && Token::GetNext<1>(tok)->Equal("{")) {
     TokenPtr start = tok;
+    size_t first = ct.locals.size();
     NodePtr stmt = CompoundStmt(&tok, Token::GetNext<2>(tok), ct);
     *rest = tok->SkipToken(")");
-    return Node::CreateBlockNode(ND_STMT_EXPR, start, stmt->body);
+    NodePtr res = Node::CreateBlockNode(ND_STMT_EXPR, start, stmt->ext->body);
+    Object::SetScope(ct.locals, first, res);
+    return res;
   }
   if (tok->Equal("(")) {
     NodePtr node = Expr(&tok, Token::GetNext<1>(tok), ct);
@@ -1124,7 +1143,7 @@ NodePtr Parser::Call(TokenPtr* rest, TokenPtr tok, ASTree& ct) {
   // can't optimaze, need start tok.
   tok = Token::GetNext<2>(tok);
 
-  VarScopePtr sc = Scope::FindVarScope(start->GetIdent());
+  VarScopePtr sc = Scope::FindVarScope(start->GetSymbol());
   if (!sc) {
     start->ErrorTok("implicit declaration of a function");
   }
@@ -1133,16 +1152,20 @@ NodePtr Parser::Call(TokenPtr* rest, TokenPtr tok, ASTree& ct) {
   }
 
   auto ty = sc->var->GetType();
-  auto head = std::make_shared<Node>(ND_END, tok);
+  auto head = MakeIR<Node>(ND_END, tok);
   NodePtr cur = head;
 
   const auto& params_ty = ty->params;
   int pt_idx = 0;
+  size_t nargs = 0;
 
   while (!tok->Equal(")")) {
     if (cur != head) {
       tok = tok->SkipToken(",");
     }
+    if (++nargs > kMaxArgs) {
+      tok->ErrorTok("too many arguments.");
+    }
     NodePtr arg = Assign(&tok, tok, ct);
     Type::TypeInfer(arg);
 
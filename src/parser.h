@@ -30,8 +30,8 @@ class ASTree {
   ObjectPtr cur_fn = nullptr;
 
   // Current "goto" and "continue" jump targets.
-  String cur_brk = "";
-  String cur_cnt = "";
+  int cur_brk = -1;
+  int cur_cnt = -1;
 };
 
 /*  ---- parse OBJECT ---- */
@@ -0,0 +1,439 @@
+/*
+ * This project is exclusively owned by QingChuanWS and shall not be used for
+ * commercial and profitting purpose without QingChuanWS's permission.
+ *
+ * @ Author: bingshan45@163.com
+ * @ Github: https://github.com/QingChuanWS
+ * @ Description:
+ *
+ * Copyright (c) 2023 by QingChuanWS, All Rights Reserved.
+ */
+
+#include "peephole.h"
+
+#include <cstring>
+
+static const char* rule_names[Peephole::PH_RULE_NUM] = {
+    "loc", "unreachable", "jmp-next", "push-pop", "copy-fwd", "self-mov", "red-zone",
+};
+
+// registers read and written by an instruction, as masks over AsmReg.
+struct RegEffect {
+  uint32_t use = 0;
+  uint32_t def = 0;
+  // labels, jumps, calls, returns and every directive but .loc.
+  bool barrier = false;
+  // pushes, pops and anything else touching rsp.
+  bool stack = false;
+};
+
+static uint32_t Bit(AsmReg reg) { return 1u << reg; }
+
+static const uint32_t kFrameRegs = 1u << REG_SP | 1u << REG_BP;
+
+// the bytes below rsp the System V ABI keeps from signal handlers.
+static const int64_t kRedZone = 128;
+
+// the registers needed to read an operand.
+static uint32_t ReadUse(const AsmOperand& opd) {
+  if (opd.kind == AsmOperand::OPD_REG || (opd.kind == AsmOperand::OPD_MEM && opd.reg != REG_IP)) {
+    return Bit(opd.reg) | (opd.kind == AsmOperand::OPD_MEM && opd.scale != 0 ? Bit(opd.index) : 0);
+  }
+  return 0;
+}
+
+// the registers written through a destination operand. A write of less than
+// 4 bytes keeps the upper bits of the register, so it reads them as well.
+static void WriteDst(const AsmOperand& dst, RegEffect& e) {
+  if (dst.kind != AsmOperand::OPD_REG) {
+    e.use |= ReadUse(dst);
+    return;
+  }
+  e.def |= Bit(dst.reg);
+  if (dst.size < 4) {
+    e.use |= Bit(dst.reg);
+  }
+}
+
+static RegEffect GetEffect(const AsmInst& inst) {
+  RegEffect e;
+  switch (inst.op) {
+    case AS_LOC:
+      return e;
+    case I_MOV:
+    case I_LEA:
+    case I_MOVZX:
+    case I_MOVSX:
+    case I_MOVSXD:
+      e.use = ReadUse(inst.src);
+      WriteDst(inst.dst, e);
+      break;
+    case I_PUSH:
+      e.use = ReadUse(inst.dst);
+      e.stack = true;
+      break;
+    case I_POP:
+      WriteDst(inst.dst, e);
+      e.stack = true;
+      break;
+    case I_CQO:
+    case I_CDQ:
+      e.use = Bit(REG_AX);
+      e.def = Bit(REG_DX);
+      break;
+    case I_IDIV:
+      e.use = ReadUse(inst.dst) | Bit(REG_AX) | Bit(REG_DX);
+      e.def = Bit(REG_AX) | Bit(REG_DX);
+      break;
+    case I_NEG:
+    case I_NOT:
+    case I_SETE:
+    case I_SETNE:
+    case I_SETL:
+    case I_SETLE:
+      e.use = ReadUse(inst.dst);
+      WriteDst(inst.dst, e);
+      break;
+    case I_IMUL:
+      if (inst.src.kind == AsmOperand::OPD_NONE) {
+        e.use = ReadUse(inst.dst) | Bit(REG_AX);
+        e.def = Bit(REG_AX) | Bit(REG_DX);
+        break;
+      }
+      e.use = ReadUse(inst.dst) | ReadUse(inst.src);
+      WriteDst(inst.dst, e);
+      break;
+    case I_ADD:
+    case I_SUB:
+    case I_AND:
+    case I_OR:
+    case I_XOR:
+    case I_SHL:
+    case I_SAR:
+    case I_SHR:
+      e.use = ReadUse(inst.dst) | ReadUse(inst.src);
+      WriteDst(inst.dst, e);
+      break;
+    case I_CMP:
+      e.use = ReadUse(inst.dst) | ReadUse(inst.src);
+      break;
+    default:
+      e.barrier = true;
+      return e;
+  }
+  if ((e.use | e.def) & Bit(REG_SP)) {
+    e.stack = true;
+  }
+  return e;
+}
+
+static bool SameLabel(const AsmLabel& a, const AsmLabel& b) {
+  if (a.kind != b.kind || a.id != b.id) {
+    return false;
+  }
+  if (a.name == nullptr || b.name == nullptr) {
+    return a.name == b.name;
+  }
+  return *a.name == *b.name;
+}
+
+static bool IsDirective(AsmOp op) { return op < I_PUSH; }
+
+const char* Peephole::RuleName(int rule) { return rule_names[rule]; }
+
+bool Peephole::ParseRules(const char* list, uint32_t* mask) {
+  *mask = 0;
+  while (*list != '\0') {
+    size_t len = strcspn(list, ",");
+    int rule = 0;
+    while (rule < PH_RULE_NUM &&
+           (strlen(rule_names[rule]) != len || strncmp(rule_names[rule], list, len) != 0)) {
+      rule++;
+    }
+    if (rule == PH_RULE_NUM) {
+      return false;
+    }
+    *mask |= 1u << rule;
+    list += list[len] == ',' ? len + 1 : len;
+  }
+  return true;
+}
+
+void Peephole::Run(AsmBuffer& insts) {
+  static void (Peephole::*const passes[PH_RULE_NUM])(AsmBuffer&) = {
+      &Peephole::Loc,      &Peephole::Unreachable, &Peephole::JmpNext,
+      &Peephole::PushPop,  &Peephole::CopyFwd,     &Peephole::SelfMov,
+      &Peephole::RedZone,
+  };
+
+  bool changed = true;
+  while (changed) {
+    changed = false;
+    for (int rule = 0; rule < PH_RULE_NUM; rule++) {
+      if (!Enabled(static_cast<Rule>(rule))) {
+        continue;
+      }
+      int prev = hits[rule];
+      dead.assign(insts.size(), false);
+      (this->*passes[rule])(insts);
+      if (hits[rule] != prev) {
+        Compact(insts);
+        changed = true;
+      }
+    }
+  }
+}
+
+void Peephole::Report(FILE* out) const {
+  fprintf(out, "%-16s %8s\n", "peephole rule", "hits");
+  for (int rule = 0; rule < PH_RULE_NUM; rule++) {
+    fprintf(out, "%-16s %8d\n", rule_names[rule], hits[rule]);
+  }
+}
+
+void Peephole::Compact(AsmBuffer& insts) {
+  size_t n = 0;
+  for (size_t i = 0; i < insts.size(); i++) {
+    if (!dead[i]) {
+      insts[n++] = insts[i];
+    }
+  }
+  insts.resize(n);
+}
+
+// whether reg is written before it is read again from the index-th instruction on.
+static bool DeadFrom(const AsmBuffer& insts, const std::vector<bool>& dead, size_t index,
+                     AsmReg reg) {
+  for (size_t i = index; i < insts.size(); i++) {
+    if (dead[i]) {
+      continue;
+    }
+    RegEffect e = GetEffect(insts[i]);
+    if (e.barrier || e.use & Bit(reg)) {
+      return false;
+    }
+    if (e.def & Bit(reg)) {
+      return true;
+    }
+  }
+  return false;
+}
+
+void Peephole::Loc(AsmBuffer& insts) {
+  // the line of the last instruction and the .loc no instruction follows yet.
+  int64_t line = -1;
+  int pending = -1;
+  for (size_t i = 0; i < insts.size(); i++) {
+    AsmOp op = insts[i].op;
+    if (op == AS_LOC) {
+      if (pending >= 0) {
+        dead[pending] = true;
+        hits[PH_LOC]++;
+        pending = -1;
+      }
+      if (insts[i].dst.imm == line) {
+        dead[i] = true;
+        hits[PH_LOC]++;
+      } else {
+        pending = i;
+      }
+    } else if (op == AS_LABEL) {
+      continue;
+    } else if (IsDirective(op)) {
+      line = -1;
+      pending = -1;
+    } else if (pending >= 0) {
+      line = insts[pending].dst.imm;
+      pending = -1;
+    }
+  }
+}
+
+void Peephole::Unreachable(AsmBuffer& insts) {
+  bool skip = false;
+  for (size_t i = 0; i < insts.size(); i++) {
+    AsmOp op = insts[i].op;
+    if (IsDirective(op)) {
+      skip &= op == AS_LOC;
+    } else if (skip) {
+      dead[i] = true;
+      hits[PH_UNREACHABLE]++;
+    } else {
+      skip = op == I_JMP || op == I_RET;
+    }
+  }
+}
+
+void Peephole::JmpNext(AsmBuffer& insts) {
+  for (size_t i = 0; i < insts.size(); i++) {
+    if (insts[i].op != I_JMP || insts[i].dst.kind != AsmOperand::OPD_LABEL) {
+      continue;
+    }
+    for (size_t k = i + 1; k < insts.size(); k++) {
+      if (insts[k].op == AS_LOC) {
+        continue;
+      }
+      if (insts[k].op != AS_LABEL) {
+        break;
+      }
+      if (SameLabel(insts[k].dst.label, insts[i].dst.label)) {
+        dead[i] = true;
+        hits[PH_JMP_NEXT]++;
+        break;
+      }
+    }
+  }
+}
+
+void Peephole::PushPop(AsmBuffer& insts) {
+  for (size_t j = 0; j < insts.size(); j++) {
+    if (insts[j].op != I_POP || insts[j].dst.kind != AsmOperand::OPD_REG) {
+      continue;
+    }
+    AsmReg to = insts[j].dst.reg;
+    // registers the instructions between the push and the pop read and write.
+    uint32_t use = 0, def = 0;
+    for (size_t i = j; i-- > 0;) {
+      if (dead[i]) {
+        continue;
+      }
+      const AsmInst& inst = insts[i];
+      if (inst.op == I_PUSH) {
+        if (inst.dst.kind != AsmOperand::OPD_REG || def & Bit(to)) {
+          break;
+        }
+        AsmReg from = inst.dst.reg;
+        if (from == to) {
+          dead[i] = true;
+        } else if (use & Bit(to)) {
+          break;
+        } else {
+          insts[i] = {I_MOV, Reg(to), Reg(from)};
+        }
+        dead[j] = true;
+        hits[PH_PUSH_POP]++;
+        break;
+      }
+      RegEffect e = GetEffect(inst);
+      if (e.barrier || e.stack) {
+        break;
+      }
+      use |= e.use;
+      def |= e.def;
+    }
+  }
+}
+
+void Peephole::CopyFwd(AsmBuffer& insts) {
+  int prev = -1;
+  for (size_t j = 0; j < insts.size(); j++) {
+    if (dead[j] || insts[j].op == AS_LOC) {
+      continue;
+    }
+    int i = prev;
+    prev = j;
+    const AsmInst& copy = insts[j];
+    if (i < 0 || copy.op != I_MOV || copy.dst.kind != AsmOperand::OPD_REG ||
+        copy.src.kind != AsmOperand::OPD_REG || copy.dst.size != 8 || copy.src.size != 8 ||
+        copy.dst.reg == copy.src.reg || (Bit(copy.dst.reg) | Bit(copy.src.reg)) & kFrameRegs) {
+      continue;
+    }
+    AsmInst& def = insts[i];
+    bool plain_def = def.op == I_MOV || def.op == I_LEA || def.op == I_MOVZX ||
+                     def.op == I_MOVSX || def.op == I_MOVSXD;
+    if (!plain_def || def.dst.kind != AsmOperand::OPD_REG || def.dst.reg != copy.src.reg ||
+        def.dst.size < 4 || !DeadFrom(insts, dead, j + 1, copy.src.reg)) {
+      continue;
+    }
+    def.dst.reg = copy.dst.reg;
+    dead[j] = true;
+    hits[PH_COPY_FWD]++;
+    prev = i;
+  }
+}
+
+void Peephole::SelfMov(AsmBuffer& insts) {
+  for (size_t i = 0; i < insts.size(); i++) {
+    const AsmInst& inst = insts[i];
+    // a 32 bit move to itself still clears the upper half.
+    if (inst.op == I_MOV && inst.dst.kind == AsmOperand::OPD_REG &&
+        inst.src.kind == AsmOperand::OPD_REG && inst.dst.reg == inst.src.reg &&
+        inst.dst.size == 8) {
+      dead[i] = true;
+      hits[PH_SELF_MOV]++;
+    }
+  }
+}
+
+static bool IsReg(const AsmOperand& opd, AsmReg reg) {
+  return opd.kind == AsmOperand::OPD_REG && opd.reg == reg;
+}
+
+static bool UsesReg(const AsmOperand& opd, AsmReg reg) {
+  return ReadUse(opd) & Bit(reg);
+}
+
+// the first live instruction from index on that isn't a .loc.
+static size_t NextInst(const AsmBuffer& insts, const std::vector<bool>& dead, size_t index) {
+  while (index < insts.size() && (dead[index] || insts[index].op == AS_LOC)) {
+    index++;
+  }
+  return index;
+}
+
+void Peephole::RedZone(AsmBuffer& insts) {
+  size_t n = insts.size();
+  for (size_t i = 0; i < n; i++) {
+    // push rbp; mov rbp, rsp; sub rsp, size.
+    if (dead[i] || insts[i].op != I_PUSH || !IsReg(insts[i].dst, REG_BP)) {
+      continue;
+    }
+    size_t mov = NextInst(insts, dead, i + 1);
+    if (mov == n || insts[mov].op != I_MOV || !IsReg(insts[mov].dst, REG_BP) ||
+        !IsReg(insts[mov].src, REG_SP)) {
+      continue;
+    }
+    size_t sub = NextInst(insts, dead, mov + 1);
+    bool has_sub = sub < n && insts[sub].op == I_SUB && IsReg(insts[sub].dst, REG_SP) &&
+                   insts[sub].src.kind == AsmOperand::OPD_IMM;
+
+    // a leaf body leaves rsp alone up to the mov rsp, rbp of the epilogue.
+    bool leaf = true;
+    bool uses_bp = false;
+    size_t k = has_sub ? sub + 1 : mov + 1;
+    for (; k < n; k++) {
+      const AsmInst& inst = insts[k];
+      if (dead[k]) {
+        continue;
+      }
+      if (inst.op == I_MOV && IsReg(inst.dst, REG_SP) && IsReg(inst.src, REG_BP)) {
+        break;
+      }
+      bool other_code = IsDirective(inst.op) && inst.op != AS_LOC && inst.op != AS_LABEL &&
+                        inst.op != AS_OFFSET;
+      if (other_code || inst.op == I_CALL || inst.op == I_PUSH || inst.op == I_POP ||
+          inst.op == I_RET || UsesReg(inst.dst, REG_SP) || UsesReg(inst.src, REG_SP)) {
+        leaf = false;
+        break;
+      }
+      uses_bp |= UsesReg(inst.dst, REG_BP) || UsesReg(inst.src, REG_BP);
+    }
+    size_t pop = NextInst(insts, dead, k + 1);
+    size_t ret = NextInst(insts, dead, pop + 1);
+    if (!leaf || ret >= n || insts[pop].op != I_POP || !IsReg(insts[pop].dst, REG_BP) ||
+        insts[ret].op != I_RET) {
+      continue;
+    }
+
+    if (has_sub && insts[sub].src.imm <= kRedZone) {
+      dead[sub] = true;
+      hits[PH_RED_ZONE]++;
+      has_sub = false;
+    }
+    if (!has_sub && !uses_bp) {
+      dead[i] = dead[mov] = dead[k] = dead[pop] = true;
+      hits[PH_RED_ZONE]++;
+    }
+    i = ret;
+  }
+}
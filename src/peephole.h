@@ -0,0 +1,69 @@
+/*
+ * This project is exclusively owned by QingChuanWS and shall not be used for
+ * commercial and profitting purpose without QingChuanWS's permission.
+ *
+ * @ Author: bingshan45@163.com
+ * @ Github: https://github.com/QingChuanWS
+ * @ Description:
+ *
+ * Copyright (c) 2023 by QingChuanWS, All Rights Reserved.
+ */
+
+#ifndef PEEPHOLE_GRUAD
+#define PEEPHOLE_GRUAD
+
+#include <cstdint>
+#include <cstdio>
+#include <vector>
+
+#include "asm_inst.h"
+
+// Peephole rewrites over the emitted instruction buffer.
+//
+// The rules only look at straight line code: labels, jumps, calls and
+// returns end every window, and a register is only treated as dead if it is
+// overwritten before the next one of them. The rules run in turn until none of
+// them applies any more.
+class Peephole {
+ public:
+  enum Rule : uint8_t {
+    PH_LOC,          // drop .loc lines that do not change the line.
+    PH_UNREACHABLE,  // drop instructions between a jmp or ret and the next label.
+    PH_JMP_NEXT,     // drop a jmp to a label that directly follows it.
+    PH_PUSH_POP,     // push r1 ... pop r2 -> mov r2, r1.
+    PH_COPY_FWD,     // op r1, x; mov r2, r1 -> op r2, x if r1 is dead.
+    PH_SELF_MOV,     // drop mov r, r.
+    PH_RED_ZONE,     // leaf functions keep their locals in the red zone, or drop the frame.
+    PH_RULE_NUM,
+  };
+
+  static constexpr uint32_t kAllRules = (1u << PH_RULE_NUM) - 1;
+
+  static const char* RuleName(int rule);
+  // parse a comma separated list of rule names into a rule mask.
+  static bool ParseRules(const char* list, uint32_t* mask);
+
+  explicit Peephole(uint32_t rules) : rules(rules) {}
+  void Run(AsmBuffer& insts);
+  // print the number of rewrites of each rule.
+  void Report(FILE* out) const;
+
+ private:
+  bool Enabled(Rule rule) const { return rules >> rule & 1; }
+  // each rule marks the instructions it deletes as dead, Compact removes them.
+  void Compact(AsmBuffer& insts);
+
+  void Loc(AsmBuffer& insts);
+  void Unreachable(AsmBuffer& insts);
+  void JmpNext(AsmBuffer& insts);
+  void PushPop(AsmBuffer& insts);
+  void CopyFwd(AsmBuffer& insts);
+  void SelfMov(AsmBuffer& insts);
+  void RedZone(AsmBuffer& insts);
+
+  uint32_t rules;
+  int hits[PH_RULE_NUM] = {0};
+  std::vector<bool> dead{};
+};
+
+#endif  // !PEEPHOLE_GRUAD
@@ -0,0 +1,209 @@
+/*
+ * This project is exclusively owned by QingChuanWS and shall not be used for
+ * commercial and profitting purpose without QingChuanWS's permission.
+ *
+ * @ Author: bingshan45@163.com
+ * @ Github: https://github.com/QingChuanWS
+ * @ Description:
+ *
+ * Copyright (c) 2023 by QingChuanWS, All Rights Reserved.
+ */
+
+#include "regalloc.h"
+
+#include <algorithm>
+#include <climits>
+#include <cstdint>
+
+static const AsmReg caller_saved[] = {REG_SI, REG_DI, REG_R8, REG_R9, REG_R10};
+static const AsmReg callee_saved[] = {REG_BX, REG_R12, REG_R13, REG_R14, REG_R15};
+
+// a set of virtual registers.
+using VRegSet = std::vector<uint64_t>;
+
+static void SetBit(VRegSet& set, VReg v) { set[v / 64] |= uint64_t(1) << (v % 64); }
+static bool HasBit(const VRegSet& set, VReg v) { return set[v / 64] >> (v % 64) & 1; }
+
+RegAllocResult RegAlloc::Run(const IRFunction& f) {
+  RegAlloc ra(f);
+  ra.res.locs.resize(f.vreg_cnt);
+  ra.BuildIntervals();
+  ra.Allocate();
+  return ra.res;
+}
+
+void RegAlloc::BuildIntervals() {
+  size_t words = (f.vreg_cnt + 63) / 64;
+  size_t nblocks = f.blocks.size();
+  std::vector<VRegSet> use(nblocks), def(nblocks), live_in(nblocks), live_out(nblocks);
+
+  for (int b : f.layout) {
+    use[b].assign(words, 0);
+    def[b].assign(words, 0);
+    live_in[b].assign(words, 0);
+    live_out[b].assign(words, 0);
+    for (const IRInst& inst : f.blocks[b].insts) {
+      inst.ForEachUse([&](VReg v) {
+        if (!HasBit(def[b], v)) {
+          SetBit(use[b], v);
+        }
+      });
+      if (inst.dst >= 0) {
+        SetBit(def[b], inst.dst);
+      }
+    }
+  }
+
+  // live_in = use | (live_out - def), live_out = union of the successors' live_in.
+  bool changed = true;
+  while (changed) {
+    changed = false;
+    for (auto it = f.layout.rbegin(); it != f.layout.rend(); it++) {
+      int b = *it;
+      const IRInst& term = f.blocks[b].insts.back();
+      term.ForEachSucc([&](int succ) {
+        for (size_t w = 0; w < words; w++) {
+          live_out[b][w] |= live_in[succ][w];
+        }
+      });
+      for (size_t w = 0; w < words; w++) {
+        uint64_t in = use[b][w] | (live_out[b][w] & ~def[b][w]);
+        if (in != live_in[b][w]) {
+          live_in[b][w] = in;
+          changed = true;
+        }
+      }
+    }
+  }
+
+  std::vector<int> start(f.vreg_cnt, INT_MAX), end(f.vreg_cnt, -1);
+  auto extend = [&](VReg v, int pos) {
+    start[v] = std::min(start[v], pos);
+    end[v] = std::max(end[v], pos);
+  };
+  auto extend_set = [&](const VRegSet& set, int pos) {
+    for (size_t w = 0; w < words; w++) {
+      for (uint64_t bits = set[w]; bits != 0; bits &= bits - 1) {
+        extend(w * 64 + __builtin_ctzll(bits), pos);
+      }
+    }
+  };
+
+  // the parameters are written by the prologue.
+  for (const IRParam& param : f.params) {
+    if (param.reg >= 0) {
+      extend(param.reg, 0);
+    }
+  }
+  // the i-th instruction reads its operands at 2i and writes its result at 2i+1,
+  // so a result can reuse the register of an operand read for the last time.
+  std::vector<int> calls;
+  int pos = 0;
+  for (int b : f.layout) {
+    extend_set(live_in[b], pos);
+    for (const IRInst& inst : f.blocks[b].insts) {
+      inst.ForEachUse([&](VReg v) { extend(v, pos); });
+      if (inst.dst >= 0) {
+        extend(inst.dst, pos + 1);
+      }
+      if (inst.op == IR_CALL) {
+        calls.push_back(pos);
+      }
+      pos += 2;
+    }
+    extend_set(live_out[b], pos - 1);
+  }
+
+  for (VReg v = 0; v < f.vreg_cnt; v++) {
+    if (end[v] < 0) {
+      continue;
+    }
+    // a value is clobbered by a call made while it is live, including one at
+    // the start of its interval that reads a parameter or a live in value.
+    auto call = std::lower_bound(calls.begin(), calls.end(), start[v]);
+    bool crosses_call = call != calls.end() && *call + 1 < end[v];
+    intervals.push_back({v, start[v], end[v], crosses_call});
+  }
+}
+
+void RegAlloc::Spill(VReg reg) {
+  res.spill_size += 8;
+  res.locs[reg].slot = f.stack_size + res.spill_size;
+}
+
+void RegAlloc::Allocate() {
+  std::sort(intervals.begin(), intervals.end(),
+            [](const Interval& a, const Interval& b) { return a.start < b.start; });
+
+  bool is_free[REG_R15 + 1];
+  std::fill(is_free, is_free + REG_R15 + 1, false);
+  for (AsmReg r : caller_saved) {
+    is_free[r] = true;
+  }
+  for (AsmReg r : callee_saved) {
+    is_free[r] = true;
+  }
+  bool used[REG_R15 + 1] = {false};
+
+  std::vector<Interval> active;
+  for (const Interval& cur : intervals) {
+    for (auto it = active.begin(); it != active.end();) {
+      if (it->end < cur.start) {
+        is_free[res.locs[it->reg].reg] = true;
+        it = active.erase(it);
+      } else {
+        it++;
+      }
+    }
+
+    int reg = -1;
+    if (!cur.crosses_call) {
+      for (AsmReg r : caller_saved) {
+        if (is_free[r]) {
+          reg = r;
+          break;
+        }
+      }
+    }
+    if (reg < 0) {
+      for (AsmReg r : callee_saved) {
+        if (is_free[r]) {
+          reg = r;
+          break;
+        }
+      }
+    }
+
+    if (reg < 0) {
+      // take the register of the active interval ending last, if it ends after cur.
+      auto victim = active.end();
+      for (auto it = active.begin(); it != active.end(); it++) {
+        AsmReg r = res.locs[it->reg].reg;
+        bool usable = !cur.crosses_call || std::find(std::begin(callee_saved),
+                                                     std::end(callee_saved),
+                                                     r) != std::end(callee_saved);
+        if (usable && (victim == active.end() || it->end > victim->end)) {
+          victim = it;
+        }
+      }
+      if (victim == active.end() || victim->end <= cur.end) {
+        Spill(cur.reg);
+        continue;
+      }
+      reg = res.locs[victim->reg].reg;
+      Spill(victim->reg);
+      active.erase(victim);
+    }
+
+    res.locs[cur.reg].reg = static_cast<AsmReg>(reg);
+    is_free[reg] = false;
+    used[reg] = true;
+    active.push_back(cur);
+  }
+
+  for (AsmReg r : callee_saved) {
+    if (used[r]) {
+      res.saved.push_back(r);
+    }
+  }
+}
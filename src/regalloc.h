@@ -0,0 +1,67 @@
+/*
+ * This project is exclusively owned by QingChuanWS and shall not be used for
+ * commercial and profitting purpose without QingChuanWS's permission.
+ *
+ * @ Author: bingshan45@163.com
+ * @ Github: https://github.com/QingChuanWS
+ * @ Description:
+ *
+ * Copyright (c) 2023 by QingChuanWS, All Rights Reserved.
+ */
+
+#ifndef REGALLOC_GRUAD
+#define REGALLOC_GRUAD
+
+#include <vector>
+
+#include "asm_inst.h"
+#include "ir.h"
+
+// where a virtual register lives.
+struct VRegLoc {
+  AsmReg reg = REG_AX;
+  // frame offset below rbp if the register is spilled, 0 otherwise.
+  int slot = 0;
+
+  bool IsSpilled() const { return slot != 0; }
+};
+
+struct RegAllocResult {
+  std::vector<VRegLoc> locs{};
+  // callee saved registers the function has to preserve.
+  std::vector<AsmReg> saved{};
+  // frame bytes below the locals taken by the spill slots.
+  int spill_size = 0;
+};
+
+// Linear scan register allocation.
+//
+// The live range of each virtual register is the hull of the positions it is
+// live at, computed from block level liveness. Ranges that cross a call only
+// get callee saved registers. rax, rcx, rdx and r11 are never allocated, the
+// code generator uses them for division, shifts, calls and spill reloads.
+class RegAlloc {
+ public:
+  static RegAllocResult Run(const IRFunction& f);
+
+ private:
+  struct Interval {
+    VReg reg;
+    int start;
+    int end;
+    bool crosses_call;
+  };
+
+  explicit RegAlloc(const IRFunction& f) : f(f) {}
+  // compute the live interval of each virtual register.
+  void BuildIntervals();
+  void Allocate();
+  // spill an interval into a new stack slot.
+  void Spill(VReg reg);
+
+  const IRFunction& f;
+  std::vector<Interval> intervals{};
+  RegAllocResult res{};
+};
+
+#endif  // !REGALLOC_GRUAD
@@ -11,57 +11,76 @@
 
 #include "scope.h"
 
-// All variable or tag scope instance are accumulated to this list.
-ScopePtr scope = nullptr;
+#include "symbol.h"
 
-void Scope::EnterScope(ScopePtr& next) {
-  auto sc = std::make_shared<Scope>();
-  sc->next = next;
-  next = sc;
-}
+int Scope::depth = 0;
+std::vector<Scope::UndoEntry> Scope::undo_log{};
+std::vector<size_t> Scope::marks{};
 
-void Scope::LevarScope(ScopePtr& next) { next = next->next; }
+void Scope::EnterScope() {
+  marks.push_back(undo_log.size());
+  depth++;
+}
 
-VarScopePtr& Scope::PushVarScope(const String& name) {
-  scope->vars[name] = std::make_shared<VarScope>();
-  return scope->vars[name];
+void Scope::LevarScope() {
+  size_t mark = marks.back();
+  while (undo_log.size() > mark) {
+    UndoEntry& e = undo_log.back();
+    if (e.is_tag) {
+      e.name->tag_stack.pop_back();
+    } else {
+      e.name->var_stack.pop_back();
+    }
+    undo_log.pop_back();
+  }
+  marks.pop_back();
+  depth--;
 }
 
-void Scope::PushTagScope(const String& name, TypePtr ty) {
-  scope->tags[name] = ty;
+VarScopePtr& Scope::PushVarScope(SymbolPtr name) {
+  auto& stack = name->var_stack;
+  // a redefinition in the same scope replaces the previous declaration.
+  if (stack.empty() || stack.back().first != depth) {
+    stack.emplace_back(depth, nullptr);
+    undo_log.push_back({name, false});
+  }
+  stack.back().second = MakeIR<VarScope>();
+  return stack.back().second;
 }
 
-VarScopePtr Scope::FindVarScope(const String& name) {
-  for (ScopePtr sc = scope; sc != nullptr; sc = sc->next) {
-    auto v = sc->vars.find(name);
-    if (v != sc->vars.end()) {
-      return v->second;
-    }
+void Scope::PushTypedef(SymbolPtr name, TypePtr ty) { PushVarScope(name)->tydef = ty; }
+
+void Scope::PushTagScope(SymbolPtr name, TypePtr ty) {
+  auto& stack = name->tag_stack;
+  if (stack.empty() || stack.back().first != depth) {
+    stack.emplace_back(depth, nullptr);
+    undo_log.push_back({name, true});
   }
-  return nullptr;
+  stack.back().second = ty;
 }
 
-TypePtr Scope::FindTag(const String& name) {
-  for (ScopePtr sc = scope; sc != nullptr; sc = sc->next) {
-    auto t = sc->tags.find(name);
-    if (t != sc->tags.end()) {
-      return t->second;
-    }
+VarScopePtr Scope::FindVarScope(SymbolPtr name) {
+  return name->var_stack.empty() ? nullptr : name->var_stack.back().second;
+}
+
+TypePtr Scope::FindTag(SymbolPtr name) {
+  return name->tag_stack.empty() ? nullptr : name->tag_stack.back().second;
+}
+
+TypePtr Scope::FindCurrentTag(SymbolPtr name) {
+  auto& stack = name->tag_stack;
+  if (stack.empty() || stack.back().first != depth) {
+    return nullptr;
   }
-  return nullptr;
+  return stack.back().second;
 }
 
-const TypePtr Scope::FindTypedef(const TokenPtr& tok) {
+TypePtr Scope::FindTypedef(const Token* tok) {
   if (tok->Is<TK_IDENT>()) {
-    VarScopePtr v = FindVarScope(tok->GetIdent());
+    VarScopePtr v = FindVarScope(tok->GetSymbol());
     if (v != nullptr) {
       return v->tydef;
     }
   }
   return nullptr;
 }
-
-template <>
-const ScopePtr& Scope::GetNext<1>(ScopePtr& sc) {
-  return sc->next;
-}
@@ -11,6 +11,8 @@
 #ifndef SCOPE_GRUAD
 #define SCOPE_GRUAD
 
+#include <vector>
+
 #include "object.h"
 #include "tools.h"
 
@@ -48,44 +50,44 @@ struct VarScope {
 
 // C has two block scopes; one is for variables/typedefs and
 // the other is for struct/union/enum tags.
+//
+// Both live in the symbols themselves: every symbol keeps a stack of its
+// visible declarations, so a lookup only looks at the top of one stack.
+// Declarations are also recorded in an undo log, and leaving a scope pops
+// the log back to the mark taken when the scope was entered.
 class Scope {
  public:
-  // get current var scope
-  VarScopeMap& GetVarScope() { return vars; }
-  // get current tag scope
-  TagScopeMap& GetTagScope() { return tags; }
-
   // create a scpoe
-  static void EnterScope(ScopePtr& next);
+  static void EnterScope();
   // delete a scope
-  static void LevarScope(ScopePtr& next);
+  static void LevarScope();
   // find a variable by name.
-  static VarScopePtr FindVarScope(const String& name);
+  static VarScopePtr FindVarScope(SymbolPtr name);
   // find a tag by name.
-  static TypePtr FindTag(const String& name);
+  static TypePtr FindTag(SymbolPtr name);
+  // find a tag by name in the current scope only.
+  static TypePtr FindCurrentTag(SymbolPtr name);
   // find a typedef name by name.
-  static const TypePtr FindTypedef(const TokenPtr& tok);
+  static TypePtr FindTypedef(const Token* tok);
   // create a varscope.
-  static VarScopePtr& PushVarScope(const String& name);
+  static VarScopePtr& PushVarScope(SymbolPtr name);
+  // create a typedef.
+  static void PushTypedef(SymbolPtr name, TypePtr ty);
   // create a tag
-  static void PushTagScope(const String& name, TypePtr ty);
-  // get Next.
-  template <const int nth>
-  static const ScopePtr& GetNext(ScopePtr& sc) {
-    return GetNext<nth - 1>(sc->next);
-  };
+  static void PushTagScope(SymbolPtr name, TypePtr ty);
 
  private:
-  // scope link list.
-  ScopePtr next = nullptr;
-  // Scope for local variables, global variables, typedefs
-  // or enum constants.
-  VarScopeMap vars = VarScopeMap();
-  // Scope for struct, union or enum tags
-  TagScopeMap tags = TagScopeMap();
-};
+  struct UndoEntry {
+    SymbolPtr name;
+    bool is_tag;
+  };
 
-template <>
-const ScopePtr& Scope::GetNext<1>(ScopePtr& sc);
+  // nesting depth of the current scope.
+  static int depth;
+  // declarations of all open scopes in declaration order.
+  static std::vector<UndoEntry> undo_log;
+  // undo log size at the entry of each open scope.
+  static std::vector<size_t> marks;
+};
 
-#endif  // SCOPE_GRUAD
\ No newline at end of file
+#endif  // SCOPE_GRUAD
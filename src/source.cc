@@ -0,0 +1,105 @@
+/*
+ * This project is exclusively owned by QingChuanWS and shall not be used for
+ * commercial and profitting purpose without QingChuanWS's permission.
+ *
+ * @ Author: bingshan45@163.com
+ * @ Github: https://github.com/QingChuanWS
+ * @ Description:
+ *
+ * Copyright (c) 2023 by QingChuanWS, All Rights Reserved.
+ */
+
+#include "source.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+
+#include "lexer.h"
+#include "tools.h"
+#include "utils.h"
+
+static_assert(SourceFile::kPadding >= kScanPadding, "source padding is too small for the scanner.");
+
+SourceFile::SourceFile(const String& file_name) : name(file_name) {
+  // By convention, read from the stdin if the given file name is '-'.
+  if (file_name == "-") {
+    ReadAll(STDIN_FILENO);
+    return;
+  }
+
+  int fd = open(file_name.c_str(), O_RDONLY);
+  if (fd < 0) {
+    Error("cannot open %s: %s", file_name.c_str(), strerror(errno));
+  }
+  if (!MapFile(fd)) {
+    ReadAll(fd);
+  }
+  close(fd);
+}
+
+SourceFile::~SourceFile() {
+  if (map_len != 0) {
+    munmap(const_cast<char*>(data), map_len);
+  }
+}
+
+bool SourceFile::MapFile(int fd) {
+  struct stat st;
+  if (fstat(fd, &st) != 0 || !S_ISREG(st.st_mode) || st.st_size == 0) {
+    return false;
+  }
+
+  // Reserve the file pages plus one more zero page, then map the file over
+  // the head of the reservation. The tail of the last file page is zero
+  // filled by the kernel, so the program is always '\0' terminated.
+  const size_t page = sysconf(_SC_PAGESIZE);
+  const size_t len = static_cast<size_t>(st.st_size);
+  const size_t reserve = (len + page - 1) / page * page + page;
+  void* base = mmap(nullptr, reserve, PROT_READ, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+  if (base == MAP_FAILED) {
+    return false;
+  }
+  if (mmap(base, len, PROT_READ, MAP_PRIVATE | MAP_FIXED, fd, 0) == MAP_FAILED) {
+    munmap(base, reserve);
+    return false;
+  }
+  data = static_cast<const char*>(base);
+  size = len;
+  map_len = reserve;
+  return true;
+}
+
+void SourceFile::ReadAll(int fd) {
+  char chunk[1 << 16];
+  for (;;) {
+    ssize_t n = read(fd, chunk, sizeof(chunk));
+    if (n < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      Error("cannot read %s: %s", name.c_str(), strerror(errno));
+    }
+    if (n == 0) {
+      break;
+    }
+    buf.append(chunk, n);
+  }
+  size = buf.size();
+  buf.append(kPadding, '\0');
+  data = buf.data();
+}
+
+int SourceFile::GetLineNo(const char* loc) const {
+  auto it = std::upper_bound(line_start.begin(), line_start.end(), static_cast<size_t>(loc - data));
+  return static_cast<int>(it - line_start.begin());
+}
+
+const char* SourceFile::GetLineBegin(const char* loc) const {
+  return data + line_start[GetLineNo(loc) - 1];
+}
@@ -0,0 +1,71 @@
+/*
+ * This project is exclusively owned by QingChuanWS and shall not be used for
+ * commercial and profitting purpose without QingChuanWS's permission.
+ *
+ * @ Author: bingshan45@163.com
+ * @ Github: https://github.com/QingChuanWS
+ * @ Description:
+ *
+ * Copyright (c) 2023 by QingChuanWS, All Rights Reserved.
+ */
+
+#ifndef SOURCE_GRUAD
+#define SOURCE_GRUAD
+
+#include <cstddef>
+
+#include "utils.h"
+
+// The source program of a translation unit.
+//
+// A regular file is mapped read-only into memory and directly followed by
+// zero pages, so the tokenizer reads it in place and always finds a '\0'
+// sentinel (plus at least kPadding readable bytes) behind the last byte.
+// Stdin and inputs that can't be mapped are read into a heap buffer with
+// the same zero padding.
+class SourceFile {
+ public:
+  // readable zero bytes guaranteed after the end of the program.
+  static constexpr size_t kPadding = 64;
+
+  explicit SourceFile(const String& file_name);
+  ~SourceFile();
+  SourceFile(const SourceFile&) = delete;
+  SourceFile& operator=(const SourceFile&) = delete;
+
+  // get the first character of the program.
+  inline const char* Begin() const { return data; }
+  // get the terminating '\0' of the program.
+  inline const char* End() const { return data + size; }
+  // get the input file name.
+  inline const String& GetName() const { return name; }
+  // record that a new line starts at `p`, lines must be recorded in order.
+  inline void AddLine(const char* p) { line_start.push_back(static_cast<size_t>(p - data)); }
+  // get the number of the line containing `loc` in O(log n).
+  int GetLineNo(const char* loc) const;
+  // get the first character of the line containing `loc`.
+  const char* GetLineBegin(const char* loc) const;
+
+ private:
+  // try to map a regular file, return false if the caller need fall back to read it.
+  bool MapFile(int fd);
+  // read the whole file into the heap buffer.
+  void ReadAll(int fd);
+
+  // input file name.
+  String name = String();
+  // program content.
+  const char* data = nullptr;
+  // program length without padding.
+  size_t size = 0;
+  // length of the mapped region, zero if the program lives in `buf`.
+  size_t map_len = 0;
+  // heap buffer for unmappable input.
+  String buf = String();
+  // sorted offset of the first character of each line recorded so far.
+  std::vector<size_t> line_start{0};
+};
+
+using SourceFilePtr = std::shared_ptr<SourceFile>;
+
+#endif  // SOURCE_GRUAD
@@ -0,0 +1,539 @@
+/*
+ * This project is exclusively owned by QingChuanWS and shall not be used for
+ * commercial and profitting purpose without QingChuanWS's permission.
+ *
+ * @ Author: bingshan45@163.com
+ * @ Github: https://github.com/QingChuanWS
+ * @ Description:
+ *
+ * Copyright (c) 2023 by QingChuanWS, All Rights Reserved.
+ */
+
+#include "ssa.h"
+
+#include <algorithm>
+
+static void SetBit(std::vector<uint64_t>& set, VReg v) { set[v / 64] |= uint64_t(1) << (v % 64); }
+static bool HasBit(const std::vector<uint64_t>& set, VReg v) { return set[v / 64] >> (v % 64) & 1; }
+
+void SSA::BuildCFG() {
+  size_t n = f.blocks.size();
+  preds.assign(n, {});
+  succs.assign(n, {});
+  for (int b : f.layout) {
+    const IRInst& term = f.blocks[b].insts.back();
+    term.ForEachSucc([&](int s) {
+      if (std::find(succs[b].begin(), succs[b].end(), s) == succs[b].end()) {
+        succs[b].push_back(s);
+        preds[s].push_back(b);
+      }
+    });
+  }
+}
+
+void SSA::BuildDominators() {
+  size_t n = f.blocks.size();
+  int entry = f.layout[0];
+
+  // reverse postorder of the blocks reachable from the entry.
+  std::vector<int> order;
+  std::vector<bool> visited(n, false);
+  std::vector<std::pair<int, size_t>> stack = {{entry, 0}};
+  visited[entry] = true;
+  while (!stack.empty()) {
+    auto& top = stack.back();
+    if (top.second < succs[top.first].size()) {
+      int s = succs[top.first][top.second++];
+      if (!visited[s]) {
+        visited[s] = true;
+        stack.push_back({s, 0});
+      }
+    } else {
+      order.push_back(top.first);
+      stack.pop_back();
+    }
+  }
+  std::reverse(order.begin(), order.end());
+  std::vector<int> rpo(n, -1);
+  for (size_t i = 0; i < order.size(); i++) {
+    rpo[order[i]] = i;
+  }
+
+  // Cooper, Harvey and Kennedy, "A Simple, Fast Dominance Algorithm".
+  idom.assign(n, -1);
+  idom[entry] = entry;
+  auto intersect = [&](int a, int b) {
+    while (a != b) {
+      while (rpo[a] > rpo[b]) {
+        a = idom[a];
+      }
+      while (rpo[b] > rpo[a]) {
+        b = idom[b];
+      }
+    }
+    return a;
+  };
+  bool changed = true;
+  while (changed) {
+    changed = false;
+    for (size_t i = 1; i < order.size(); i++) {
+      int b = order[i];
+      int new_idom = -1;
+      for (int p : preds[b]) {
+        if (idom[p] >= 0) {
+          new_idom = new_idom < 0 ? p : intersect(p, new_idom);
+        }
+      }
+      if (idom[b] != new_idom) {
+        idom[b] = new_idom;
+        changed = true;
+      }
+    }
+  }
+
+  dom_children.assign(n, {});
+  for (int b : order) {
+    if (b != entry) {
+      dom_children[idom[b]].push_back(b);
+    }
+  }
+  pre.assign(n, -1);
+  post.assign(n, -1);
+  int counter = 0;
+  NumberDomTree(entry, counter);
+}
+
+void SSA::NumberDomTree(int block, int& counter) {
+  pre[block] = counter++;
+  for (int child : dom_children[block]) {
+    NumberDomTree(child, counter);
+  }
+  post[block] = counter++;
+}
+
+int SSA::PhiCount(int block) const {
+  const std::vector<IRInst>& insts = f.blocks[block].insts;
+  int n = 0;
+  while (n < static_cast<int>(insts.size()) && insts[n].op == IR_PHI) {
+    n++;
+  }
+  return n;
+}
+
+void SSA::Construct(IRFunction& f) {
+  SSA ssa(f);
+  ssa.BuildCFG();
+  ssa.BuildDominators();
+
+  // the blocks each register is defined in, the parameters in the entry.
+  int entry = f.layout[0];
+  std::vector<std::vector<int>> defs(f.vreg_cnt);
+  std::vector<int> def_cnt(f.vreg_cnt, 0);
+  for (const IRParam& p : f.params) {
+    if (p.reg >= 0) {
+      defs[p.reg].push_back(entry);
+      def_cnt[p.reg]++;
+    }
+  }
+  for (int b : f.layout) {
+    for (const IRInst& inst : f.blocks[b].insts) {
+      if (inst.dst >= 0) {
+        defs[inst.dst].push_back(b);
+        def_cnt[inst.dst]++;
+      }
+    }
+  }
+
+  // rename the registers defined more than once, or read where their only
+  // definition doesn't dominate.
+  std::vector<bool> is_var(f.vreg_cnt, false);
+  std::vector<bool> defined(f.vreg_cnt, false);
+  for (VReg v = 0; v < f.vreg_cnt; v++) {
+    is_var[v] = def_cnt[v] > 1;
+  }
+  for (int b : f.layout) {
+    std::fill(defined.begin(), defined.end(), false);
+    for (const IRInst& inst : f.blocks[b].insts) {
+      inst.ForEachUse([&](VReg v) {
+        bool dominated = defined[v] || (defs[v][0] != b && ssa.Dominates(defs[v][0], b));
+        if (def_cnt[v] == 0 || !dominated) {
+          is_var[v] = true;
+        }
+      });
+      if (inst.dst >= 0) {
+        defined[inst.dst] = true;
+      }
+    }
+  }
+  for (const IRParam& p : f.params) {
+    // the prologue defines the parameters before the entry block.
+    if (p.reg >= 0 && def_cnt[p.reg] == 1) {
+      is_var[p.reg] = false;
+    }
+  }
+
+  ssa.InsertPhis(is_var, defs);
+  ssa.is_var = is_var;
+  ssa.stacks.assign(f.vreg_cnt, {});
+  ssa.undef.assign(f.vreg_cnt, -1);
+  for (const IRParam& p : f.params) {
+    if (p.reg >= 0 && is_var[p.reg]) {
+      ssa.stacks[p.reg].push_back(p.reg);
+    }
+  }
+  ssa.Rename(entry);
+  std::vector<IRInst>& entry_insts = f.blocks[entry].insts;
+  entry_insts.insert(entry_insts.begin(), ssa.undef_insts.begin(), ssa.undef_insts.end());
+  ssa.RemoveDeadPhis();
+}
+
+void SSA::InsertPhis(const std::vector<bool>& is_var, const std::vector<std::vector<int>>& defs) {
+  // the dominance frontier of each block.
+  size_t n = f.blocks.size();
+  std::vector<std::vector<int>> frontier(n);
+  for (int b : f.layout) {
+    if (preds[b].size() < 2) {
+      continue;
+    }
+    for (int p : preds[b]) {
+      for (int runner = p; runner != idom[b]; runner = idom[runner]) {
+        if (frontier[runner].empty() || frontier[runner].back() != b) {
+          frontier[runner].push_back(b);
+        }
+      }
+    }
+  }
+
+  phi_vars.assign(n, {});
+  std::vector<int> has_phi(n, -1), queued(n, -1);
+  for (VReg v = 0; v < f.vreg_cnt; v++) {
+    if (!is_var[v]) {
+      continue;
+    }
+    std::vector<int> work;
+    for (int b : defs[v]) {
+      if (queued[b] != v) {
+        queued[b] = v;
+        work.push_back(b);
+      }
+    }
+    while (!work.empty()) {
+      int b = work.back();
+      work.pop_back();
+      for (int y : frontier[b]) {
+        if (has_phi[y] == v) {
+          continue;
+        }
+        has_phi[y] = v;
+        IRInst phi;
+        phi.op = IR_PHI;
+        phi.dst = v;
+        f.blocks[y].insts.insert(f.blocks[y].insts.begin() + phi_vars[y].size(), phi);
+        phi_vars[y].push_back(v);
+        if (queued[y] != v) {
+          queued[y] = v;
+          work.push_back(y);
+        }
+      }
+    }
+  }
+}
+
+VReg SSA::CurrentDef(VReg var) {
+  if (!stacks[var].empty()) {
+    return stacks[var].back();
+  }
+  // read before any write, the value is undefined.
+  if (undef[var] < 0) {
+    IRInst inst;
+    inst.op = IR_IMM;
+    inst.dst = f.NewReg(f.types[var]);
+    undef[var] = inst.dst;
+    undef_insts.push_back(inst);
+  }
+  return undef[var];
+}
+
+void SSA::Rename(int block) {
+  std::vector<VReg> pushed;
+  auto define = [&](VReg& dst) {
+    VReg var = dst;
+    dst = f.NewReg(f.types[var]);
+    stacks[var].push_back(dst);
+    pushed.push_back(var);
+  };
+  auto use = [&](VReg& v) {
+    if (v >= 0 && v < static_cast<VReg>(is_var.size()) && is_var[v]) {
+      v = CurrentDef(v);
+    }
+  };
+
+  for (IRInst& inst : f.blocks[block].insts) {
+    if (inst.op != IR_PHI) {
+      use(inst.a);
+      use(inst.b);
+      for (VReg& v : inst.args) {
+        use(v);
+      }
+    }
+    if (inst.dst >= 0 && is_var[inst.dst]) {
+      define(inst.dst);
+    }
+  }
+  for (int s : succs[block]) {
+    for (size_t i = 0; i < phi_vars[s].size(); i++) {
+      IRInst& phi = f.blocks[s].insts[i];
+      phi.args.push_back(CurrentDef(phi_vars[s][i]));
+      phi.from.push_back(block);
+    }
+  }
+  for (int child : dom_children[block]) {
+    Rename(child);
+  }
+  for (VReg var : pushed) {
+    stacks[var].pop_back();
+  }
+}
+
+void SSA::RemoveDeadPhis() {
+  // a phi is live if a non phi instruction reads it, directly or through phis.
+  std::vector<const IRInst*> phi_of(f.vreg_cnt, nullptr);
+  std::vector<bool> live(f.vreg_cnt, false);
+  std::vector<VReg> work;
+  for (int b : f.layout) {
+    for (const IRInst& inst : f.blocks[b].insts) {
+      if (inst.op == IR_PHI) {
+        phi_of[inst.dst] = &inst;
+        continue;
+      }
+      inst.ForEachUse([&](VReg v) {
+        if (!live[v]) {
+          live[v] = true;
+          work.push_back(v);
+        }
+      });
+    }
+  }
+  while (!work.empty()) {
+    VReg v = work.back();
+    work.pop_back();
+    if (phi_of[v] == nullptr) {
+      continue;
+    }
+    for (VReg arg : phi_of[v]->args) {
+      if (!live[arg]) {
+        live[arg] = true;
+        work.push_back(arg);
+      }
+    }
+  }
+  // the zero definitions only the dead phis read go too.
+  for (const IRInst& inst : undef_insts) {
+    phi_of[inst.dst] = &inst;
+  }
+  for (int b : f.layout) {
+    std::vector<IRInst>& insts = f.blocks[b].insts;
+    insts.erase(std::remove_if(insts.begin(), insts.end(),
+                               [&](const IRInst& inst) {
+                                 return inst.dst >= 0 && phi_of[inst.dst] != nullptr &&
+                                        !live[inst.dst];
+                               }),
+                insts.end());
+  }
+}
+
+void SSA::BuildLiveness() {
+  size_t words = (f.vreg_cnt + 63) / 64;
+  size_t n = f.blocks.size();
+  def_block.assign(f.vreg_cnt, -1);
+  def_index.assign(f.vreg_cnt, 0);
+  for (const IRParam& p : f.params) {
+    if (p.reg >= 0) {
+      def_block[p.reg] = f.layout[0];
+      def_index[p.reg] = -2;
+    }
+  }
+
+  std::vector<std::vector<uint64_t>> use(n), def(n), live_in(n);
+  live_out.assign(n, {});
+  for (int b : f.layout) {
+    use[b].assign(words, 0);
+    def[b].assign(words, 0);
+    live_in[b].assign(words, 0);
+    live_out[b].assign(words, 0);
+    const std::vector<IRInst>& insts = f.blocks[b].insts;
+    for (size_t i = 0; i < insts.size(); i++) {
+      const IRInst& inst = insts[i];
+      if (inst.op != IR_PHI) {
+        inst.ForEachUse([&](VReg v) {
+          if (!HasBit(def[b], v)) {
+            SetBit(use[b], v);
+          }
+        });
+      }
+      if (inst.dst >= 0) {
+        SetBit(def[b], inst.dst);
+        def_block[inst.dst] = b;
+        def_index[inst.dst] = inst.op == IR_PHI ? -1 : i;
+      }
+    }
+  }
+
+  // the operands of a phi are read at the end of their predecessors.
+  bool changed = true;
+  while (changed) {
+    changed = false;
+    for (auto it = f.layout.rbegin(); it != f.layout.rend(); it++) {
+      int b = *it;
+      for (int s : succs[b]) {
+        for (size_t w = 0; w < words; w++) {
+          live_out[b][w] |= live_in[s][w];
+        }
+        for (int i = 0; i < PhiCount(s); i++) {
+          const IRInst& phi = f.blocks[s].insts[i];
+          for (size_t k = 0; k < phi.args.size(); k++) {
+            if (phi.from[k] == b) {
+              SetBit(live_out[b], phi.args[k]);
+            }
+          }
+        }
+      }
+      for (size_t w = 0; w < words; w++) {
+        uint64_t in = use[b][w] | (live_out[b][w] & ~def[b][w]);
+        if (in != live_in[b][w]) {
+          live_in[b][w] = in;
+          changed = true;
+        }
+      }
+    }
+  }
+}
+
+bool SSA::LiveAfter(VReg v, int block, int index) const {
+  if (HasBit(live_out[block], v)) {
+    return true;
+  }
+  const std::vector<IRInst>& insts = f.blocks[block].insts;
+  for (size_t i = std::max(index + 1, 0); i < insts.size(); i++) {
+    bool used = false;
+    if (insts[i].op != IR_PHI) {
+      insts[i].ForEachUse([&](VReg u) { used |= u == v; });
+    }
+    if (used) {
+      return true;
+    }
+  }
+  return false;
+}
+
+bool SSA::Interfere(VReg a, VReg b) const {
+  // in strict SSA form two values overlap iff one is live where the other,
+  // dominated by it, is defined.
+  auto dominates = [&](VReg x, VReg y) {
+    if (def_block[x] == def_block[y]) {
+      return def_index[x] <= def_index[y];
+    }
+    return Dominates(def_block[x], def_block[y]);
+  };
+  if (a == b || def_block[a] < 0 || def_block[b] < 0) {
+    return false;
+  }
+  if (dominates(a, b) && LiveAfter(a, def_block[b], def_index[b])) {
+    return true;
+  }
+  return dominates(b, a) && LiveAfter(b, def_block[a], def_index[a]);
+}
+
+VReg SSA::Find(VReg v) {
+  while (parent[v] != v) {
+    parent[v] = parent[parent[v]];
+    v = parent[v];
+  }
+  return v;
+}
+
+void SSA::LowerPhi(int block, int index) {
+  IRInst phi = f.blocks[block].insts[index];
+  VReg tmp = f.NewReg(f.types[phi.dst]);
+  for (size_t k = 0; k < phi.args.size(); k++) {
+    // the copy may run on the way to another successor too, where tmp is dead.
+    std::vector<IRInst>& insts = f.blocks[phi.from[k]].insts;
+    insts.insert(insts.end() - 1, {IR_MOV, 8, tmp, phi.args[k]});
+  }
+  std::vector<IRInst>& insts = f.blocks[block].insts;
+  insts.insert(insts.begin() + PhiCount(block), {IR_MOV, 8, phi.dst, tmp});
+}
+
+void SSA::Destruct(IRFunction& f) {
+  SSA ssa(f);
+  ssa.BuildCFG();
+  ssa.BuildDominators();
+  ssa.BuildLiveness();
+
+  ssa.parent.resize(f.vreg_cnt);
+  ssa.members.resize(f.vreg_cnt);
+  for (VReg v = 0; v < f.vreg_cnt; v++) {
+    ssa.parent[v] = v;
+    ssa.members[v] = {v};
+  }
+
+  for (int b : f.layout) {
+    // lowering inserts copies after the phis, so go from the last one.
+    for (int i = ssa.PhiCount(b) - 1; i >= 0; i--) {
+      const IRInst& phi = f.blocks[b].insts[i];
+      std::vector<VReg> roots = {ssa.Find(phi.dst)};
+      for (VReg arg : phi.args) {
+        VReg root = ssa.Find(arg);
+        if (std::find(roots.begin(), roots.end(), root) == roots.end()) {
+          roots.push_back(root);
+        }
+      }
+      bool interfere = false;
+      for (size_t x = 0; x < roots.size() && !interfere; x++) {
+        for (size_t y = x + 1; y < roots.size() && !interfere; y++) {
+          for (VReg m : ssa.members[roots[x]]) {
+            for (VReg n : ssa.members[roots[y]]) {
+              interfere |= ssa.Interfere(m, n);
+            }
+          }
+        }
+      }
+      if (interfere) {
+        ssa.LowerPhi(b, i);
+        continue;
+      }
+      for (size_t x = 1; x < roots.size(); x++) {
+        ssa.parent[roots[x]] = roots[0];
+        std::vector<VReg>& into = ssa.members[roots[0]];
+        into.insert(into.end(), ssa.members[roots[x]].begin(), ssa.members[roots[x]].end());
+        ssa.members[roots[x]].clear();
+      }
+    }
+  }
+
+  // the registers of a class are one register again, and the phis go away.
+  ssa.parent.resize(f.vreg_cnt);
+  for (VReg v = ssa.members.size(); v < f.vreg_cnt; v++) {
+    ssa.parent[v] = v;
+  }
+  auto rename = [&](VReg& v) {
+    if (v >= 0) {
+      v = ssa.Find(v);
+    }
+  };
+  for (IRParam& p : f.params) {
+    rename(p.reg);
+  }
+  for (int b : f.layout) {
+    std::vector<IRInst>& insts = f.blocks[b].insts;
+    insts.erase(insts.begin(), insts.begin() + ssa.PhiCount(b));
+    for (IRInst& inst : insts) {
+      rename(inst.dst);
+      rename(inst.a);
+      rename(inst.b);
+      for (VReg& v : inst.args) {
+        rename(v);
+      }
+    }
+  }
+}
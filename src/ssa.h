@@ -0,0 +1,90 @@
+/*
+ * This project is exclusively owned by QingChuanWS and shall not be used for
+ * commercial and profitting purpose without QingChuanWS's permission.
+ *
+ * @ Author: bingshan45@163.com
+ * @ Github: https://github.com/QingChuanWS
+ * @ Description:
+ *
+ * Copyright (c) 2023 by QingChuanWS, All Rights Reserved.
+ */
+
+#ifndef SSA_GRUAD
+#define SSA_GRUAD
+
+#include <cstdint>
+#include <vector>
+
+#include "ir.h"
+
+// Conversion of the virtual register IR into and out of SSA form.
+//
+// Construct gives every definition its own virtual register and joins them
+// with phi nodes at the dominance frontiers. A register read on some path
+// before it is written gets a zero definition in the entry block, so every
+// definition dominates its uses.
+//
+// Destruct gives a phi and its operands one register if none of their live
+// ranges overlap, which holds until a pass moves code across definitions.
+// Otherwise the phi is replaced by copies through a fresh register at the end
+// of each predecessor.
+class SSA {
+ public:
+  static void Construct(IRFunction& f);
+  static void Destruct(IRFunction& f);
+
+ private:
+  explicit SSA(IRFunction& f) : f(f) {}
+
+  // predecessors, successors and the dominator tree of the reachable blocks.
+  void BuildCFG();
+  void BuildDominators();
+  void NumberDomTree(int block, int& counter);
+  bool Dominates(int a, int b) const { return pre[a] <= pre[b] && post[b] <= post[a]; }
+  int PhiCount(int block) const;
+
+  // Construct.
+  void InsertPhis(const std::vector<bool>& is_var, const std::vector<std::vector<int>>& defs);
+  void Rename(int block);
+  VReg CurrentDef(VReg var);
+  void RemoveDeadPhis();
+
+  // Destruct.
+  void BuildLiveness();
+  // whether v is still needed after the index-th instruction of block, -1 is
+  // the point the phis are defined at.
+  bool LiveAfter(VReg v, int block, int index) const;
+  bool Interfere(VReg a, VReg b) const;
+  VReg Find(VReg v);
+  // replace the phi at index of block by copies.
+  void LowerPhi(int block, int index);
+
+  IRFunction& f;
+  std::vector<std::vector<int>> preds{};
+  std::vector<std::vector<int>> succs{};
+  std::vector<int> idom{};
+  std::vector<std::vector<int>> dom_children{};
+  // dominator tree pre and post order numbers.
+  std::vector<int> pre{};
+  std::vector<int> post{};
+
+  // the variable each phi of a block merges, in the order of the phis.
+  std::vector<std::vector<VReg>> phi_vars{};
+  // the registers Construct renames and the definitions reaching the current
+  // block of each of them.
+  std::vector<bool> is_var{};
+  std::vector<std::vector<VReg>> stacks{};
+  // the zero definitions of the registers read before they are written.
+  std::vector<VReg> undef{};
+  std::vector<IRInst> undef_insts{};
+
+  // block and instruction index of each definition, -2 for the parameters.
+  std::vector<int> def_block{};
+  std::vector<int> def_index{};
+  std::vector<std::vector<uint64_t>> live_out{};
+  // congruence classes of the registers a phi may share.
+  std::vector<VReg> parent{};
+  std::vector<std::vector<VReg>> members{};
+};
+
+#endif  // !SSA_GRUAD
@@ -0,0 +1,175 @@
+/*
+ * This project is exclusively owned by QingChuanWS and shall not be used for
+ * commercial and profitting purpose without QingChuanWS's permission.
+ *
+ * @ Author: bingshan45@163.com
+ * @ Github: https://github.com/QingChuanWS
+ * @ Description:
+ *
+ * Copyright (c) 2023 by QingChuanWS, All Rights Reserved.
+ */
+
+#include "strength.h"
+
+// the value of the low sz bytes of v.
+static int64_t Truncate(uint64_t v, int sz) {
+  return sz == 4 ? static_cast<int32_t>(v) : static_cast<int64_t>(v);
+}
+
+static int TrailingZeros(uint64_t v) {
+  int n = 0;
+  while ((v & 1) == 0) {
+    v >>= 1;
+    n++;
+  }
+  return n;
+}
+
+bool StrengthReduce::Mul(AsmBuffer& out, AsmReg reg, int64_t c, int sz) {
+  c = Truncate(c, sz);
+  AsmOperand r = Reg(reg, sz);
+  if (c == 0) {
+    out.push_back({I_MOV, r, Imm(0)});
+    return true;
+  }
+
+  // c = +-odd * 2^shift, and odd has to be a product of at most two of the
+  // factors lea can multiply by.
+  uint64_t odd = c < 0 ? 0 - static_cast<uint64_t>(c) : c;
+  int shift = TrailingZeros(odd);
+  odd >>= shift;
+  int leas[2];
+  int nlea = 0;
+  for (int f : {9, 5, 3}) {
+    while (nlea < 2 && odd % f == 0) {
+      leas[nlea++] = f;
+      odd /= f;
+    }
+  }
+  // imul takes 3 cycles, every instruction here one.
+  if (odd != 1 || nlea + (shift > 0) + (c < 0) > 2) {
+    return false;
+  }
+
+  for (int i = 0; i < nlea; i++) {
+    out.push_back({I_LEA, r, IndexMem(reg, reg, leas[i] - 1)});
+  }
+  if (shift > 0) {
+    out.push_back({I_SHL, r, Imm(shift)});
+  }
+  if (c < 0) {
+    out.push_back({I_NEG, r});
+  }
+  return true;
+}
+
+bool StrengthReduce::DivMod(AsmBuffer& out, int64_t c, int sz, bool mod) {
+  c = Truncate(c, sz);
+  if (c == 0 || c == -1) {
+    return false;
+  }
+  int bits = sz * 8;
+  AsmOperand ax = Reg(REG_AX, sz);
+  AsmOperand cx = Reg(REG_CX, sz);
+  AsmOperand dx = Reg(REG_DX, sz);
+  if (c == 1) {
+    if (mod) {
+      out.push_back({I_MOV, ax, Imm(0)});
+    }
+    return true;
+  }
+
+  uint64_t abs = c < 0 ? 0 - static_cast<uint64_t>(c) : c;
+  if ((abs & (abs - 1)) == 0) {
+    // a shift rounds toward negative infinity, adding 2^k - 1 to a negative
+    // dividend first makes it round toward zero.
+    int k = TrailingZeros(abs);
+    out.push_back({I_MOV, dx, ax});
+    if (k > 1) {
+      out.push_back({I_SAR, dx, Imm(bits - 1)});
+    }
+    out.push_back({I_SHR, dx, Imm(bits - k)});
+    if (!mod) {
+      out.push_back({I_ADD, ax, dx});
+      out.push_back({I_SAR, ax, Imm(k)});
+      if (c < 0) {
+        out.push_back({I_NEG, ax});
+      }
+      return true;
+    }
+    // x % 2^k = x - ((x + bias) & -2^k), the mask only fits an immediate below 2^31.
+    out.push_back({I_ADD, dx, ax});
+    if (k < 32) {
+      out.push_back({I_AND, dx, Imm(-(int64_t{1} << k))});
+    } else {
+      out.push_back({I_SAR, dx, Imm(k)});
+      out.push_back({I_SHL, dx, Imm(k)});
+    }
+    out.push_back({I_SUB, ax, dx});
+    return true;
+  }
+
+  // q = hi(x * mul) >> shift, rounded toward zero by adding its sign bit.
+  Magic m = SignedMagic(c, bits);
+  out.push_back({I_MOV, cx, ax});
+  out.push_back({I_MOV, dx, Imm(m.mul)});
+  out.push_back({I_IMUL, dx});
+  if (c > 0 && m.mul < 0) {
+    out.push_back({I_ADD, dx, cx});
+  } else if (c < 0 && m.mul > 0) {
+    out.push_back({I_SUB, dx, cx});
+  }
+  if (m.shift > 0) {
+    out.push_back({I_SAR, dx, Imm(m.shift)});
+  }
+  out.push_back({I_MOV, ax, dx});
+  out.push_back({I_SHR, ax, Imm(bits - 1)});
+  out.push_back({I_ADD, ax, dx});
+  if (!mod) {
+    return true;
+  }
+  // x % c = x - q * c.
+  if (!Mul(out, REG_AX, c, sz)) {
+    out.push_back({I_MOV, dx, Imm(c)});
+    out.push_back({I_IMUL, ax, dx});
+  }
+  out.push_back({I_SUB, cx, ax});
+  out.push_back({I_MOV, ax, cx});
+  return true;
+}
+
+StrengthReduce::Magic StrengthReduce::SignedMagic(int64_t c, int bits) {
+  // all arithmetic is unsigned and modulo 2^bits.
+  uint64_t mask = bits == 64 ? ~uint64_t{0} : (uint64_t{1} << bits) - 1;
+  uint64_t two = uint64_t{1} << (bits - 1);
+  uint64_t ad = c < 0 ? 0 - static_cast<uint64_t>(c) : c;
+  uint64_t t = two + (c < 0);
+  // the largest dividend whose remainder is ad - 1.
+  uint64_t anc = t - 1 - t % ad;
+  int p = bits - 1;
+  uint64_t q1 = two / anc, r1 = two - q1 * anc;
+  uint64_t q2 = two / ad, r2 = two - q2 * ad;
+  uint64_t delta;
+  do {
+    p++;
+    q1 = 2 * q1 & mask;
+    r1 = 2 * r1;
+    if (r1 >= anc) {
+      q1++;
+      r1 -= anc;
+    }
+    q2 = 2 * q2 & mask;
+    r2 = 2 * r2;
+    if (r2 >= ad) {
+      q2++;
+      r2 -= ad;
+    }
+    delta = ad - r2;
+  } while (q1 < delta || (q1 == delta && r1 == 0));
+
+  uint64_t mul = (q2 + 1) & mask;
+  if (c < 0) {
+    mul = (0 - mul) & mask;
+  }
+  return {Truncate(mul, bits / 8), p - bits};
+}
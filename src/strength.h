@@ -0,0 +1,43 @@
+/*
+ * This project is exclusively owned by QingChuanWS and shall not be used for
+ * commercial and profitting purpose without QingChuanWS's permission.
+ *
+ * @ Author: bingshan45@163.com
+ * @ Github: https://github.com/QingChuanWS
+ * @ Description:
+ *
+ * Copyright (c) 2023 by QingChuanWS, All Rights Reserved.
+ */
+
+#ifndef STRENGTH_GRUAD
+#define STRENGTH_GRUAD
+
+#include <cstdint>
+
+#include "asm_inst.h"
+
+// Cheaper instruction sequences for signed multiplication, division and
+// remainder by a constant, on sz byte operands.
+//
+// Both return false without emitting anything if the constant has no sequence
+// cheaper than imul or idiv. Division by 0 and -1 is left to idiv, so its
+// traps stay where they are.
+class StrengthReduce {
+ public:
+  // reg *= c with shifts, lea and neg, touching no other register.
+  static bool Mul(AsmBuffer& out, AsmReg reg, int64_t c, int sz);
+  // rax = rax / c or rax % c with shifts or a multiply by the magic number of
+  // c, clobbering rcx and rdx.
+  static bool DivMod(AsmBuffer& out, int64_t c, int sz, bool mod);
+
+ private:
+  struct Magic {
+    int64_t mul;
+    int shift;
+  };
+  // the multiplier and shift of Hacker's Delight 10-1 for a bits wide division
+  // by c, with 2 <= |c| < 2^(bits-1) not a power of two.
+  static Magic SignedMagic(int64_t c, int bits);
+};
+
+#endif  // !STRENGTH_GRUAD
@@ -39,7 +39,6 @@ int Member::CalcuStructOffset(const MemPtrVector& mem) {
 // struct-decl = "{" struct or union member
 MemPtrVector Member::MemberDecl(TokenPtr* rest, TokenPtr tok, ASTree& ct) {
   tok = tok->SkipToken("{");
-  auto head = std::make_shared<Member>();
   MemPtrVector mem_vec;
 
   while (!tok->Equal("}")) {
@@ -52,7 +51,7 @@ MemPtrVector Member::MemberDecl(TokenPtr* rest, TokenPtr tok, ASTree& ct) {
       }
       first = false;
       TypePtr ty = Parser::Declarator(&tok, tok, basety, ct);
-      mem_vec.push_back(std::make_shared<Member>(ty, ty->GetName()));
+      mem_vec.push_back(MakeIR<Member>(ty, ty->GetName()));
     }
     tok = tok->SkipToken(";");
   }
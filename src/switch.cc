@@ -0,0 +1,84 @@
+/*
+ * This project is exclusively owned by QingChuanWS and shall not be used for
+ * commercial and profitting purpose without QingChuanWS's permission.
+ *
+ * @ Author: bingshan45@163.com
+ * @ Github: https://github.com/QingChuanWS
+ * @ Description:
+ *
+ * Copyright (c) 2023 by QingChuanWS, All Rights Reserved.
+ */
+
+#include "switch.h"
+
+#include <algorithm>
+
+#include "type.h"
+
+int SwitchLowering::Size(const NodePtr& node) { return node->ext->cond->ty->Size() == 8 ? 8 : 4; }
+
+int SwitchLowering::MissLabel(const NodePtr& node) {
+  const NodePtr& dflt = node->ext->default_node;
+  return dflt != nullptr ? dflt->ext->unique_label : node->ext->break_label;
+}
+
+std::vector<SwitchCase> SwitchLowering::Cases(const NodePtr& node) {
+  int sz = Size(node);
+  std::vector<SwitchCase> cases;
+  for (const NodePtr& c : node->ext->case_nodes) {
+    // an int switch only compares the low 32 bits of a case value.
+    cases.push_back({sz == 8 ? c->val : static_cast<int32_t>(c->val), c->ext->unique_label});
+  }
+  std::sort(cases.begin(), cases.end());
+  return cases;
+}
+
+bool SwitchLowering::IsDenseSwitch(const std::vector<SwitchCase>& cases) {
+  if (cases.size() < kMinCases) {
+    return false;
+  }
+  uint64_t span = static_cast<uint64_t>(cases.back().first) - cases.front().first;
+  return span < kMaxTable && span < kMaxSparsity * cases.size();
+}
+
+std::vector<int> SwitchLowering::Targets(const std::vector<SwitchCase>& cases) {
+  int64_t min = cases.front().first;
+  std::vector<int> targets(static_cast<uint64_t>(cases.back().first) - min + 1, -1);
+  // the first of several cases with the same value is the one taken.
+  for (auto c = cases.rbegin(); c != cases.rend(); c++) {
+    targets[static_cast<uint64_t>(c->first) - min] = c->second;
+  }
+  return targets;
+}
+
+void SwitchLowering::EmitTable(AsmBuffer& out, const AsmOperand& value, int sz, int64_t min,
+                               const std::vector<AsmOperand>& targets, const AsmOperand& miss,
+                               AsmReg base, int id) {
+  AsmOperand ax = Reg(REG_AX, sz);
+  AsmOperand rax = Reg(REG_AX);
+  // the unsigned distance from the smallest case checks both bounds at once. A
+  // 32 bit move or subtraction also clears the upper half of rax.
+  bool extended = value.kind != AsmOperand::OPD_REG || value.reg != REG_AX;
+  if (extended) {
+    out.push_back({I_MOV, ax, value});
+  }
+  if (!FitsInt32(min)) {
+    out.push_back({I_MOV, Reg(base), Imm(min)});
+    out.push_back({I_SUB, rax, Reg(base)});
+  } else if (min != 0 || (sz == 4 && !extended)) {
+    out.push_back({I_SUB, ax, Imm(min)});
+  }
+  out.push_back({I_CMP, ax, Imm(targets.size() - 1)});
+  out.push_back({I_JA, miss});
+
+  // each entry holds the distance of its case from the table.
+  AsmOperand table = Label(LB_TABLE, id);
+  out.push_back({I_LEA, Reg(base), RipMem(LB_TABLE, id)});
+  out.push_back({I_MOVSXD, rax, IndexMem(base, REG_AX, 4, 4)});
+  out.push_back({I_ADD, rax, Reg(base)});
+  out.push_back({I_JMP, rax});
+  out.push_back({AS_LABEL, table});
+  for (const AsmOperand& target : targets) {
+    out.push_back({AS_OFFSET, target, table});
+  }
+}
@@ -0,0 +1,56 @@
+/*
+ * This project is exclusively owned by QingChuanWS and shall not be used for
+ * commercial and profitting purpose without QingChuanWS's permission.
+ *
+ * @ Author: bingshan45@163.com
+ * @ Github: https://github.com/QingChuanWS
+ * @ Description:
+ *
+ * Copyright (c) 2023 by QingChuanWS, All Rights Reserved.
+ */
+
+#ifndef SWITCH_GRUAD
+#define SWITCH_GRUAD
+
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+#include "asm_inst.h"
+#include "node.h"
+
+// a switch case value and the label of its statement.
+using SwitchCase = std::pair<int64_t, int>;
+
+// Switch lowering shared by the -O0 and -O1 backends.
+//
+// A switch jumps through a table when it has at least kMinCases cases, at most
+// kMaxTable table entries and kMaxSparsity entries per case. Otherwise it does
+// a binary search over the sorted cases, comparing ranges of fewer than
+// kMinCases cases one by one.
+class SwitchLowering {
+ public:
+  static constexpr size_t kMinCases = 4;
+  static constexpr uint64_t kMaxTable = 4096;
+  static constexpr uint64_t kMaxSparsity = 3;
+
+  // size in bytes the value of a switch is compared in.
+  static int Size(const NodePtr& node);
+  // label of the default statement, or of the end of the switch if there is none.
+  static int MissLabel(const NodePtr& node);
+  // the cases of a switch sorted by value.
+  static std::vector<SwitchCase> Cases(const NodePtr& node);
+  static bool IsDenseSwitch(const std::vector<SwitchCase>& cases);
+  // the case label of each value from the smallest case to the largest, -1 for
+  // the values without a case.
+  static std::vector<int> Targets(const std::vector<SwitchCase>& cases);
+  // jump to targets[value - min], or to miss if value - min is out of range,
+  // for a switch value of sz bytes. Clobbers rax and base, the table gets
+  // label id.
+  static void EmitTable(AsmBuffer& out, const AsmOperand& value, int sz, int64_t min,
+                        const std::vector<AsmOperand>& targets, const AsmOperand& miss,
+                        AsmReg base, int id);
+};
+
+#endif  // !SWITCH_GRUAD
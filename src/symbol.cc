@@ -0,0 +1,32 @@
+/*
+ * This project is exclusively owned by QingChuanWS and shall not be used for
+ * commercial and profitting purpose without QingChuanWS's permission.
+ *
+ * @ Author: bingshan45@163.com
+ * @ Github: https://github.com/QingChuanWS
+ * @ Description:
+ *
+ * Copyright (c) 2023 by QingChuanWS, All Rights Reserved.
+ */
+
+#include "symbol.h"
+
+#include <string_view>
+#include <unordered_map>
+
+#include "arena.h"
+
+// Symbols live in an arena, so the name buffer referenced by the table key
+// stays at the same address for the whole compilation.
+static Arena<Symbol> symbol_arena;
+static std::unordered_map<std::string_view, SymbolPtr> symbol_table;
+
+SymbolPtr Symbol::Intern(const char* str, int len) {
+  auto it = symbol_table.find(std::string_view(str, len));
+  if (it != symbol_table.end()) {
+    return it->second;
+  }
+  SymbolPtr sym = symbol_arena.Create(str, len);
+  symbol_table.emplace(std::string_view(sym->name), sym);
+  return sym;
+}
@@ -0,0 +1,47 @@
+/*
+ * This project is exclusively owned by QingChuanWS and shall not be used for
+ * commercial and profitting purpose without QingChuanWS's permission.
+ *
+ * @ Author: bingshan45@163.com
+ * @ Github: https://github.com/QingChuanWS
+ * @ Description:
+ *
+ * Copyright (c) 2023 by QingChuanWS, All Rights Reserved.
+ */
+
+#ifndef SYMBOL_GRUAD
+#define SYMBOL_GRUAD
+
+#include <utility>
+#include <vector>
+
+#include "utils.h"
+
+// An interned name.
+//
+// Every distinct name of the translation unit is stored exactly once in the
+// symbol table, so two names are equal if and only if their symbols are the
+// same pointer. Identifier tokens are interned when they are scanned.
+class Symbol {
+ public:
+  explicit Symbol(const char* str, int len) : name(str, len) {}
+  // get the symbol name.
+  inline const String& GetName() const { return name; }
+
+  // get the unique symbol of [str, str + len), create it at the first time.
+  static SymbolPtr Intern(const char* str, int len);
+  // get the unique symbol of name.
+  static SymbolPtr Intern(const String& name) { return Intern(name.data(), name.size()); }
+
+ private:
+  friend class Scope;
+
+  // symbol name.
+  String name;
+  // shadow stacks of the visible declarations of this name as (scope depth,
+  // declaration) pairs, the innermost one at the back. See scope.cc.
+  std::vector<std::pair<int, VarScopePtr>> var_stack{};
+  std::vector<std::pair<int, TypePtr>> tag_stack{};
+};
+
+#endif  // SYMBOL_GRUAD
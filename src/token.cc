@@ -25,39 +25,20 @@
 #include <ostream>
 #include <vector>
 
+#include "lexer.h"
 #include "object.h"
 #include "scope.h"
+#include "source.h"
+#include "symbol.h"
 #include "tools.h"
 #include "utils.h"
 
-// intput file name.
-String current_filename;
+// input program.
+SourceFilePtr prg;
 
-// input string.
-StringPtr prg;
-
-const std::vector<const char*> keyword = {"return", "if",       "else",   "for",   "while",  "int",
-                                          "sizeof", "char",     "struct", "union", "short",  "long",
-                                          "void",   "typedef",  "_Bool",  "enum",  "static", "goto",
-                                          "break",  "continue", "switch", "case",  "default"};
-
-const std::vector<const char*> type_name = {"void",    "char",   "short", "int",
-                                            "long",    "struct", "union", "struct",
-                                            "typedef", "_Bool",  "enum",  "static"};
-
-const std::vector<const char*> ops = {"<<=", ">>=", ">=", "==", "!=", "<=", "->",
-                                      "+=",  "-=",  "*=", "/=", "++", "--", "%=",
-                                      "&=",  "|=",  "^=", "&&", "||", "<<", ">>"};
-
-// read punction.
-inline int ReadPunct(const char* p) {
-  for (auto& op : ops) {
-    if (StrEqual(p, op, strlen(op))) {
-      return strlen(op);
-    }
-  }
-  return std::ispunct(*p) ? 1 : 0;
-}
+// All tokens of the translation unit are allocated from this arena, so the
+// token list is laid out contiguously and released together at exit.
+static Arena<Token, 4096> token_arena;
 
 // convert char c to hex format
 static int FromHex(const char c) {
@@ -132,36 +113,6 @@ static int ReadEscapeedChar(const char** new_pos, const char* p) {
   }
 }
 
-// read code from filename.
-static StringStream ReadFromFile(const String& filename) {
-  StringStream buf;
-  // By convention, read from the stdin if the given file name is '-'.
-  if (filename == "-") {
-    buf << std::cin.rdbuf();
-    return buf;
-  }
-
-  std::ifstream input(filename);
-  if (!input.is_open()) {
-    Error("cannot open %s: %s", filename.c_str(), strerror(errno));
-  }
-  buf << input.rdbuf();
-  input.close();
-  return buf;
-}
-
-// return the contents of given file.
-static StringPtr ReadFile(const String& filename) {
-  auto program = String(ReadFromFile(filename).str());
-  // Make sure that the last line is properly terminated with '\n'
-  if (program.size() == 0 || program[program.size() - 1] != '\n') {
-    program.push_back('\n');
-  }
-  program.push_back('\0');
-
-  return std::make_shared<String>(std::move(program));
-}
-
 TokenPtr Token::ReadIntLiteral(const char* start) {
   const char* p = start;
 
@@ -181,7 +132,7 @@ TokenPtr Token::ReadIntLiteral(const char* start) {
   if (std::isalnum(*res_p)) {
     Error("%c is invaild digit");
   }
-  auto res = std::make_shared<Token>(TK_NUM, start, res_p - start);
+  TokenPtr res = Create(TK_NUM, start, res_p - start);
   res->val = val;
   return res;
 }
@@ -197,7 +148,7 @@ TokenPtr Token::CreateStringToken(const char* start, const char* end) const {
       new_str[str_litral_len++] = *p++;
     }
   }
-  auto res = std::make_shared<Token>(TK_STR, start, end - start + 1);
+  TokenPtr res = Create(TK_STR, start, end - start + 1);
   res->str_literal = std::move(new_str);
   return res;
 }
@@ -218,22 +169,35 @@ TokenPtr Token::ReadCharacterLiteral(const char* start) {
   if (!end) {
     ErrorAt(p, "uncloser character literal.");
   }
-  auto res = std::make_shared<Token>(TK_NUM, start, end - start + 1);
+  TokenPtr res = Create(TK_NUM, start, end - start + 1);
   res->val = c;
   return res;
 }
 
-TokenPtr Token::CreateTokens(const String& file_name, const StringPtr& program) {
-  current_filename = file_name;
+TokenPtr Token::Create(Tokenkind kind, const char* str, const int len) {
+  return token_arena.Create(kind, str, len);
+}
+
+TokenPtr Token::CreateTokens(const SourceFilePtr& program) {
   prg = program;
-  auto tok_list = std::make_shared<Token>(TK_EOF, nullptr, 0);
-  TokenPtr cur = tok_list;
-  char* p = &(*prg)[0];
+  Token head(TK_EOF, nullptr, 0);
+  TokenPtr cur = &head;
+  const char* p = prg->Begin();
+
+  // line info of the current position.
+  int line_no = 1;
+  const char* line_begin = p;
+  auto new_line = [&](const char* nl) {
+    line_no++;
+    line_begin = nl + 1;
+    prg->AddLine(line_begin);
+  };
+
   while (*p != '\0') {
     // skip line comments.
     if (StrEqual(p, "//", 2)) {
       p += 2;
-      while (*p != '\n') {
+      while (*p != '\n' && *p != '\0') {
         p++;
       }
       continue;
@@ -241,87 +205,65 @@ TokenPtr Token::CreateTokens(const String& file_name, const StringPtr& program)
 
     // skip block comments.
     if (StrEqual(p, "/*", 2)) {
-      char* q = strstr(p + 2, "*/");
+      const char* q = FindCommentEnd(p + 2);
       if (!q) {
         ErrorAt(p, "unclose block comment.");
       }
+      for (auto nl = static_cast<const char*>(memchr(p, '\n', q - p)); nl != nullptr;
+           nl = static_cast<const char*>(memchr(nl + 1, '\n', q - nl - 1))) {
+        new_line(nl);
+      }
       p = q + 2;
       continue;
     }
 
-    if (std::isspace(*p)) {
+    if (*p == '\n') {
+      new_line(p);
       p++;
       continue;
     }
 
-    if (std::isdigit(*p)) {
-      cur = cur->next = ReadIntLiteral(p);
-      p += cur->len;
-      continue;
-    }
-
-    if (*p == '"') {
-      cur = cur->next = cur->ReadStringLiteral(p);
-      p += cur->len;
-      continue;
-    }
-
-    if (*p == '\'') {
-      cur = cur->next = ReadCharacterLiteral(p);
-      p += cur->len;
+    if (std::isspace(*p)) {
+      p = SkipSpace(p);
       continue;
     }
 
-    // indentifier or keyword
-    if (IsAlpha(*p)) {
-      char* q = p++;
-      while (IsAlnum(*p)) {
-        p++;
+    TokenPtr tok = nullptr;
+    if (std::isdigit(*p)) {
+      tok = ReadIntLiteral(p);
+    } else if (*p == '"') {
+      tok = cur->ReadStringLiteral(p);
+    } else if (*p == '\'') {
+      tok = ReadCharacterLiteral(p);
+    } else if (IsAlpha(*p)) {
+      // indentifier or keyword
+      const char* q = SkipIdent(p + 1);
+      KeywordKind kw = FindKeyword(p, q - p);
+      if (kw == KW_END) {
+        tok = Create(TK_IDENT, p, q - p);
+        tok->sym = Symbol::Intern(p, q - p);
+      } else {
+        tok = Create(TK_KEYWORD, p, q - p);
+        tok->keyword = kw;
       }
-      cur = cur->next = std::make_shared<Token>(TK_IDENT, q, p - q);
-      continue;
-    }
-
-    int punct_len = ReadPunct(p);
-    if (punct_len) {
-      cur = cur->next = std::make_shared<Token>(TK_PUNCT, p, punct_len);
-      p += punct_len;
-      continue;
-    }
-    ErrorAt(p, "expect a number.");
-  }
-
-  cur->next = std::make_shared<Token>(TK_EOF, p, 0);
-
-  ConvertToReserved(tok_list->next);
-  InitLineNumInfo(tok_list->next);
-  return tok_list->next;
-}
-
-inline void Token::ConvertToReserved(TokenPtr tok) {
-  for (TokenPtr t = tok; t != nullptr; t = t->next) {
-    for (auto& kw : keyword) {
-      if (StrEqual(t->loc, kw, t->len)) {
-        t->kind = TK_KEYWORD;
+    } else {
+      int punct_len = ReadPunct(p);
+      if (!punct_len) {
+        ErrorAt(p, "expect a number.");
       }
+      tok = Create(TK_PUNCT, p, punct_len);
     }
-  }
-}
 
-void Token::InitLineNumInfo(TokenPtr tok) {
-  const char* p = prg->c_str();
-  int n = 1;
-
-  do {
-    if (p == tok->loc) {
-      tok->line_no = n;
-      tok = tok->next;
-    }
+    tok->line_no = line_no;
+    tok->col_no = p - line_begin + 1;
+    cur = cur->next = tok;
+    p += tok->len;
+  }
 
-    if (*p == '\n') {
-      n++;
-    }
-  } while (*p++);
+  cur->next = Create(TK_EOF, p, 0);
+  cur->next->line_no = line_no;
+  cur->next->col_no = p - line_begin + 1;
+  return head.next;
 }
 
 bool Token::Equal(const char* op) const { return StrEqual(loc, op, len); }
@@ -361,11 +303,13 @@ TokenPtr Token::ReadStringLiteral(const char* start) const {
   return tok;
 }
 
-String Token::GetIdent() const {
+const String& Token::GetIdent() const { return GetSymbol()->GetName(); }
+
+SymbolPtr Token::GetSymbol() const {
   if (kind != TK_IDENT) {
     ErrorTok("GetIdent expect an identifier.");
   }
-  return String(loc, len);
+  return sym;
 }
 
 long Token::GetNumber() const {
@@ -377,17 +321,17 @@ long Token::GetNumber() const {
 
 int Token::GetLineNo() const { return line_no; }
 
+int Token::GetColNo() const { return col_no; }
+
 bool Token::IsTypename() const {
-  for (auto& tn : type_name) {
-    if (Equal(tn)) {
-      return true;
-    }
+  if (kind == TK_KEYWORD) {
+    return (typename_keywords >> keyword) & 1;
   }
-  return Scope::FindTypedef(std::make_shared<Token>(*this)) != nullptr;
+  return Scope::FindTypedef(this) != nullptr;
 }
 
 TokenPtr Token::TokenizeFile(const String& input_file) {
-  return CreateTokens(input_file, ReadFile(input_file));
+  return CreateTokens(std::make_shared<SourceFile>(input_file));
 }
 
 void Token::ErrorTok(const char* fmt, ...) const {
@@ -398,33 +342,22 @@ void Token::ErrorTok(const char* fmt, ...) const {
 }
 
 void Token::ErrorAt(const char* loc, const char* fmt, ...) {
-  // get line number
-  int line_no = 1;
-  for (const char* p = prg->c_str(); p < loc; p++) {
-    if (*p == '\n') {
-      line_no++;
-    }
-  }
   va_list ap;
   va_start(ap, fmt);
-  VrdicErrorAt(line_no, loc, fmt, ap);
+  VrdicErrorAt(prg->GetLineNo(loc), loc, fmt, ap);
   exit(1);
 }
 
 void Token::VrdicErrorAt(int line_no, const char* loc, const char* fmt, va_list ap) {
   // find a line containing `loc`
-  const char* start = loc;
-  const char* current_input = prg->c_str();
-  while (current_input < start && start[-1] != '\n') {
-    start--;
-  }
+  const char* start = prg->GetLineBegin(loc);
   // get the current line end.
   const char* end = loc;
-  while (*end != '\n') {
+  while (*end != '\n' && *end != '\0') {
     end++;
   }
   // print the line
-  const int indent = fprintf(stderr, "%s:%d: ", current_filename.c_str(), line_no);
+  const int indent = fprintf(stderr, "%s:%d: ", prg->GetName().c_str(), line_no);
   fprintf(stderr, "%.*s\n", static_cast<int>(end - start), start);
   auto pos = static_cast<int>(loc - start + indent);
 
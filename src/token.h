@@ -17,6 +17,9 @@
 #include <cstring>
 #include <memory>
 
+#include "arena.h"
+#include "lexer.h"
+#include "source.h"
 #include "tools.h"
 
 enum Tokenkind {
@@ -47,12 +50,18 @@ class Token {
   bool Equal(const TokenPtr tok) const;
   // Report an error in token list
   void ErrorTok(const char* fmt, ...) const;
-  // Get tok name string based copy mode.
-  String GetIdent() const;
+  // Get identifier name.
+  const String& GetIdent() const;
+  // Get identifier interned symbol.
+  SymbolPtr GetSymbol() const;
+  // Get keyword kind, KW_END if the token isn't a keyword.
+  inline KeywordKind GetKeyword() const { return keyword; }
   // Get tok value when kind == NUM
   long GetNumber() const;
   // Get tok line number.
   int GetLineNo() const;
+  // Get tok column number.
+  int GetColNo() const;
   // Get string literal.
   const String& GetStringLiteral() const { return str_literal; }
   // Check whether the given token is a typename.
@@ -76,12 +85,10 @@ class Token {
   };
 
  private:
+  // allocate a token from the translation unit token arena.
+  static TokenPtr Create(Tokenkind kind, const char* str, const int len);
   // creating token list from the source program.
-  static TokenPtr CreateTokens(const String& file_name, const StringPtr& program);
-  // matching reserved keyword based start.
-  static void ConvertToReserved(TokenPtr tok);
-  // initializa the line info of all token.
-  static void InitLineNumInfo(TokenPtr tok);
+  static TokenPtr CreateTokens(const SourceFilePtr& program);
   // Reports an error location and exit.
   static void ErrorAt(const char* loc, const char* fmt, ...);
   // read int literal number, such as 0xa4, 0b1011, 0311, 1123
@@ -106,8 +113,14 @@ class Token {
   int len = 0;
   // String literal contents include terminating '\0'
   String str_literal = "";
+  // If kind_ is TK_IDENT, its interned name.
+  SymbolPtr sym = nullptr;
+  // If kind_ is TK_KEYWORD, its keyword kind.
+  KeywordKind keyword = KW_END;
   // token line number
   int line_no = -1;
+  // token column number
+  int col_no = -1;
 };
 
 template <>
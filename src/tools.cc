@@ -11,11 +11,17 @@
 
 #include "tools.h"
 
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <cerrno>
 #include <cstdarg>
 #include <cstdio>
 #include <cstdlib>
 #include <sstream>
 
+#include "inline.h"
+#include "peephole.h"
 #include "utils.h"
 
 void Error(const char* fmt, ...) {
@@ -65,15 +71,47 @@ class StringFormator {
   std::stringstream sprint;
 };
 
-String CreateUniqueName(String prefix) {
+int CreateUniqueId() {
   static int id = 0;
-  StringFormat(".L..", id++);
+  return id++;
+}
+
+String CreateUniqueName(String prefix) {
+  StringFormat(".L..", CreateUniqueId());
   return StringFormator::GetString();
 }
 
+int OpenOutput(const String& path) {
+  if (path.empty() || path == "-") {
+    return STDOUT_FILENO;
+  }
+  int fd = open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+  if (fd < 0) {
+    Error("cannot open output file: %s.", path.c_str());
+  }
+  return fd;
+}
+
+void WriteAll(int fd, const char* data, size_t len) {
+  while (len > 0) {
+    ssize_t n = write(fd, data, len);
+    if (n < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      Error("cannot write output file.");
+    }
+    data += n;
+    len -= n;
+  }
+}
+
 // compiler helper function.
 void Usage(int state) {
-  std::cerr << "toyc [ -o <path> ] <file>." << std::endl;
+  std::cerr << "toyc [ -o <path> ] [ -c ] [ -O0 | -O1 ] [ --dump-ir ] [ --mem-report ]\n"
+               "     [ --no-peephole | --peephole=<rule>,... ] [ --peephole-report ]\n"
+               "     [ --frame-report ] [ -finline-limit=<n> ] <file>."
+            << std::endl;
   exit(state);
 }
 
@@ -85,6 +123,44 @@ Config ParseArgs(int argc, char** argv) {
     if (!strcmp(argv[i], "--help")) {
       Usage(0);
     }
+    if (!strcmp(argv[i], "-c")) {
+      cg.emit_obj = true;
+      continue;
+    }
+    if (!strncmp(argv[i], "-O", 2)) {
+      cg.opt_level = argv[i][2] == '\0' || atoi(argv[i] + 2) > 0 ? 1 : 0;
+      continue;
+    }
+    if (!strcmp(argv[i], "--dump-ir")) {
+      cg.dump_ir = true;
+      continue;
+    }
+    if (!strcmp(argv[i], "--no-peephole")) {
+      cg.peephole_rules = 0;
+      continue;
+    }
+    if (!strncmp(argv[i], "--peephole=", 11)) {
+      if (!Peephole::ParseRules(argv[i] + 11, &cg.peephole_rules)) {
+        Error("unknow peephole rule: %s", argv[i] + 11);
+      }
+      continue;
+    }
+    if (!strcmp(argv[i], "--peephole-report")) {
+      cg.peephole_report = true;
+      continue;
+    }
+    if (!strcmp(argv[i], "--frame-report")) {
+      cg.frame_report = true;
+      continue;
+    }
+    if (!strncmp(argv[i], "-finline-limit=", 15)) {
+      cg.inline_limit = atoi(argv[i] + 15);
+      continue;
+    }
+    if (!strcmp(argv[i], "--mem-report")) {
+      cg.mem_report = true;
+      continue;
+    }
     if (!strcmp(argv[i], "-o")) {
       if (!argv[++i]) {
         Usage(1);
@@ -102,6 +178,9 @@ Config ParseArgs(int argc, char** argv) {
 
     cg.input_path = argv[i];
   }
+  if (cg.inline_limit < 0) {
+    cg.inline_limit = cg.opt_level > 0 ? Inliner::kDefaultLimit : 0;
+  }
   if (cg.input_path.empty()) {
     Error("no input files.");
   }
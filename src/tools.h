@@ -26,12 +26,12 @@
 
 // recursive over state.
 template <typename F, typename T>
-static void Println(const T arg) {
+static void Println(const T& arg) {
   F::Print(arg);
 }
 
 template <typename F, typename T, typename... Types>
-static void Println(const T first_arg, const Types... args) {
+static void Println(const T& first_arg, const Types&... args) {
   F::Print(first_arg);
   Println<F>(args...);
 }
@@ -50,8 +50,14 @@ inline bool IsAlpha(const char c) {
 inline bool IsAlnum(const char c) { return IsAlpha(c) || ('0' <= c && c <= '9'); }
 // round up `n` to the nearest multiple of `align`.
 inline int AlignTo(const int n, const int align) { return (n + align - 1) / align * align; }
+// create a unique id, a label id is printed as .L..<id>.
+int CreateUniqueId();
 // create a unique name.
 String CreateUniqueName(String prefix = ".L..");
+// open the output file, "-" is the standard output.
+int OpenOutput(const String& path);
+// write all len bytes of data to fd.
+void WriteAll(int fd, const char* data, size_t len);
 // compiler helper function.
 void Usage(int state);
 // parse input arguement.
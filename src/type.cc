@@ -18,12 +18,12 @@
 #include "tools.h"
 #include "utils.h"
 
-TypePtr ty_long = std::make_shared<Type>(TY_LONG, 8, 8);
-TypePtr ty_int = std::make_shared<Type>(TY_INT, 4, 4);
-TypePtr ty_short = std::make_shared<Type>(TY_SHORT, 2, 2);
-TypePtr ty_char = std::make_shared<Type>(TY_CHAR, 1, 1);
-TypePtr ty_void = std::make_shared<Type>(TY_VOID, 1, 1);
-TypePtr ty_bool = std::make_shared<Type>(TY_BOOL, 1, 1);
+TypePtr ty_long = MakeIR<Type>(TY_LONG, 8, 8);
+TypePtr ty_int = MakeIR<Type>(TY_INT, 4, 4);
+TypePtr ty_short = MakeIR<Type>(TY_SHORT, 2, 2);
+TypePtr ty_char = MakeIR<Type>(TY_CHAR, 1, 1);
+TypePtr ty_void = MakeIR<Type>(TY_VOID, 1, 1);
+TypePtr ty_bool = MakeIR<Type>(TY_BOOL, 1, 1);
 
 bool Type::IsInteger() const {
   return kind == TY_BOOL || kind == TY_INT || kind == TY_CHAR || kind == TY_SHORT ||
@@ -36,26 +36,26 @@ bool Type::Is<TY_PRT>() const {
 }
 
 TypePtr Type::CreatePointerType(TypePtr base) {
-  auto ty = std::make_shared<Type>(TY_PRT, 8, 8);
+  auto ty = MakeIR<Type>(TY_PRT, 8, 8);
   ty->base = base;
   return ty;
 }
 
 TypePtr Type::CreateFunctionType(TypePtr ret_type, const TypePtrVector& params) {
-  auto ty = std::make_shared<Type>(TY_FUNC, ret_type->size, 0);
+  auto ty = MakeIR<Type>(TY_FUNC, ret_type->size, 0);
   ty->return_ty = ret_type;
   ty->params = params;
   return ty;
 }
 
 TypePtr Type::CreateArrayType(TypePtr base, int array_len) {
-  auto ty = std::make_shared<Type>(TY_ARRAY, base->size * array_len, base->align);
+  auto ty = MakeIR<Type>(TY_ARRAY, base->size * array_len, base->align);
   ty->base = base;
   return ty;
 }
 
 TypePtr Type::CreateStructType(MemPtrVector mem, TokenPtr tag) {
-  auto ty = std::make_shared<Type>(TY_STRUCT, 1, 1);
+  auto ty = MakeIR<Type>(TY_STRUCT, 1, 1);
   ty->align = Member::CalcuStructAlign(mem);
   ty->size = AlignTo(Member::CalcuStructOffset(mem), ty->align);
   ty->mem = mem;
@@ -64,7 +64,7 @@ TypePtr Type::CreateStructType(MemPtrVector mem, TokenPtr tag) {
 }
 
 TypePtr Type::CreateUnionType(MemPtrVector mem, TokenPtr tag) {
-  auto ty = std::make_shared<Type>(TY_UNION, 1, 1);
+  auto ty = MakeIR<Type>(TY_UNION, 1, 1);
   for (auto m : mem) {
     if (ty->align < m->ty->align) {
       ty->align = m->ty->align;
@@ -87,7 +87,7 @@ const TokenPtr& Type::GetName() const {
 
 bool Type::IsSameStruct(TypePtr ty1) {
   return ty1->Is<TY_STRUCT>() && this->Is<TY_STRUCT>() &&
-         ty1->tag->GetIdent() == this->tag->GetIdent();
+         ty1->tag->GetSymbol() == this->tag->GetSymbol();
 }
 
 void Type::UpdateStructMember(const MemPtrVector& mem) {
@@ -107,7 +107,7 @@ void Type::UpdateStructMember(const MemPtrVector& mem) {
       // occurs cyclic reference.
       // such as struct T{ struct T* next, int a} t;
       // which struct T and struct T* next is dependent each other.
-      last->base = std::make_shared<Type>(TY_STRUCT, -1, 0);
+      last->base = MakeIR<Type>(TY_STRUCT, -1, 0);
       last->base->is_self_pointer = true;
       last->base->base_weak = TypeWeakPtr(cur);
     }
@@ -117,7 +117,7 @@ void Type::UpdateStructMember(const MemPtrVector& mem) {
 // get struct member based on token.
 MemberPtr Type::GetStructMember(TokenPtr tok) const {
   if (is_self_pointer) {
-    TypePtr t = base_weak.lock();
+    TypePtr t = Lock(base_weak);
     for (auto m : t->mem) {
       if (tok->Equal(m->name)) {
         return m;
@@ -134,7 +134,7 @@ MemberPtr Type::GetStructMember(TokenPtr tok) const {
   return nullptr;
 }
 
-TypePtr Type::CreateEnumType() { return std::make_shared<Type>(TY_ENUM, 4, 4); }
+TypePtr Type::CreateEnumType() { return MakeIR<Type>(TY_ENUM, 4, 4); }
 
 TypePtr Type::GetCommonType(const TypePtr& ty1, const TypePtr& ty2) {
   if (ty1->Is<TY_PRT>()) {
@@ -159,17 +159,20 @@ void Type::TypeInfer(NodePtr node) {
 
   TypeInfer(node->lhs);
   TypeInfer(node->rhs);
-  TypeInfer(node->cond);
-  TypeInfer(node->then);
-  TypeInfer(node->els);
-  TypeInfer(node->init);
-  TypeInfer(node->inc);
+  if (node->ext != nullptr) {
+    NodeExtPtr ext = node->ext;
+    TypeInfer(ext->cond);
+    TypeInfer(ext->then);
+    TypeInfer(ext->els);
+    TypeInfer(ext->init);
+    TypeInfer(ext->inc);
 
-  for (NodePtr n = node->body; n != nullptr; n = n->next) {
-    TypeInfer(n);
-  }
-  for (NodePtr n = node->args; n != nullptr; n = n->next) {
-    TypeInfer(n);
+    for (NodePtr n = ext->body; n != nullptr; n = n->next) {
+      TypeInfer(n);
+    }
+    for (NodePtr n = ext->args; n != nullptr; n = n->next) {
+      TypeInfer(n);
+    }
   }
 
   switch (node->kind) {
@@ -219,25 +222,29 @@ void Type::TypeInfer(NodePtr node) {
       return;
     case ND_BITNOT:
     case ND_SHL:
-    case ND_SHR:
-      node->ty = node->lhs->ty;
+    case ND_SHR: {
+      // the operand is promoted, the shift count doesn't take part in the type.
+      TypePtr ty = GetCommonType(ty_int, node->lhs->ty);
+      node->lhs = Node::CreateCastNode(node->lhs->name, node->lhs, ty);
+      node->ty = ty;
       return;
+    }
     case ND_VAR:
       node->ty = node->var->GetType();
       return;
     case ND_COND:
-      if (node->then->ty->Is<TY_VOID>() || node->els->ty->Is<TY_VOID>()) {
+      if (node->ext->then->ty->Is<TY_VOID>() || node->ext->els->ty->Is<TY_VOID>()) {
         node->ty = ty_void;
       } else {
-        Type::UsualArithConvert(node->then, node->els);
-        node->ty = node->then->ty;
+        Type::UsualArithConvert(node->ext->then, node->ext->els);
+        node->ty = node->ext->then->ty;
       }
       return;
     case ND_COMMON:
       node->ty = node->rhs->ty;
       return;
     case ND_MUMBER:
-      node->ty = node->mem->ty;
+      node->ty = node->ext->mem->ty;
       return;
     case ND_ADDR:
       if (node->lhs->IsArrayNode()) {
@@ -256,8 +263,8 @@ void Type::TypeInfer(NodePtr node) {
       node->ty = node->lhs->ty->GetBase();
       return;
     case ND_STMT_EXPR:
-      if (node->body != nullptr) {
-        NodePtr stmt = node->body;
+      if (node->ext->body != nullptr) {
+        NodePtr stmt = node->ext->body;
         while (stmt->next != nullptr) {
           stmt = stmt->next;
         }
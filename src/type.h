@@ -102,7 +102,7 @@ class Type {
   // Pointer-to or array type. Using a same member to
   // represent pointer/array duality in C.
   TypePtr base = nullptr;
-  TypeWeakPtr base_weak;
+  TypeWeakPtr base_weak{};
   bool is_self_pointer = false;
 
   // ---- Array ----
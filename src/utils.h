@@ -20,8 +20,11 @@
 #include <memory>
 #include <ostream>
 #include <unordered_map>
+#include <utility>
 #include <vector>
 
+#include "arena.h"
+
 class Token;
 class Object;
 class Node;
@@ -30,29 +33,66 @@ class TagScope;
 class VarScope;
 class Scope;
 class Member;
+class Symbol;
+struct NodeExt;
 struct VarAttr;
 
-using TokenPtr = std::shared_ptr<Token>;
+// tokens are owned by the token arena, see token.cc.
+using TokenPtr = Token*;
+// symbols are owned by the symbol table, see symbol.cc.
+using SymbolPtr = Symbol*;
+#ifdef TOYC_SHARED_IR
+// IR objects are reference counted and freed when the last owner drops them.
 using TypePtr = std::shared_ptr<Type>;
 using TypeWeakPtr = std::weak_ptr<Type>;
-using TypePtrVector = std::vector<TypePtr>;
 using NodePtr = std::shared_ptr<Node>;
-using NodePtrVec = std::vector<NodePtr>;
+using NodeExtPtr = std::shared_ptr<NodeExt>;
 using ObjectPtr = std::shared_ptr<Object>;
+using VarScopePtr = std::shared_ptr<VarScope>;
+using MemberPtr = std::shared_ptr<Member>;
+
+// create an IR object.
+template <typename T, typename... Args>
+inline std::shared_ptr<T> MakeIR(Args&&... args) {
+  return std::make_shared<T>(std::forward<Args>(args)...);
+}
+// get a strong reference from a weak one.
+template <typename T>
+inline std::shared_ptr<T> Lock(const std::weak_ptr<T>& p) {
+  return p.lock();
+}
+#else
+// IR objects are owned by the IR arenas and all freed together when the
+// compilation ends, see GetArena() in arena.h.
+using TypePtr = Type*;
+using TypeWeakPtr = Type*;
+using NodePtr = Node*;
+using NodeExtPtr = NodeExt*;
+using ObjectPtr = Object*;
+using VarScopePtr = VarScope*;
+using MemberPtr = Member*;
+
+// create an IR object.
+template <typename T, typename... Args>
+inline T* MakeIR(Args&&... args) {
+  return GetArena<T>().Create(std::forward<Args>(args)...);
+}
+// get a strong reference from a weak one.
+template <typename T>
+inline T* Lock(T* p) {
+  return p;
+}
+#endif
+
+using TypePtrVector = std::vector<TypePtr>;
+using NodePtrVec = std::vector<NodePtr>;
 using StringPtr = std::shared_ptr<std::string>;
 using String = std::string;
 using StringStream = std::stringstream;
-using ScopePtr = std::shared_ptr<Scope>;
-using VarScopePtr = std::shared_ptr<VarScope>;
 using TagScopePtr = std::shared_ptr<TagScope>;
-using MemberPtr = std::shared_ptr<Member>;
 using MemPtrVector = std::vector<MemberPtr>;
 using VarAttrPtr = std::shared_ptr<VarAttr>;
-using String = std::string;
-using VarScopePtr = std::shared_ptr<VarScope>;
-using VarScopeMap = std::unordered_map<String, VarScopePtr>;
 using TypedefMap = std::unordered_map<String, TypePtr>;
-using TagScopeMap = std::unordered_map<String, TypePtr>;
 using ObjectList = std::vector<ObjectPtr>;
 
 template <typename T>
@@ -62,14 +102,28 @@ struct Config {
   Config() = default;
   String output_path = "-";
   String input_path = "-";
+  bool mem_report = false;
+  // emit an ELF relocatable object instead of assembly.
+  bool emit_obj = false;
+  // 0 for the stack machine, 1 for the register allocated IR backend.
+  int opt_level = 0;
+  // print the SSA form of each function to stderr.
+  bool dump_ir = false;
+  // mask of the enabled peephole rules, see peephole.h.
+  uint32_t peephole_rules = ~0u;
+  // print the number of rewrites of each peephole rule to stderr.
+  bool peephole_report = false;
+  // print the stack frame size of each function to stderr.
+  bool frame_report = false;
+  // largest static function body in nodes to inline, 0 turns inlining off and
+  // -1 picks the default of the optimization level.
+  int inline_limit = -1;
 };
 
 extern NodePtrVec goto_list;
 extern NodePtrVec label_list;
 extern NodePtr cur_swt;
 
-extern ScopePtr scope;
-
 extern TypePtr ty_void;
 extern TypePtr ty_char;
 extern TypePtr ty_short;
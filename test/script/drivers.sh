@@ -30,6 +30,59 @@ $build_path"/toyc" -o $tmp/out $tmp/empty.c
 [ -f $tmp/out ]
 check -o
 
+# -c
+rm -f $tmp/out
+$build_path"/toyc" -c -o $tmp/out $tmp/empty.c
+head -c 4 $tmp/out | grep -q ELF
+check -c
+
+# -O1
+rm -f $tmp/out
+$build_path"/toyc" -O1 -o $tmp/out $tmp/empty.c
+[ -f $tmp/out ]
+check -O1
+
+# --dump-ir
+echo "int main() { int x = 0; for (int i = 0; i < 3; i++) x = x + i; return x; }" > $tmp/loop.c
+$build_path"/toyc" --dump-ir -o $tmp/out $tmp/loop.c 2>&1 | grep -q "= phi"
+check --dump-ir
+
+# --peephole-report
+$build_path"/toyc" --peephole-report -o $tmp/out $tmp/loop.c 2>&1 | grep -q "push-pop"
+check --peephole-report
+
+# --no-peephole
+$build_path"/toyc" --no-peephole -o $tmp/out $tmp/loop.c
+grep -q "push rax" $tmp/out
+check --no-peephole
+
+# --peephole=<rule>,...
+$build_path"/toyc" --peephole=loc --peephole-report -o $tmp/out $tmp/loop.c 2>&1 |
+  grep -q "push-pop  *0$"
+check --peephole=
+
+# --frame-report
+$build_path"/toyc" --frame-report -o $tmp/out $tmp/loop.c 2>&1 | grep -q "main: frame"
+check --frame-report
+
+# -finline-limit=<n>
+echo "static int sq(int x) { return x * x; } int main() { return sq(3); }" > $tmp/inline.c
+$build_path"/toyc" -O1 -o $tmp/out $tmp/inline.c
+$build_path"/toyc" -O1 -finline-limit=0 -o $tmp/out.noinline $tmp/inline.c
+! grep -q "call sq" $tmp/out && grep -q "call sq" $tmp/out.noinline
+check -finline-limit=
+
+# more arguments than argument registers
+echo "int f(int a, int b, int c, int d, int e, int f, int g) { return g; }" > $tmp/params.c
+echo "int f(); int main() { return f(1, 2, 3, 4, 5, 6, 7); }" > $tmp/args.c
+! $build_path"/toyc" -o $tmp/out $tmp/params.c 2>/dev/null &&
+  ! $build_path"/toyc" -O1 -o $tmp/out $tmp/args.c 2>/dev/null
+check "too many arguments"
+
+# --mem-report
+$build_path"/toyc" --mem-report -o $tmp/out $tmp/empty.c 2>&1 | grep -q "bytes per node"
+check --mem-report
+
 # --help
 $build_path"/toyc" --help 2>&1 | grep -q toyc
 check --help
@@ -131,6 +131,107 @@ int main() {
 
   1 ? -2 : (void)-1;
 
+  ASSERT(1, 2147483647 + 1 < 0);
+  ASSERT(0, (1 << 31) > 0);
+  ASSERT(-128, (char)128);
+  ASSERT(1, (_Bool)256);
+  ASSERT(-1, (long)(int)4294967295);
+  ASSERT(0, 0 && 1/0);
+  ASSERT(1, 1 || 1/0);
+  ASSERT(7, (1, 2, 7));
+  ASSERT(16, ({ int x=2; x*(4+4); }));
+  ASSERT(1, ({ long x=5; x+4294967296 == 4294967301; }));
+  ASSERT(1, ({ long x=5; x-4294967296 < 0; }));
+  ASSERT(1, ({ long x=4294967296; x == 4294967296; }));
+  ASSERT(0, ({ long x=5; x&4294967296; }));
+  ASSERT(-3, ({ int x=3, y=-6; x+y; }));
+  ASSERT(18, ({ int x=3, y=-6; x*y*(-1); }));
+  ASSERT(2, ({ int x=3, y=-6; y/x*(-1); }));
+  ASSERT(1, ({ int x=3, y=-6; (x<y)+(y<x); }));
+  ASSERT(7, ({ char c=3; int i=4; c+i; }));
+  ASSERT(24, ({ int i=3; short s=8; i*s; }));
+  ASSERT(48, ({ int x=3; x<<4; }));
+  ASSERT(-2, ({ int x=-7; x>>2; }));
+  ASSERT(12, ({ int x=3, n=2; x<<n; }));
+  ASSERT(1024, (char)1<<10);
+  ASSERT(1048576, (short)1<<20);
+  ASSERT(256, (long)((char)64<<2));
+  ASSERT(536870912, (short)100<<27);
+  ASSERT(1024, ({ char c=1; c<<10; }));
+  ASSERT(-64, (char)-128>>1);
+  ASSERT(4, sizeof((char)1<<1));
+  ASSERT(4, sizeof(~(short)1));
+  ASSERT(8, sizeof((long)1<<1));
+  ASSERT(2147483646, ({ int x=715827882; x*3; }));
+  ASSERT(-2147483645, ({ int x=-429496729; x*5; }));
+  ASSERT(27, ({ int x=-3; x*(-9); }));
+  ASSERT(-444420, ({ int x=12345; x*(-36); }));
+  ASSERT(2147483646, ({ int x=357913941; x*6; }));
+  ASSERT(1, ({ long x=1844674407370955161; x*5 == 9223372036854775805; }));
+  ASSERT(1, ({ long x=-1024819115206086200; x*9 == (-9223372036854775800); }));
+  ASSERT(1, ({ long x=-1234567890123; x*(-18) == 22222222022214; }));
+
+  ASSERT(-1073741824, ({ int x=-2147483647-1; x/2; }));
+  ASSERT(0, ({ int x=-2147483647-1; x%2; }));
+  ASSERT(1073741824, ({ int x=-2147483647-1; x/(-2); }));
+  ASSERT(0, ({ int x=-2147483647-1; x%(-2); }));
+  ASSERT(268435455, ({ int x=2147483647; x/8; }));
+  ASSERT(7, ({ int x=2147483647; x%8; }));
+  ASSERT(-268435456, ({ int x=-2147483647-1; x/8; }));
+  ASSERT(0, ({ int x=-2147483647-1; x%8; }));
+  ASSERT(-2, ({ int x=-9; x/4; }));
+  ASSERT(-1, ({ int x=-9; x%4; }));
+  ASSERT(2, ({ int x=-9; x/(-4); }));
+  ASSERT(-1, ({ int x=-9; x%(-4); }));
+  ASSERT(-306783378, ({ int x=-2147483647-1; x/7; }));
+  ASSERT(-2, ({ int x=-2147483647-1; x%7; }));
+  ASSERT(306783378, ({ int x=2147483647; x/7; }));
+  ASSERT(1, ({ int x=2147483647; x%7; }));
+  ASSERT(-1, ({ int x=-7; x/7; }));
+  ASSERT(0, ({ int x=-7; x%7; }));
+  ASSERT(0, ({ int x=-6; x/7; }));
+  ASSERT(-6, ({ int x=-6; x%7; }));
+  ASSERT(306783378, ({ int x=-2147483647-1; x/(-7); }));
+  ASSERT(-2, ({ int x=-2147483647-1; x%(-7); }));
+  ASSERT(-715827882, ({ int x=2147483647; x/(-3); }));
+  ASSERT(1, ({ int x=2147483647; x%(-3); }));
+  ASSERT(-10, ({ int x=-100; x/10; }));
+  ASSERT(0, ({ int x=-100; x%10; }));
+  ASSERT(192600, ({ int x=123456789; x/641; }));
+  ASSERT(189, ({ int x=123456789; x%641; }));
+  ASSERT(1, ({ int x=-2147483647-1; x/(-2147483647-1); }));
+  ASSERT(0, ({ int x=-2147483647-1; x%(-2147483647-1); }));
+  ASSERT(0, ({ int x=2147483647; x/(-2147483647-1); }));
+  ASSERT(2147483647, ({ int x=2147483647; x%(-2147483647-1); }));
+  ASSERT(0, ({ int x=-5; x/1073741824; }));
+  ASSERT(-5, ({ int x=-5; x%1073741824; }));
+  ASSERT(1, ({ long x=(-9223372036854775807-1); x/2 == (-4611686018427387904); }));
+  ASSERT(1, ({ long x=(-9223372036854775807-1); x%2 == 0; }));
+  ASSERT(1, ({ long x=(-9223372036854775807-1); x/(-4096) == 2251799813685248; }));
+  ASSERT(1, ({ long x=(-9223372036854775807-1); x%(-4096) == 0; }));
+  ASSERT(1, ({ long x=9223372036854775807; x/1099511627776 == 8388607; }));
+  ASSERT(1, ({ long x=9223372036854775807; x%1099511627776 == 1099511627775; }));
+  ASSERT(1, ({ long x=(-9223372036854775807-1); x/1099511627776 == (-8388608); }));
+  ASSERT(1, ({ long x=(-9223372036854775807-1); x%1099511627776 == 0; }));
+  ASSERT(1, ({ long x=(-9223372036854775807-1); x/7 == (-1317624576693539401); }));
+  ASSERT(1, ({ long x=(-9223372036854775807-1); x%7 == (-1); }));
+  ASSERT(1, ({ long x=9223372036854775807; x/7 == 1317624576693539401; }));
+  ASSERT(1, ({ long x=9223372036854775807; x%7 == 0; }));
+  ASSERT(1, ({ long x=(-9223372036854775807-1); x/(-10) == 922337203685477580; }));
+  ASSERT(1, ({ long x=(-9223372036854775807-1); x%(-10) == (-8); }));
+  ASSERT(1, ({ long x=9223372036854775807; x/1000000007 == 9223371972; }));
+  ASSERT(1, ({ long x=9223372036854775807; x%1000000007 == 291172003; }));
+  ASSERT(1, ({ long x=(-9223372036854775807-1); x/4052555153018976267 == (-2); }));
+  ASSERT(1, ({ long x=(-9223372036854775807-1); x%4052555153018976267 == (-1118261730816823274); }));
+  ASSERT(1, ({ long x=(-123456789012345); x/(-1000) == 123456789012; }));
+  ASSERT(1, ({ long x=(-123456789012345); x%(-1000) == (-345); }));
+  ASSERT(1, ({ long x=(-9223372036854775807-1); x/(-9223372036854775807-1) == 1; }));
+  ASSERT(1, ({ long x=(-9223372036854775807-1); x%(-9223372036854775807-1) == 0; }));
+  ASSERT(1, ({ long x=9223372036854775807; x/(-9223372036854775807-1) == 0; }));
+  ASSERT(1, ({ long x=9223372036854775807; x%(-9223372036854775807-1) == 9223372036854775807; }));
+  ASSERT(0, ({ int d[4], bad=0; d[0]=7; d[1]=-10; d[2]=641; d[3]=1<<20; for (int i=-3000; i<=3000; i++) { int x=i*715827; bad += x/7!=x/d[0] || x%7!=x%d[0] || x/-10!=x/d[1] || x%-10!=x%d[1] || x/641!=x/d[2] || x%641!=x%d[2] || x/(1<<20)!=x/d[3] || x%(1<<20)!=x%d[3]; } bad; }));
+  ASSERT(0, ({ long d[3], bad=0; d[0]=7; d[1]=-1000000007; d[2]=(long)1<<40; for (int i=-3000; i<=3000; i++) { long x=i*3074457345618258; bad += x/7!=x/d[0] || x%7!=x%d[0] || x/-1000000007!=x/d[1] || x%-1000000007!=x%d[1] || x/((long)1<<40)!=x/d[2] || x%((long)1<<40)!=x%d[2]; } bad; }));
+
   printf("OK\n");
   return 0;
 }
@@ -4,6 +4,23 @@
  * This is a block comment.
  */
 
+// switches dense enough for a jump table.
+int days(int month, int leap) {
+  int d = 0;
+  switch (month) {
+    case 2: d = 28 + leap; break;
+    case 4: case 6: case 9: case 11: d = 30; break;
+    case 1: case 3: case 5: case 7: case 8: case 10: case 12: d = 31; break;
+  }
+  return d;
+}
+long span(long x) {
+  switch (x - 3) {
+    case -2: return 1; case -1: return 2; case 0: return 4; case 1: return 8; case 3: return 16;
+    default: return x;
+  }
+}
+
 int main() {
   ASSERT(3, ({ int x; if (0) x=2; else x=3; x; }));
   ASSERT(3, ({ int x; if (1-1) x=2; else x=3; x; }));
@@ -54,6 +71,20 @@ int main() {
   ASSERT(5, ({ int i=0; int j=0; while (i++<10) { if (i>5) continue; j++; } j; }));
   ASSERT(11, ({ int i=0; int j=0; while(!i) { while (j++!=10) continue; break; } j; }));
 
+  ASSERT(1, ({ int i=-3, j=2; int k=0; if (i<j) k=1; k; }));
+  ASSERT(0, ({ int i=-3, j=2; int k=0; if (j<=i) k=1; k; }));
+  ASSERT(1, ({ long i=-3, j=-3; int k=0; if (i<=j && !(i!=j)) k=1; k; }));
+  ASSERT(1, ({ int x[2]; int k=0; if (x<x+1) k=1; k; }));
+  ASSERT(2, ({ int i=0, j=0; if (i++ || j++) 0; else if (i++ && j++) 0; i; }));
+  ASSERT(2, ({ int i=0, j=0; if (i++ || j++) 0; else if (i++ && j++) 0; j; }));
+  ASSERT(3, ({ int i=0; if (!(i==1 || i==2) && !!(i<1)) i=3; i; }));
+  ASSERT(10, ({ int i=0, j=0; for (; i<10 && !(j>=5); i++) j++; i+j+(i>j); }));
+  ASSERT(10, ({ int i=4, j=0; for (; i<5 || j<3; i++) j=j+2; i+j; }));
+  ASSERT(5, ({ int i=2; (i>1 && i<3) ? 5 : 6; }));
+  ASSERT(6, ({ int i=2; (i<1 || i>=3) ? 5 : 6; }));
+  ASSERT(1, ({ int i=2; (i==2 && (i>5 || i!=3)); }));
+  ASSERT(0, ({ int i=2; !(i==2 && (i>5 || i!=3)); }));
+
   ASSERT(5, ({ int i=0; switch(0) { case 0:i=5;break; case 1:i=6;break; case 2:i=7;break; } i; }));
   ASSERT(6, ({ int i=0; switch(1) { case 0:i=5;break; case 1:i=6;break; case 2:i=7;break; } i; }));
   ASSERT(7, ({ int i=0; switch(2) { case 0:i=5;break; case 1:i=6;break; case 2:i=7;break; } i; }));
@@ -64,6 +95,18 @@ int main() {
   ASSERT(0, ({ int i=0; switch(3) { case 0: 0; case 1: 0; case 2: 0; i=2; } i; }));
 
   ASSERT(3, ({ int i=0; switch(-1) { case 0xffffffff: i=3; break; } i; }));
+  ASSERT(863, ({ int s=0; for (int i=-2; i<12; i++) switch(i) { case 0: s+=1; break; case 1: s+=2; break; case 2: s+=4; break; case 3: s+=8; break; case 5: s+=16; break; case 6: s+=32; break; default: s+=100; } s; }));
+  ASSERT(90, ({ int s=0; for (int i=-2; i<12; i++) switch(i) { case 6: s+=32; case 5: s+=16; break; case 3: s+=8; case 2: s+=4; case 1: s+=2; case 0: s+=1; } s; }));
+  ASSERT(127, ({ int s=0; for (int i=-600; i<11000; i++) switch(i) { case 10000: s+=1; break; case -500: s+=2; break; case 1: s+=4; break; case 1000: s+=8; break; case -5: s+=16; break; case 100: s+=32; break; case 10: s+=64; break; } s; }));
+  ASSERT(11657, ({ int s=0; for (int i=-600; i<11000; i++) switch(i) { case 10000: s+=1; break; case -500: s+=2; break; case 1: s+=4; break; case 1000: s+=8; break; case -5: s+=16; break; case 100: s+=32; break; default: s+=1; } s; }));
+  ASSERT(7, ({ long x=1099511627776; int s=0; for (int i=0; i<3; i++, x=x+1) switch(x) { case 1099511627776: s+=1; break; case 1099511627777: s+=2; break; case 1099511627778: s+=4; break; case 1099511627779: s+=8; break; } s; }));
+  ASSERT(3, ({ long x=-1; int s=0; switch(x) { case 0: s=1; break; case 5000000000: s=2; break; case -1: s=3; break; case 7: s=4; break; } s; }));
+  ASSERT(2, ({ int s=0; switch(-2147483647-1) { case -2147483647-1: s=2; break; case 2147483647: s=3; break; case 0: s=4; break; case 1: s=5; break; } s; }));
+  ASSERT(366, ({ int s=0; for (int m=0; m<14; m++) s+=days(m, 1); s; }));
+  ASSERT(28, days(2, 0));
+  ASSERT(0, days(13, 0));
+  ASSERT(48, ({ long s=0; for (long x=-2; x<9; x++) s+=span(x); s; }));
+  ASSERT(-6, ({ int s=0; for (char c=-4; c<2; c++) switch(c) { case -3: s-=1; break; case -2: s-=2; break; case -1: s-=3; break; case 0: s+=0; break; } s; }));
 
   printf("OK\n");
   return 0;
@@ -50,6 +50,92 @@ int param_decay(int x[]) { return x[0]; }
 
 static int static_fn() { return 3; }
 
+// leaf functions, the first keeps its 128 byte frame in the red zone.
+int leaf_sum(int n) {
+  int a[24];
+  for (int i = 0; i < 24; i++) a[i] = i * n;
+  int s = 0;
+  for (int i = 0; i < 24; i++) s = s + a[i];
+  return s;
+}
+
+int leaf_big(int n) {
+  int a[40];
+  for (int i = 0; i < 40; i++) a[i] = i * n;
+  return a[39] + a[1];
+}
+
+int leaf_nested(int a, int b) { return (a + 1) * (b + 2) - (a + b) * (a - b); }
+
+// the parameters are live across a call at the very start of the function.
+int square(int x) { return x * x; }
+int sum_squares(int a, int b) { return square(a) + square(b); }
+int sum_squares_to(int n) {
+  int s = 0;
+  for (int i = 1; i <= n; i++) s = square(i) + s;
+  return s;
+}
+
+// static functions, small enough to be inlined at -O1.
+static int clamp(int x, int lo, int hi) {
+  if (x < lo) return lo;
+  if (x > hi) return hi;
+  return x;
+}
+
+static int sum_even(int n) {
+  int s = 0;
+  for (int i = 0; i < 100; i++) {
+    if (i == n) break;
+    if (i % 2) continue;
+    s = s + i;
+  }
+  return s;
+}
+
+static int classify(int x) {
+  switch (x) {
+    case 0:
+      return 10;
+    case 1:
+      x = x + 1;
+    case 2:
+      return 20 + x;
+    default:
+      break;
+  }
+  return 30;
+}
+
+static int isqrt_up(int x) {
+  int i = 0;
+again:
+  if (i * i >= x) goto done;
+  i++;
+  goto again;
+done:
+  return i;
+}
+
+int bump_cnt;
+static void bump(int n) { bump_cnt = bump_cnt + n; }
+
+static void swap(int *a, int *b) {
+  int t = *a;
+  *a = *b;
+  *b = t;
+}
+
+static char low_byte(int x) { return x; }
+
+static int sq(int x) { return x * x; }
+static int sum_sq(int a, int b) { return sq(a) + sq(b); }
+
+static int fact(int n) {
+  if (n <= 1) return 1;
+  return n * fact(n - 1);
+}
+
 int main() {
   ASSERT(3, ret3());
   ASSERT(8, add2(3, 5));
@@ -83,9 +169,36 @@ int main() {
   ASSERT(1, bool_fn_sub(0));
 
   ASSERT(3, static_fn());
+  ASSERT(552, leaf_sum(2));
+  ASSERT(120, leaf_big(3));
+  ASSERT(139, leaf_nested(3, 10));
+  ASSERT(555, ({ int x[4]; x[0]=1; x[3]=2; leaf_sum(2) + x[0] + x[3]; }));
 
   ASSERT(3, ({ int x[2]; x[0]=3; param_decay(x); }));
 
+  ASSERT(25, sum_squares(3, 4));
+  ASSERT(61, sum_squares(6, 5));
+  ASSERT(55, sum_squares_to(5));
+
+  ASSERT(5, clamp(5, 0, 10));
+  ASSERT(0, clamp(-3, 0, 10));
+  ASSERT(10, clamp(12, 0, 10));
+  ASSERT(20, clamp(clamp(30, 0, 40), 0, 20));
+  ASSERT(12, sum_even(7));
+  ASSERT(2450, sum_even(200));
+  ASSERT(10, classify(0));
+  ASSERT(22, classify(1));
+  ASSERT(22, classify(2));
+  ASSERT(30, classify(5));
+  ASSERT(32, classify(0) + classify(1));
+  ASSERT(4, isqrt_up(10));
+  ASSERT(0, isqrt_up(0));
+  ASSERT(7, ({ bump_cnt = 0; bump(3); bump(4); bump_cnt; }));
+  ASSERT(21, ({ int a = 1, b = 2; swap(&a, &b); a * 10 + b; }));
+  ASSERT(-1, low_byte(511));
+  ASSERT(25, sum_sq(3, 4));
+  ASSERT(120, fact(5));
+
   printf("OK\n");
   return 0;
 }
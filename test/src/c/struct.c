@@ -38,6 +38,20 @@ int main() {
   ASSERT(8, ({ struct {char a; int b;} x; sizeof(x); }));
   ASSERT(8, ({ struct {int a; char b;} x; sizeof(x); }));
 
+  ASSERT(21, ({ struct {char a[7];} x, y; for (int i=0; i<7; i++) x.a[i]=i; y=x; int s=0; for (int i=0; i<7; i++) s+=y.a[i]; s; }));
+  ASSERT(66, ({ struct {char a[12];} x, y; for (int i=0; i<12; i++) x.a[i]=i; y=x; int s=0; for (int i=0; i<12; i++) s+=y.a[i]; s; }));
+  ASSERT(253, ({ struct {char a[23];} x, y; for (int i=0; i<23; i++) x.a[i]=i; y=x; int s=0; for (int i=0; i<23; i++) s+=y.a[i]; s; }));
+  ASSERT(2016, ({ struct {char a[64];} x, y; for (int i=0; i<64; i++) x.a[i]=i; y=x; int s=0; for (int i=0; i<64; i++) s+=y.a[i]; s; }));
+  ASSERT(2080, ({ struct {char a[65];} x, y; for (int i=0; i<65; i++) x.a[i]=i; y=x; int s=0; for (int i=0; i<65; i++) s+=y.a[i]; s; }));
+  ASSERT(4950, ({ struct {char a[100];} x, y, *p=&y; for (int i=0; i<100; i++) x.a[i]=i; *p=x; int s=0; for (int i=0; i<100; i++) s+=p->a[i]; s; }));
+  ASSERT(9, ({ struct {struct {char a[5];} s; char g;} x, y; y.g=9; x.g=1; y.s=x.s; y.g; }));
+  ASSERT(9, ({ struct {struct {char a[70];} s; char g;} x, y; y.g=9; x.g=1; y.s=x.s; y.g; }));
+  ASSERT(7, ({ struct {long a[10];} x, y, z; x.a[9]=7; z=y=x; z.a[9]; }));
+
+  ASSERT(12, ({ struct {int a; int b;} x; x.a=3; x.b=4; x.a*x.b; }));
+  ASSERT(1, ({ struct {char c; long a; int b;} x; x.a=3; x.b=4; x.c=5; x.b-x.a; }));
+  ASSERT(5, ({ struct {int a; struct {int b; int c;} s;} x; x.s.c=5; x.a=x.s.c; x.a; }));
+
   ASSERT(8, ({ struct t {int a; int b;} x; struct t y; sizeof(y); }));
   ASSERT(8, ({ struct t {int a; int b;}; struct t y; sizeof(y); }));
   ASSERT(2, ({ struct t {char a[2];}; { struct t {char a[4];}; } struct t y; sizeof(y); }));
@@ -28,6 +28,8 @@ int main() {
 
   ASSERT(0, g1);
   ASSERT(3, ({ g1=3; g1; }));
+  ASSERT(7, ({ g1=3; int x=4; x+g1; }));
+  ASSERT(1, ({ g1=3; int x=4; g1<x; }));
   ASSERT(0, ({ g2[0]=0; g2[1]=1; g2[2]=2; g2[3]=3; g2[0]; }));
   ASSERT(1, ({ g2[0]=0; g2[1]=1; g2[2]=2; g2[3]=3; g2[1]; }));
   ASSERT(2, ({ g2[0]=0; g2[1]=1; g2[2]=2; g2[3]=3; g2[2]; }));
@@ -64,6 +66,12 @@ int main() {
 
   { void *x; }
 
+  ASSERT(7, ({ int x=3; { int y=4; x=x+y; } { int z=5; z; } x; }));
+  ASSERT(9, ({ int x=1; { int y[4]; y[3]=2; x=x+y[3]; } { long z[2]; z[0]=6; z[1]=0; x=x+z[0]+z[1]; } x; }));
+  ASSERT(6, ({ int s=0; for (int i=0; i<3; i++) { int t=i+1; s+=t; } { int u=0; s+=u; } s; }));
+  ASSERT(17, ({ int x=0; { int y=3; { int z=4; y=y+z; } { int w=10; y=y+w; } x=y; } x; }));
+  ASSERT(9, ({ int a[3]; a[0]=1; a[1]=2; a[2]=3; int *p=a; *p++ += 4; *p++ += 0; a[0]+a[1]+*--p; }));
+
   printf("OK\n");
   return 0;
 }